@@ -127,6 +127,14 @@
  //#define JUCE_INCLUDE_ZLIB_CODE
 #endif
 
+#ifndef    JUCE_ENABLE_TRACING
+ //#define JUCE_ENABLE_TRACING
+#endif
+
+#ifndef    JUCE_ENABLE_REALTIME_SAFETY_CHECKS
+ //#define JUCE_ENABLE_REALTIME_SAFETY_CHECKS
+#endif
+
 //==============================================================================
 // juce_graphics flags:
 
@@ -196,13 +204,13 @@
  #define JucePlugin_PluginCode             'Plug'
 #endif
 #ifndef  JucePlugin_MaxNumInputChannels
- #define JucePlugin_MaxNumInputChannels    2
+ #define JucePlugin_MaxNumInputChannels    8
 #endif
 #ifndef  JucePlugin_MaxNumOutputChannels
- #define JucePlugin_MaxNumOutputChannels   2
+ #define JucePlugin_MaxNumOutputChannels   16
 #endif
 #ifndef  JucePlugin_PreferredChannelConfigurations
- #define JucePlugin_PreferredChannelConfigurations  {1, 1}, {2, 2}
+ #define JucePlugin_PreferredChannelConfigurations  {1, 1}, {2, 2}, {6, 6}, {8, 8}, {2, 4}, {6, 12}, {8, 16}
 #endif
 #ifndef  JucePlugin_IsSynth
  #define JucePlugin_IsSynth                0
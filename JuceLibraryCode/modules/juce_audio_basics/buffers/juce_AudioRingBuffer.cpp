@@ -0,0 +1,213 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+AudioRingBuffer::AudioRingBuffer (const int numChannels, const int capacity)
+    // the AbstractFifo always keeps one slot empty, so it needs one more than the capacity
+    : fifo (capacity + 1),
+      buffer (numChannels, capacity + 1)
+{
+    jassert (capacity > 0);
+}
+
+AudioRingBuffer::~AudioRingBuffer()
+{
+}
+
+//==============================================================================
+void AudioRingBuffer::setSize (const int numChannels, const int capacity)
+{
+    jassert (capacity > 0);
+
+    buffer.setSize (numChannels, capacity + 1);
+    fifo.setTotalSize (capacity + 1);
+}
+
+void AudioRingBuffer::reset() noexcept
+{
+    fifo.reset();
+}
+
+//==============================================================================
+int AudioRingBuffer::write (const float* const* source, const int numSourceChannels, const int numSamples) noexcept
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite (numSamples, start1, size1, start2, size2);
+
+    if (size1 <= 0)
+        return 0;
+
+    for (int ch = buffer.getNumChannels(); --ch >= 0;)
+    {
+        float* const dest = buffer.getSampleData (ch);
+        const float* const src = ch < numSourceChannels ? source[ch] : nullptr;
+
+        if (src != nullptr)
+        {
+            FloatVectorOperations::copy (dest + start1, src, size1);
+
+            if (size2 > 0)
+                FloatVectorOperations::copy (dest + start2, src + size1, size2);
+        }
+        else
+        {
+            FloatVectorOperations::clear (dest + start1, size1);
+
+            if (size2 > 0)
+                FloatVectorOperations::clear (dest + start2, size2);
+        }
+    }
+
+    finishedWrite (size1 + size2);
+    return size1 + size2;
+}
+
+int AudioRingBuffer::write (const AudioSampleBuffer& source, const int startSample, const int numSamples) noexcept
+{
+    jassert (startSample >= 0 && startSample + numSamples <= source.getNumSamples());
+
+    const float* channels [32] = { 0 };
+    jassert (source.getNumChannels() <= numElementsInArray (channels));
+    const int numChannels = jmin (source.getNumChannels(), (int) numElementsInArray (channels));
+
+    for (int i = 0; i < numChannels; ++i)
+        channels[i] = source.getSampleData (i, startSample);
+
+    return write (channels, numChannels, numSamples);
+}
+
+int AudioRingBuffer::writeSilence (const int numSamples) noexcept
+{
+    return write (nullptr, 0, numSamples);
+}
+
+//==============================================================================
+int AudioRingBuffer::read (float* const* dest, const int numDestChannels, const int numSamples) noexcept
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead (numSamples, start1, size1, start2, size2);
+
+    if (size1 <= 0)
+        return 0;
+
+    const int numChannels = jmin (numDestChannels, buffer.getNumChannels());
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        if (float* const d = dest[ch])
+        {
+            const float* const src = buffer.getSampleData (ch);
+            FloatVectorOperations::copy (d, src + start1, size1);
+
+            if (size2 > 0)
+                FloatVectorOperations::copy (d + size1, src + start2, size2);
+        }
+    }
+
+    finishedRead (size1 + size2);
+    return size1 + size2;
+}
+
+int AudioRingBuffer::read (AudioSampleBuffer& dest, const int startSample, const int numSamples) noexcept
+{
+    jassert (startSample >= 0 && startSample + numSamples <= dest.getNumSamples());
+
+    float* channels [32] = { 0 };
+    jassert (dest.getNumChannels() <= numElementsInArray (channels));
+    const int numChannels = jmin (dest.getNumChannels(), (int) numElementsInArray (channels));
+
+    for (int i = 0; i < numChannels; ++i)
+        channels[i] = dest.getSampleData (i, startSample);
+
+    return read (channels, numChannels, numSamples);
+}
+
+int AudioRingBuffer::discard (const int numSamples) noexcept
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead (numSamples, start1, size1, start2, size2);
+
+    if (size1 <= 0)
+        return 0;
+
+    finishedRead (size1 + size2);
+    return size1 + size2;
+}
+
+//==============================================================================
+void AudioRingBuffer::finishedWrite (const int numWritten) noexcept
+{
+    fifo.finishedWrite (numWritten);
+
+    // This has to come after the position is published: a reader that registers
+    // itself before that point will either see the new data or get the signal.
+    if (numReadersWaiting.get() != 0)
+        dataAvailable.signal();
+}
+
+void AudioRingBuffer::finishedRead (const int numRead) noexcept
+{
+    fifo.finishedRead (numRead);
+
+    if (numWritersWaiting.get() != 0)
+        spaceAvailable.signal();
+}
+
+bool AudioRingBuffer::waitForData (const int minSamples, const int timeOutMilliseconds)
+{
+    jassert (minSamples <= getCapacity());
+
+    if (getNumReady() >= minSamples)
+        return true;
+
+    ++numReadersWaiting;
+
+    if (getNumReady() < minSamples)
+        dataAvailable.wait (timeOutMilliseconds);
+
+    --numReadersWaiting;
+    return getNumReady() >= minSamples;
+}
+
+bool AudioRingBuffer::waitForSpace (const int numSamples, const int timeOutMilliseconds)
+{
+    jassert (numSamples <= getCapacity());
+
+    if (getFreeSpace() >= numSamples)
+        return true;
+
+    ++numWritersWaiting;
+
+    if (getFreeSpace() < numSamples)
+        spaceAvailable.wait (timeOutMilliseconds);
+
+    --numWritersWaiting;
+    return getFreeSpace() >= numSamples;
+}
+
+void AudioRingBuffer::releaseWaitingThreads()
+{
+    dataAvailable.signal();
+    spaceAvailable.signal();
+}
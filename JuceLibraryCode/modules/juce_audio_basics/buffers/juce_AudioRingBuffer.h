@@ -0,0 +1,152 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+#ifndef __JUCE_AUDIORINGBUFFER_JUCEHEADER__
+#define __JUCE_AUDIORINGBUFFER_JUCEHEADER__
+
+#include "juce_AudioSampleBuffer.h"
+
+
+//==============================================================================
+/**
+    A single-producer, single-consumer ring buffer of non-interleaved float samples.
+
+    This wraps an AbstractFifo together with the storage and the copying that every
+    user of one ends up writing, so that audio can be handed between the audio
+    thread and a worker without any locks. The producer calls write(), the consumer
+    calls read(), and each side may run on its own thread at the same time. Both are
+    wait-free and never allocate: they copy as much as will fit (or as much as is
+    available), using the SIMD routines from FloatVectorOperations, and return the
+    number of samples that were actually transferred.
+
+    The positions are published through the AbstractFifo's atomics, which act as full
+    memory barriers, so the consumer always sees the sample data that was written
+    before the position that it reads.
+
+    If one side would rather sleep than poll, it can use waitForData() or
+    waitForSpace(). The other side then has to signal an event after each transfer,
+    but only while a waiter is actually asleep, so a real-time side that's talking to
+    a polling partner never touches a lock.
+
+    @see AbstractFifo
+*/
+class JUCE_API  AudioRingBuffer
+{
+public:
+    //==============================================================================
+    /** Creates a ring buffer.
+        @param numChannels  the number of channels to store
+        @param capacity     the number of samples per channel that can be held at once
+    */
+    AudioRingBuffer (int numChannels, int capacity);
+
+    /** Destructor. */
+    ~AudioRingBuffer();
+
+    //==============================================================================
+    /** Changes the size of the buffer and empties it.
+        This allocates memory, and mustn't be called while either side is using the buffer.
+    */
+    void setSize (int numChannels, int capacity);
+
+    /** Discards all the buffered samples.
+        This mustn't be called while either side is using the buffer.
+    */
+    void reset() noexcept;
+
+    /** Returns the number of channels. */
+    int getNumChannels() const noexcept                     { return buffer.getNumChannels(); }
+
+    /** Returns the number of samples per channel that the buffer can hold. */
+    int getCapacity() const noexcept                        { return fifo.getTotalSize() - 1; }
+
+    /** Returns the number of samples that are waiting to be read. */
+    int getNumReady() const noexcept                        { return fifo.getNumReady(); }
+
+    /** Returns the number of samples that could be written without overflowing. */
+    int getFreeSpace() const noexcept                       { return getCapacity() - fifo.getNumReady(); }
+
+    //==============================================================================
+    /** Appends as many samples as will fit, and returns the number written.
+
+        Only the producer thread may call this. If the source has fewer channels than
+        the buffer, or some of its channel pointers are null, those channels are
+        filled with silence.
+    */
+    int write (const float* const* source, int numSourceChannels, int numSamples) noexcept;
+
+    /** Appends as many samples from an AudioSampleBuffer as will fit, and returns the number written. */
+    int write (const AudioSampleBuffer& source, int startSample, int numSamples) noexcept;
+
+    /** Appends up to numSamples of silence, and returns the number written. */
+    int writeSilence (int numSamples) noexcept;
+
+    //==============================================================================
+    /** Removes up to numSamples from the buffer, and returns the number read.
+
+        Only the consumer thread may call this. Destination channels beyond the ones
+        in the buffer are left untouched, and null channel pointers are skipped.
+    */
+    int read (float* const* dest, int numDestChannels, int numSamples) noexcept;
+
+    /** Removes up to numSamples into an AudioSampleBuffer, and returns the number read. */
+    int read (AudioSampleBuffer& dest, int startSample, int numSamples) noexcept;
+
+    /** Throws away up to numSamples without copying them, and returns the number discarded. */
+    int discard (int numSamples) noexcept;
+
+    //==============================================================================
+    /** Blocks the consumer until at least minSamples are ready, or until the timeout
+        expires or releaseWaitingThreads() is called.
+        Returns true if the samples are ready.
+    */
+    bool waitForData (int minSamples, int timeOutMilliseconds);
+
+    /** Blocks the producer until there's room for at least numSamples, or until the
+        timeout expires or releaseWaitingThreads() is called.
+        Returns true if the space is available.
+    */
+    bool waitForSpace (int numSamples, int timeOutMilliseconds);
+
+    /** Wakes up any thread that's blocked in waitForData() or waitForSpace(), e.g. when
+        the stream is ending or being cancelled.
+    */
+    void releaseWaitingThreads();
+
+private:
+    //==============================================================================
+    AbstractFifo fifo;
+    AudioSampleBuffer buffer;
+    WaitableEvent dataAvailable, spaceAvailable;
+    Atomic<int> numReadersWaiting, numWritersWaiting;
+
+    void finishedWrite (int numWritten) noexcept;
+    void finishedRead (int numRead) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioRingBuffer)
+};
+
+
+#endif   // __JUCE_AUDIORINGBUFFER_JUCEHEADER__
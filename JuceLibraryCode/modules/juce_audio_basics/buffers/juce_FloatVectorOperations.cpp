@@ -342,3 +342,159 @@ float JUCE_CALLTYPE FloatVectorOperations::findMaximum (const float* src, int nu
     return juce::findMaximum (src, num);
    #endif
 }
+
+double JUCE_CALLTYPE FloatVectorOperations::findSumOfSquares (const float* src, int num) noexcept
+{
+    double total = 0;
+
+   #if JUCE_USE_SSE_INTRINSICS
+    const int numLongOps = num / 4;
+
+    if (numLongOps > 1 && FloatVectorHelpers::isSSE2Available())
+    {
+        __m128 sum = _mm_setzero_ps();
+
+        #define JUCE_SUMSQUARES_SSE_LOOP(loadOp) \
+            for (int i = 0; i < numLongOps; ++i) \
+            { \
+                const __m128 s = loadOp (src); \
+                sum = _mm_add_ps (sum, _mm_mul_ps (s, s)); \
+                src += 4; \
+            }
+
+        if (FloatVectorHelpers::isAligned (src)) { JUCE_SUMSQUARES_SSE_LOOP (_mm_load_ps) }
+        else                                     { JUCE_SUMSQUARES_SSE_LOOP (_mm_loadu_ps) }
+
+        float sums[4];
+        _mm_storeu_ps (sums, sum);
+        FloatVectorHelpers::mmEmpty();
+
+        total = (double) sums[0] + sums[1] + sums[2] + sums[3];
+        num &= 3;
+    }
+   #endif
+
+    for (int i = 0; i < num; ++i)
+        total += src[i] * (double) src[i];
+
+    return total;
+}
+
+int JUCE_CALLTYPE FloatVectorOperations::countDenormals (const float* src, int num) noexcept
+{
+    int count = 0;
+
+   #if JUCE_USE_SSE_INTRINSICS
+    const int numLongOps = num / 4;
+
+    if (numLongOps > 1 && FloatVectorHelpers::isSSE2Available())
+    {
+        // with the sign removed, a denormal's bit pattern is between 0 and the smallest normal
+        const __m128i absMask = _mm_set1_epi32 (0x7fffffff);
+        const __m128i smallestNormal = _mm_set1_epi32 (0x00800000);
+        const __m128i zero = _mm_setzero_si128();
+        __m128i counts = _mm_setzero_si128();
+
+        for (int i = 0; i < numLongOps; ++i)
+        {
+            const __m128i bits = _mm_and_si128 (_mm_castps_si128 (_mm_loadu_ps (src)), absMask);
+            const __m128i isDenormal = _mm_and_si128 (_mm_cmpgt_epi32 (bits, zero),
+                                                      _mm_cmplt_epi32 (bits, smallestNormal));
+            counts = _mm_sub_epi32 (counts, isDenormal);
+            src += 4;
+        }
+
+        int lanes[4];
+        _mm_storeu_si128 ((__m128i*) lanes, counts);
+        FloatVectorHelpers::mmEmpty();
+
+        count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        num &= 3;
+    }
+   #endif
+
+    for (int i = 0; i < num; ++i)
+    {
+        const float v = src[i];
+
+        if (v != 0 && std::abs (v) < std::numeric_limits<float>::min())
+            ++count;
+    }
+
+    return count;
+}
+
+//==============================================================================
+#if JUCE_USE_SSE_INTRINSICS
+ enum { juce_mxcsrDAZ = 0x0040, juce_mxcsrFTZ = 0x8000, juce_mxcsrDenormalFlag = 0x0002 };
+#elif defined (__aarch64__) || defined (__arm64__)
+ enum { juce_fpcrFZ = 1 << 24 };
+#endif
+
+pointer_sized_int JUCE_CALLTYPE FloatVectorOperations::getFpStatusRegister() noexcept
+{
+   #if JUCE_USE_SSE_INTRINSICS
+    return (pointer_sized_int) _mm_getcsr();
+   #elif defined (__aarch64__) || defined (__arm64__)
+    pointer_sized_int fpcr;
+    asm volatile ("mrs %0, fpcr" : "=r" (fpcr));
+    return fpcr;
+   #else
+    return 0;
+   #endif
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::setFpStatusRegister (const pointer_sized_int newValue) noexcept
+{
+   #if JUCE_USE_SSE_INTRINSICS
+    _mm_setcsr ((unsigned int) newValue);
+   #elif defined (__aarch64__) || defined (__arm64__)
+    asm volatile ("msr fpcr, %0" : : "ri" (newValue));
+   #else
+    (void) newValue;
+   #endif
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::enableFlushToZeroMode (const bool shouldEnable) noexcept
+{
+   #if JUCE_USE_SSE_INTRINSICS
+    const pointer_sized_int mask = juce_mxcsrDAZ | juce_mxcsrFTZ;
+   #elif defined (__aarch64__) || defined (__arm64__)
+    const pointer_sized_int mask = juce_fpcrFZ;
+   #else
+    const pointer_sized_int mask = 0;
+   #endif
+
+    if (mask != 0)
+    {
+        const pointer_sized_int current = getFpStatusRegister();
+        setFpStatusRegister (shouldEnable ? (current | mask) : (current & ~mask));
+    }
+}
+
+bool JUCE_CALLTYPE FloatVectorOperations::getAndClearDenormalOperandFlag() noexcept
+{
+   #if JUCE_USE_SSE_INTRINSICS
+    const pointer_sized_int current = getFpStatusRegister();
+
+    if ((current & juce_mxcsrDenormalFlag) == 0)
+        return false;
+
+    setFpStatusRegister (current & ~(pointer_sized_int) juce_mxcsrDenormalFlag);
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+//==============================================================================
+ScopedNoDenormals::ScopedNoDenormals() noexcept
+    : previousState (FloatVectorOperations::getFpStatusRegister())
+{
+    FloatVectorOperations::enableFlushToZeroMode (true);
+}
+
+ScopedNoDenormals::~ScopedNoDenormals() noexcept
+{
+    FloatVectorOperations::setFpStatusRegister (previousState);
+}
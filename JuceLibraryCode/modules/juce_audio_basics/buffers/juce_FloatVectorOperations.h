@@ -73,6 +73,56 @@ public:
 
     /** Finds the maximum value in the given array. */
     static float JUCE_CALLTYPE findMaximum (const float* src, int numValues) noexcept;
+
+    /** Returns the sum of the squares of all the values in the given array. */
+    static double JUCE_CALLTYPE findSumOfSquares (const float* src, int numValues) noexcept;
+
+    /** Returns the number of denormalised values in the given array. */
+    static int JUCE_CALLTYPE countDenormals (const float* src, int numValues) noexcept;
+
+    //==============================================================================
+    /** Turns flush-to-zero mode on or off for the calling thread.
+
+        When it's on, denormalised results are replaced by zero, and denormalised inputs
+        are treated as zero (the FTZ and DAZ flags on x86, or FZ on ARM). Denormals are
+        too small to be audible, but on x86 each operation on one can cost a hundred times
+        more than normal, which makes decaying filter and reverb tails very expensive.
+    */
+    static void JUCE_CALLTYPE enableFlushToZeroMode (bool shouldEnable) noexcept;
+
+    /** Returns the calling thread's floating-point control and status register, or 0
+        if this isn't supported on the current CPU.
+    */
+    static pointer_sized_int JUCE_CALLTYPE getFpStatusRegister() noexcept;
+
+    /** Restores a value that was returned by getFpStatusRegister(). */
+    static void JUCE_CALLTYPE setFpStatusRegister (pointer_sized_int newValue) noexcept;
+
+    /** Returns true if an SSE instruction on this thread has used a denormalised operand
+        since the flag was last cleared, and then clears it.
+        Denormal inputs aren't reported while flush-to-zero mode is on, and this always
+        returns false on CPUs that don't provide the flag.
+    */
+    static bool JUCE_CALLTYPE getAndClearDenormalOperandFlag() noexcept;
+};
+
+//==============================================================================
+/**
+    Turns on flush-to-zero mode for the calling thread while this object exists, and
+    restores the previous mode when it's deleted.
+
+    @see FloatVectorOperations::enableFlushToZeroMode
+*/
+class JUCE_API  ScopedNoDenormals
+{
+public:
+    ScopedNoDenormals() noexcept;
+    ~ScopedNoDenormals() noexcept;
+
+private:
+    const pointer_sized_int previousState;
+
+    JUCE_DECLARE_NON_COPYABLE (ScopedNoDenormals)
 };
 
 
@@ -0,0 +1,465 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+namespace PolyphaseResamplerHelpers
+{
+    struct QualitySettings
+    {
+        int numTaps;
+        double attenuationDb;
+    };
+
+    static const QualitySettings qualitySettings[] =
+    {
+        { 16,  50.0 },
+        { 48,  80.0 },
+        { 96,  110.0 },
+        { 256, 140.0 }
+    };
+
+    enum { maxUpsamplingFactor = 2048, maxTapScaling = 8, numInterpolatedPhases = 256 };
+
+    /** Zeroth-order modified Bessel function of the first kind, for the Kaiser window. */
+    static double besselI0 (const double x) noexcept
+    {
+        double sum = 1.0, term = 1.0;
+        const double halfX = x * 0.5;
+
+        for (int k = 1; k < 64; ++k)
+        {
+            const double t = halfX / k;
+            term *= t * t;
+            sum += term;
+
+            if (term < sum * 1.0e-16)
+                break;
+        }
+
+        return sum;
+    }
+
+    static int64 greatestCommonDivisor (int64 a, int64 b) noexcept
+    {
+        while (b != 0)
+        {
+            const int64 t = a % b;
+            a = b;
+            b = t;
+        }
+
+        return a;
+    }
+
+    static bool isWholeNumber (const double x) noexcept
+    {
+        return std::abs (x - (double) roundToInt (x)) < 1.0e-9;
+    }
+
+    /** Tries to find L/M == outputRate / inputRate, keeping L within the table size limit.
+        Returns false if the nearest fraction that fits isn't exact.
+    */
+    static bool findRatio (const double inputRate, const double outputRate, int& up, int& down)
+    {
+        if (isWholeNumber (inputRate) && isWholeNumber (outputRate))
+        {
+            const int64 in = (int64) roundToInt (inputRate), out = (int64) roundToInt (outputRate);
+            const int64 g = greatestCommonDivisor (in, out);
+
+            if (out / g <= maxUpsamplingFactor && in / g <= std::numeric_limits<int>::max() / maxUpsamplingFactor)
+            {
+                up   = (int) (out / g);
+                down = (int) (in / g);
+                return true;
+            }
+        }
+
+        // otherwise, use the closest continued-fraction convergent that fits..
+        const double target = outputRate / inputRate;
+        int64 h0 = 0, h1 = 1, k0 = 1, k1 = 0;
+        double x = target;
+
+        up = jmax (1, roundToInt (target));
+        down = 1;
+
+        for (int i = 0; i < 32; ++i)
+        {
+            const int64 a = (int64) std::floor (x);
+            const int64 h2 = a * h1 + h0;
+            const int64 k2 = a * k1 + k0;
+
+            if (h2 > maxUpsamplingFactor || k2 > std::numeric_limits<int>::max() / maxUpsamplingFactor)
+                break;
+
+            if (h2 > 0)
+            {
+                up = (int) h2;
+                down = (int) k2;
+            }
+
+            const double remainder = x - (double) a;
+
+            if (remainder < 1.0e-12)
+                break;
+
+            x = 1.0 / remainder;
+            h0 = h1; h1 = h2;
+            k0 = k1; k1 = k2;
+        }
+
+        return std::abs (up / (double) down - target) <= target * 1.0e-9;
+    }
+
+    //==============================================================================
+    static float dotProduct (const float* coeffs, const float* src, const int num, const bool useSSE) noexcept
+    {
+       #if JUCE_USE_SSE_INTRINSICS
+        if (useSSE)
+        {
+            __m128 sum1 = _mm_setzero_ps(), sum2 = _mm_setzero_ps();
+
+            for (int i = 0; i < num; i += 8)
+            {
+                sum1 = _mm_add_ps (sum1, _mm_mul_ps (_mm_loadu_ps (coeffs + i),     _mm_loadu_ps (src + i)));
+                sum2 = _mm_add_ps (sum2, _mm_mul_ps (_mm_loadu_ps (coeffs + i + 4), _mm_loadu_ps (src + i + 4)));
+            }
+
+            float sums[4];
+            _mm_storeu_ps (sums, _mm_add_ps (sum1, sum2));
+            return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+        }
+       #else
+        (void) useSSE;
+       #endif
+
+        float sum = 0;
+
+        for (int i = 0; i < num; ++i)
+            sum += coeffs[i] * src[i];
+
+        return sum;
+    }
+
+    /** Does two channels at once, so that each coefficient only gets loaded once. */
+    static void dotProduct2 (const float* coeffs, const float* src1, const float* src2, const int num,
+                             float& result1, float& result2, const bool useSSE) noexcept
+    {
+       #if JUCE_USE_SSE_INTRINSICS
+        if (useSSE)
+        {
+            __m128 sum1 = _mm_setzero_ps(), sum2 = _mm_setzero_ps();
+
+            for (int i = 0; i < num; i += 4)
+            {
+                const __m128 c = _mm_loadu_ps (coeffs + i);
+                sum1 = _mm_add_ps (sum1, _mm_mul_ps (c, _mm_loadu_ps (src1 + i)));
+                sum2 = _mm_add_ps (sum2, _mm_mul_ps (c, _mm_loadu_ps (src2 + i)));
+            }
+
+            float sums1[4], sums2[4];
+            _mm_storeu_ps (sums1, sum1);
+            _mm_storeu_ps (sums2, sum2);
+            result1 = (sums1[0] + sums1[1]) + (sums1[2] + sums1[3]);
+            result2 = (sums2[0] + sums2[1]) + (sums2[2] + sums2[3]);
+            return;
+        }
+       #else
+        (void) useSSE;
+       #endif
+
+        float s1 = 0, s2 = 0;
+
+        for (int i = 0; i < num; ++i)
+        {
+            s1 += coeffs[i] * src1[i];
+            s2 += coeffs[i] * src2[i];
+        }
+
+        result1 = s1;
+        result2 = s2;
+    }
+}
+
+//==============================================================================
+PolyphaseResampler::PolyphaseResampler (const int numChannels_, const Quality quality_)
+    : numChannels (jmax (1, numChannels_)),
+      quality (quality_),
+      inputRate (44100.0), outputRate (44100.0),
+      upFactor (1), downFactor (1), numTaps (0), numPhases (1),
+      history (jmax (1, numChannels_), 0),
+      numInHistory (0), readPos (0), phase (0),
+      subSamplePos (0), step (1.0),
+      interpolatePhases (false), useSSE (false)
+{
+   #if JUCE_USE_SSE_INTRINSICS
+    useSSE = FloatVectorHelpers::isSSE2Available();
+   #endif
+
+    buildTable();
+}
+
+PolyphaseResampler::~PolyphaseResampler()
+{
+}
+
+void PolyphaseResampler::setRates (const double newInputRate, const double newOutputRate)
+{
+    jassert (newInputRate > 0 && newOutputRate > 0);
+
+    if (newInputRate != inputRate || newOutputRate != outputRate)
+    {
+        inputRate = newInputRate;
+        outputRate = newOutputRate;
+        buildTable();
+    }
+    else
+    {
+        reset();
+    }
+}
+
+void PolyphaseResampler::setQuality (const Quality newQuality)
+{
+    if (newQuality != quality)
+    {
+        quality = newQuality;
+        buildTable();
+    }
+    else
+    {
+        reset();
+    }
+}
+
+void PolyphaseResampler::buildTable()
+{
+    using namespace PolyphaseResamplerHelpers;
+
+    // If the ratio isn't a simple fraction, a finer table is used and the output is
+    // interpolated between its two nearest phases.
+    interpolatePhases = ! findRatio (inputRate, outputRate, upFactor, downFactor);
+    step = inputRate / outputRate;
+
+    if (interpolatePhases)
+    {
+        upFactor = downFactor = 0;
+        numPhases = numInterpolatedPhases;
+    }
+    else
+    {
+        numPhases = upFactor;
+    }
+
+    const QualitySettings& settings = qualitySettings [jlimit (0, (int) numElementsInArray (qualitySettings) - 1, (int) quality)];
+
+    // When decimating, the cut-off has to drop below the output's nyquist, so the
+    // filter gets proportionally longer to keep the same transition steepness.
+    const double bandwidth = jmin (1.0, outputRate / inputRate);
+    const double tapScale = jmin ((double) maxTapScaling, 1.0 / bandwidth);
+    numTaps = ((int) std::ceil (settings.numTaps * tapScale) + 7) & ~7;
+
+    const double atten = settings.attenuationDb;
+    const double beta = atten > 50.0 ? 0.1102 * (atten - 8.7)
+                                     : 0.5842 * std::pow (atten - 21.0, 0.4) + 0.07886 * (atten - 21.0);
+
+    // Place the transition band so that the stop-band starts at the lower nyquist.
+    const double transitionWidth = (atten - 8.0) / (2.285 * (numTaps - 1) * double_Pi);
+    const double cutoff = jmax (bandwidth * 0.5, bandwidth - transitionWidth * 0.5);
+
+    const int halfTaps = numTaps / 2;
+    const double i0Beta = besselI0 (beta);
+    // (the interpolated table has an extra row for a whole-sample offset, so that
+    // every phase has a neighbour to interpolate with)
+    const int numRows = interpolatePhases ? numPhases + 1 : numPhases;
+    coefficients.malloc ((size_t) (numRows * numTaps));
+
+    for (int p = 0; p < numRows; ++p)
+    {
+        float* const row = coefficients + p * numTaps;
+        const double frac = p / (double) numPhases;
+        double sum = 0;
+
+        for (int j = 0; j < numTaps; ++j)
+        {
+            const double t = (j - (halfTaps - 1)) - frac;
+            const double x = t / halfTaps;
+            const double window = std::abs (x) < 1.0 ? besselI0 (beta * std::sqrt (1.0 - x * x)) / i0Beta : 0.0;
+            const double arg = double_Pi * cutoff * t;
+            const double sinc = std::abs (arg) < 1.0e-12 ? 1.0 : std::sin (arg) / arg;
+
+            const double h = cutoff * sinc * window;
+            row[j] = (float) h;
+            sum += h;
+        }
+
+        // normalise each phase for unity gain at DC, to avoid any ripple at the phase rate
+        FloatVectorOperations::multiply (row, (float) (1.0 / sum), numTaps);
+    }
+
+    reset();
+}
+
+void PolyphaseResampler::reset()
+{
+    // the history starts with enough silence for output 0 to be centred on input 0
+    numInHistory = 0;
+    readPos = 0;
+    phase = 0;
+    subSamplePos = 0;
+    pushSilence (numTaps / 2 - 1);
+}
+
+void PolyphaseResampler::ensureHistorySpace (const int numExtraSamples)
+{
+    const int needed = numInHistory + numExtraSamples;
+
+    if (needed > history.getNumSamples())
+        history.setSize (numChannels, jmax (needed, history.getNumSamples() * 2, 1024), true, true, true);
+}
+
+void PolyphaseResampler::pushSamples (const float* const* inputChannels, const int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    ensureHistorySpace (numSamples);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        history.copyFrom (ch, numInHistory, inputChannels[ch], numSamples);
+
+    numInHistory += numSamples;
+}
+
+void PolyphaseResampler::pushSilence (const int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    ensureHistorySpace (numSamples);
+    history.clear (numInHistory, numSamples);
+    numInHistory += numSamples;
+}
+
+int PolyphaseResampler::getNumOutputSamplesAvailable() const noexcept
+{
+    const int spare = numInHistory - numTaps - readPos;
+
+    if (spare < 0)
+        return 0;
+
+    // counts the outputs n for which readPos + (phase + n * M) / L + numTaps <= numInHistory
+    if (interpolatePhases)
+        return jmax (0, (int) std::ceil ((spare + 1 - subSamplePos) / step) - 1);
+
+    const int64 n = ((spare + 1) * (int64) upFactor - phase + downFactor - 1) / downFactor;
+    return (int) jmin ((int64) std::numeric_limits<int>::max(), n);
+}
+
+int PolyphaseResampler::getNumInputSamplesNeeded (const int numOutputSamples) const noexcept
+{
+    if (numOutputSamples <= 0)
+        return 0;
+
+    const int64 lastPos = interpolatePhases ? readPos + (int64) (subSamplePos + (numOutputSamples - 1) * step) + 1
+                                            : readPos + (phase + (numOutputSamples - 1) * (int64) downFactor) / upFactor;
+    return (int) jmax ((int64) 0, lastPos + numTaps - numInHistory);
+}
+
+int64 PolyphaseResampler::getNumOutputSamplesFor (const int64 numInputSamples) const noexcept
+{
+    if (interpolatePhases)
+        return (int64) std::ceil (numInputSamples / step);
+
+    return (numInputSamples * upFactor + downFactor - 1) / downFactor;
+}
+
+int PolyphaseResampler::pullSamples (float* const* outputChannels, const int maxSamples)
+{
+    using namespace PolyphaseResamplerHelpers;
+
+    const int numToDo = jmin (maxSamples, getNumOutputSamplesAvailable());
+
+    if (interpolatePhases)
+    {
+        for (int i = 0; i < numToDo; ++i)
+        {
+            const double phasePos = subSamplePos * numPhases;
+            const int rowIndex = jmin (numPhases - 1, (int) phasePos);
+            const float alpha = (float) (phasePos - rowIndex);
+            const float* const row1 = coefficients + rowIndex * numTaps;
+            const float* const row2 = row1 + numTaps;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const float* const src = history.getSampleData (ch, readPos);
+                const float s1 = dotProduct (row1, src, numTaps, useSSE);
+                const float s2 = dotProduct (row2, src, numTaps, useSSE);
+                outputChannels[ch][i] = s1 + alpha * (s2 - s1);
+            }
+
+            subSamplePos += step;
+            const int wholeSamples = (int) subSamplePos;
+            readPos += wholeSamples;
+            subSamplePos -= wholeSamples;
+        }
+    }
+    else for (int i = 0; i < numToDo; ++i)
+    {
+        const float* const row = coefficients + phase * numTaps;
+        int ch = 0;
+
+        for (; ch + 1 < numChannels; ch += 2)
+            dotProduct2 (row, history.getSampleData (ch, readPos), history.getSampleData (ch + 1, readPos),
+                         numTaps, outputChannels[ch][i], outputChannels[ch + 1][i], useSSE);
+
+        if (ch < numChannels)
+            outputChannels[ch][i] = dotProduct (row, history.getSampleData (ch, readPos), numTaps, useSSE);
+
+        phase += downFactor;
+        readPos += phase / upFactor;
+        phase %= upFactor;
+    }
+
+    // discard the input that no future output will need
+    if (readPos >= numInHistory)
+    {
+        // (when decimating heavily, the next output may start beyond the input received so far)
+        readPos -= numInHistory;
+        numInHistory = 0;
+    }
+    else if (readPos > 0)
+    {
+        const int numToKeep = numInHistory - readPos;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* const data = history.getSampleData (ch);
+            memmove (data, data + readPos, (size_t) numToKeep * sizeof (float));
+        }
+
+        numInHistory = numToKeep;
+        readPos = 0;
+    }
+
+    return numToDo;
+}
@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_POLYPHASERESAMPLER_JUCEHEADER__
+#define __JUCE_POLYPHASERESAMPLER_JUCEHEADER__
+
+#include "../buffers/juce_AudioSampleBuffer.h"
+
+
+//==============================================================================
+/**
+    A multichannel sample-rate converter using a polyphase windowed-sinc filter.
+
+    The conversion ratio is expressed as a fraction L/M, and a table of L sets of
+    Kaiser-windowed sinc coefficients is built whenever the rates are changed, so each
+    output sample costs one dot-product per channel. Common rate pairs such as
+    44.1k <-> 48k <-> 96k are exact fractions with small tables. For ratios that
+    can't be expressed as a small enough fraction, a fixed table of 256 phases is used
+    and each output is interpolated between the two nearest ones, at twice the cost.
+
+    The output is time-aligned with the input, i.e. output sample 0 is centred on
+    input sample 0. Because the filter needs a few samples of look-ahead, some input
+    has to be pushed before the first outputs become available; to get the end of a
+    stream out, push some silence after it.
+
+    Unlike LagrangeInterpolator, a single object handles all the channels of a stream.
+
+    @see PolyphaseResamplingAudioSource, LagrangeInterpolator
+*/
+class JUCE_API  PolyphaseResampler
+{
+public:
+    //==============================================================================
+    /** The available quality settings. Higher ones use longer filters with a
+        narrower transition band and more stop-band attenuation.
+    */
+    enum Quality
+    {
+        fastQuality = 0,    /**< 16 taps, ~50dB stop-band. */
+        standardQuality,    /**< 48 taps, ~80dB stop-band. */
+        highQuality,        /**< 96 taps, ~110dB stop-band. */
+        masteringQuality    /**< 256 taps, ~140dB stop-band, pass-band flat to ~93% of nyquist. */
+    };
+
+    /** Creates a resampler for a number of channels. */
+    PolyphaseResampler (int numChannels, Quality quality = highQuality);
+
+    /** Destructor. */
+    ~PolyphaseResampler();
+
+    //==============================================================================
+    /** Sets the input and output rates, rebuilding the filter table if necessary.
+        This also calls reset().
+    */
+    void setRates (double inputSampleRate, double outputSampleRate);
+
+    /** Changes the quality setting. This also calls reset(). */
+    void setQuality (Quality newQuality);
+
+    /** Returns the current quality setting. */
+    Quality getQuality() const noexcept                 { return quality; }
+
+    /** Returns the interpolation factor L of the ratio that's being used, or 0 if
+        the ratio isn't a simple fraction and the phases are being interpolated.
+    */
+    int getUpsamplingFactor() const noexcept            { return upFactor; }
+
+    /** Returns the decimation factor M of the ratio that's being used, or 0 if
+        the ratio isn't a simple fraction and the phases are being interpolated.
+    */
+    int getDownsamplingFactor() const noexcept          { return downFactor; }
+
+    /** Returns the number of taps in each phase of the filter. */
+    int getNumTaps() const noexcept                     { return numTaps; }
+
+    /** Clears the stored input, ready for a new stream. */
+    void reset();
+
+    //==============================================================================
+    /** Adds some input to the stream. */
+    void pushSamples (const float* const* inputChannels, int numSamples);
+
+    /** Adds some silence to the stream. */
+    void pushSilence (int numSamples);
+
+    /** Returns the number of output samples that can be produced from the input
+        that's been pushed so far.
+    */
+    int getNumOutputSamplesAvailable() const noexcept;
+
+    /** Returns the number of extra input samples that must be pushed before the
+        given number of output samples will be available.
+    */
+    int getNumInputSamplesNeeded (int numOutputSamples) const noexcept;
+
+    /** Produces up to maxSamples output samples, and returns the number written. */
+    int pullSamples (float* const* outputChannels, int maxSamples);
+
+    /** Returns the number of output samples corresponding to a number of input samples. */
+    int64 getNumOutputSamplesFor (int64 numInputSamples) const noexcept;
+
+private:
+    //==============================================================================
+    const int numChannels;
+    Quality quality;
+    double inputRate, outputRate;
+    int upFactor, downFactor, numTaps, numPhases;
+    HeapBlock<float> coefficients;
+    AudioSampleBuffer history;
+    int numInHistory, readPos, phase;
+    double subSamplePos, step;
+    bool interpolatePhases, useSSE;
+
+    void buildTable();
+    void ensureHistorySpace (int numExtraSamples);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PolyphaseResampler)
+};
+
+
+#endif   // __JUCE_POLYPHASERESAMPLER_JUCEHEADER__
@@ -35,6 +35,9 @@ namespace juce
 #ifndef __JUCE_AUDIODATACONVERTERS_JUCEHEADER__
  #include "buffers/juce_AudioDataConverters.h"
 #endif
+#ifndef __JUCE_AUDIORINGBUFFER_JUCEHEADER__
+ #include "buffers/juce_AudioRingBuffer.h"
+#endif
 #ifndef __JUCE_AUDIOSAMPLEBUFFER_JUCEHEADER__
  #include "buffers/juce_AudioSampleBuffer.h"
 #endif
@@ -50,6 +53,9 @@ namespace juce
 #ifndef __JUCE_LAGRANGEINTERPOLATOR_JUCEHEADER__
  #include "effects/juce_LagrangeInterpolator.h"
 #endif
+#ifndef __JUCE_POLYPHASERESAMPLER_JUCEHEADER__
+ #include "effects/juce_PolyphaseResampler.h"
+#endif
 #ifndef __JUCE_REVERB_JUCEHEADER__
  #include "effects/juce_Reverb.h"
 #endif
@@ -83,6 +89,9 @@ namespace juce
 #ifndef __JUCE_MIXERAUDIOSOURCE_JUCEHEADER__
  #include "sources/juce_MixerAudioSource.h"
 #endif
+#ifndef __JUCE_POLYPHASERESAMPLINGAUDIOSOURCE_JUCEHEADER__
+ #include "sources/juce_PolyphaseResamplingAudioSource.h"
+#endif
 #ifndef __JUCE_POSITIONABLEAUDIOSOURCE_JUCEHEADER__
  #include "sources/juce_PositionableAudioSource.h"
 #endif
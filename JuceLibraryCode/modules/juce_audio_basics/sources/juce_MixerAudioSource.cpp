@@ -22,8 +22,16 @@
   ==============================================================================
 */
 
+struct MixerAudioSource::InputList
+{
+    Array <AudioSource*> sources;
+    BigInteger sourcesToDelete;
+};
+
+//==============================================================================
 MixerAudioSource::MixerAudioSource()
-    : tempBuffer (2, 0),
+    : inputs (new InputList()),
+      tempBuffer (2, 0),
       currentSampleRate (0.0),
       bufferSizeExpected (0)
 {
@@ -37,24 +45,22 @@ MixerAudioSource::~MixerAudioSource()
 //==============================================================================
 void MixerAudioSource::addInputSource (AudioSource* input, const bool deleteWhenRemoved)
 {
-    if (input != nullptr && ! inputs.contains (input))
+    if (input != nullptr)
     {
-        double localRate;
-        int localBufferSize;
+        const ScopedLock sl (lock);
+        const InputList& current = *inputs.get();
 
-        {
-            const ScopedLock sl (lock);
-            localRate = currentSampleRate;
-            localBufferSize = bufferSizeExpected;
-        }
+        if (current.sources.contains (input))
+            return;
 
-        if (localRate > 0.0)
-            input->prepareToPlay (localBufferSize, localRate);
+        if (currentSampleRate > 0.0)
+            input->prepareToPlay (bufferSizeExpected, currentSampleRate);
 
-        const ScopedLock sl (lock);
+        InputList* const newList = new InputList (current);
+        newList->sourcesToDelete.setBit (newList->sources.size(), deleteWhenRemoved);
+        newList->sources.add (input);
 
-        inputsToDelete.setBit (inputs.size(), deleteWhenRemoved);
-        inputs.add (input);
+        delete inputs.exchange (newList);
     }
 }
 
@@ -66,16 +72,20 @@ void MixerAudioSource::removeInputSource (AudioSource* const input)
 
         {
             const ScopedLock sl (lock);
-            const int index = inputs.indexOf (input);
+            const InputList& current = *inputs.get();
+            const int index = current.sources.indexOf (input);
 
             if (index < 0)
                 return;
 
-            if (inputsToDelete [index])
+            if (current.sourcesToDelete [index])
                 toDelete = input;
 
-            inputsToDelete.shiftBits (-1, index);
-            inputs.remove (index);
+            InputList* const newList = new InputList (current);
+            newList->sourcesToDelete.shiftBits (-1, index);
+            newList->sources.remove (index);
+
+            delete inputs.exchange (newList);
         }
 
         input->releaseResources();
@@ -88,12 +98,11 @@ void MixerAudioSource::removeAllInputs()
 
     {
         const ScopedLock sl (lock);
+        const ScopedPointer<InputList> oldList (inputs.exchange (new InputList()));
 
-        for (int i = inputs.size(); --i >= 0;)
-            if (inputsToDelete[i])
-                toDelete.add (inputs.getUnchecked(i));
-
-        inputs.clear();
+        for (int i = oldList->sources.size(); --i >= 0;)
+            if (oldList->sourcesToDelete[i])
+                toDelete.add (oldList->sources.getUnchecked(i));
     }
 
     for (int i = toDelete.size(); --i >= 0;)
@@ -105,20 +114,22 @@ void MixerAudioSource::prepareToPlay (int samplesPerBlockExpected, double sample
     tempBuffer.setSize (2, samplesPerBlockExpected);
 
     const ScopedLock sl (lock);
+    const InputList& current = *inputs.get();
 
     currentSampleRate = sampleRate;
     bufferSizeExpected = samplesPerBlockExpected;
 
-    for (int i = inputs.size(); --i >= 0;)
-        inputs.getUnchecked(i)->prepareToPlay (samplesPerBlockExpected, sampleRate);
+    for (int i = current.sources.size(); --i >= 0;)
+        current.sources.getUnchecked(i)->prepareToPlay (samplesPerBlockExpected, sampleRate);
 }
 
 void MixerAudioSource::releaseResources()
 {
     const ScopedLock sl (lock);
+    const InputList& current = *inputs.get();
 
-    for (int i = inputs.size(); --i >= 0;)
-        inputs.getUnchecked(i)->releaseResources();
+    for (int i = current.sources.size(); --i >= 0;)
+        current.sources.getUnchecked(i)->releaseResources();
 
     tempBuffer.setSize (2, 0);
 
@@ -128,22 +139,23 @@ void MixerAudioSource::releaseResources()
 
 void MixerAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
 {
-    const ScopedLock sl (lock);
+    const ReadCopyUpdatePointer<InputList>::ScopedRead current (inputs);
+    const Array <AudioSource*>& sources = current->sources;
 
-    if (inputs.size() > 0)
+    if (sources.size() > 0)
     {
-        inputs.getUnchecked(0)->getNextAudioBlock (info);
+        sources.getUnchecked(0)->getNextAudioBlock (info);
 
-        if (inputs.size() > 1)
+        if (sources.size() > 1)
         {
             tempBuffer.setSize (jmax (1, info.buffer->getNumChannels()),
-                                info.buffer->getNumSamples());
+                                info.buffer->getNumSamples(), false, false, true);
 
             AudioSourceChannelInfo info2 (&tempBuffer, 0, info.numSamples);
 
-            for (int i = 1; i < inputs.size(); ++i)
+            for (int i = 1; i < sources.size(); ++i)
             {
-                inputs.getUnchecked(i)->getNextAudioBlock (info2);
+                sources.getUnchecked(i)->getNextAudioBlock (info2);
 
                 for (int chan = 0; chan < info.buffer->getNumChannels(); ++chan)
                     info.buffer->addFrom (chan, info.startSample, tempBuffer, chan, 0, info.numSamples);
@@ -35,6 +35,11 @@
     Input sources can be added and removed while the mixer is running as long as their
     prepareToPlay() and releaseResources() methods are called before and after adding
     them to the mixer.
+
+    The audio callback never waits for the thread that's changing the inputs. The list
+    of inputs is replaced as a whole, and addInputSource(), removeInputSource() and
+    removeAllInputs() wait for any callback that's using the old list to finish before
+    they return (so they mustn't be called from inside getNextAudioBlock()).
 */
 class JUCE_API  MixerAudioSource  : public AudioSource
 {
@@ -89,8 +94,8 @@ public:
 
 private:
     //==============================================================================
-    Array <AudioSource*> inputs;
-    BigInteger inputsToDelete;
+    struct InputList;
+    ReadCopyUpdatePointer<InputList> inputs;
     CriticalSection lock;
     AudioSampleBuffer tempBuffer;
     double currentSampleRate;
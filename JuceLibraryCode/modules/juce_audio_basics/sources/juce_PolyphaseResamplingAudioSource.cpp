@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+PolyphaseResamplingAudioSource::PolyphaseResamplingAudioSource (AudioSource* const inputSource,
+                                                                const bool deleteInputWhenDeleted,
+                                                                const int numChannels_,
+                                                                const PolyphaseResampler::Quality quality)
+    : input (inputSource, deleteInputWhenDeleted),
+      resampler (numChannels_, quality),
+      inputRate (1.0), outputRate (1.0),
+      currentInputRate (1.0), currentOutputRate (1.0),
+      inputBuffer (numChannels_, 0),
+      spareOutput (numChannels_, 0),
+      numChannels (numChannels_)
+{
+    jassert (input != nullptr);
+
+    resampler.setRates (1.0, 1.0);
+    destBuffers.calloc ((size_t) numChannels);
+}
+
+PolyphaseResamplingAudioSource::~PolyphaseResamplingAudioSource() {}
+
+void PolyphaseResamplingAudioSource::setSampleRates (const double inputSampleRate, const double outputSampleRate)
+{
+    jassert (inputSampleRate > 0 && outputSampleRate > 0);
+
+    const SpinLock::ScopedLockType sl (rateLock);
+    inputRate = inputSampleRate;
+    outputRate = outputSampleRate;
+}
+
+void PolyphaseResamplingAudioSource::setResamplingRatio (const double samplesInPerOutputSample)
+{
+    setSampleRates (samplesInPerOutputSample, 1.0);
+}
+
+double PolyphaseResamplingAudioSource::getResamplingRatio() const noexcept
+{
+    const SpinLock::ScopedLockType sl (rateLock);
+    return inputRate / outputRate;
+}
+
+void PolyphaseResamplingAudioSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    input->prepareToPlay (samplesPerBlockExpected, sampleRate);
+
+    {
+        const SpinLock::ScopedLockType sl (rateLock);
+        currentInputRate = inputRate;
+        currentOutputRate = outputRate;
+    }
+
+    resampler.setRates (currentInputRate, currentOutputRate);
+
+    inputBuffer.setSize (numChannels, resampler.getNumInputSamplesNeeded (samplesPerBlockExpected) + 32);
+    spareOutput.setSize (numChannels, samplesPerBlockExpected);
+}
+
+void PolyphaseResamplingAudioSource::releaseResources()
+{
+    input->releaseResources();
+    inputBuffer.setSize (numChannels, 0);
+    spareOutput.setSize (numChannels, 0);
+}
+
+void PolyphaseResamplingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
+{
+    {
+        const SpinLock::ScopedLockType sl (rateLock);
+
+        if (currentInputRate != inputRate || currentOutputRate != outputRate)
+        {
+            currentInputRate = inputRate;
+            currentOutputRate = outputRate;
+            resampler.setRates (currentInputRate, currentOutputRate);
+        }
+    }
+
+    const int numNeeded = resampler.getNumInputSamplesNeeded (info.numSamples);
+
+    if (numNeeded > 0)
+    {
+        if (inputBuffer.getNumSamples() < numNeeded)
+            inputBuffer.setSize (numChannels, numNeeded, false, false, true);
+
+        AudioSourceChannelInfo readInfo (&inputBuffer, 0, numNeeded);
+        input->getNextAudioBlock (readInfo);
+
+        resampler.pushSamples (inputBuffer.getArrayOfChannels(), numNeeded);
+    }
+
+    // any channels that the destination doesn't have still need somewhere to go..
+    if (spareOutput.getNumSamples() < info.numSamples)
+        spareOutput.setSize (numChannels, info.numSamples, false, false, true);
+
+    const int channelsToProcess = jmin (numChannels, info.buffer->getNumChannels());
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        destBuffers[channel] = channel < channelsToProcess ? info.buffer->getSampleData (channel, info.startSample)
+                                                           : spareOutput.getSampleData (channel);
+
+    const int numDone = resampler.pullSamples (destBuffers, info.numSamples);
+    jassert (numDone == info.numSamples);
+
+    for (int channel = channelsToProcess; channel < info.buffer->getNumChannels(); ++channel)
+        info.buffer->clear (channel, info.startSample, info.numSamples);
+
+    (void) numDone;
+}
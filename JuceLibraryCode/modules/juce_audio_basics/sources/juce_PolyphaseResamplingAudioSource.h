@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_POLYPHASERESAMPLINGAUDIOSOURCE_JUCEHEADER__
+#define __JUCE_POLYPHASERESAMPLINGAUDIOSOURCE_JUCEHEADER__
+
+#include "juce_AudioSource.h"
+#include "../effects/juce_PolyphaseResampler.h"
+
+
+//==============================================================================
+/**
+    A type of AudioSource that changes the sample rate of an input source using a
+    PolyphaseResampler.
+
+    This can be used in place of a ResamplingAudioSource when quality matters more
+    than the cost of changing the ratio: each new ratio rebuilds the filter table and
+    restarts the filter, so it's intended for fixed conversions rather than for
+    varispeed playback.
+
+    @see PolyphaseResampler, ResamplingAudioSource
+*/
+class JUCE_API  PolyphaseResamplingAudioSource  : public AudioSource
+{
+public:
+    //==============================================================================
+    /** Creates a PolyphaseResamplingAudioSource for a given input source.
+
+        @param inputSource              the input source to read from
+        @param deleteInputWhenDeleted   if true, the input source will be deleted when
+                                        this object is deleted
+        @param numChannels              the number of channels to process
+        @param quality                  the filter quality to use
+    */
+    PolyphaseResamplingAudioSource (AudioSource* inputSource,
+                                    bool deleteInputWhenDeleted,
+                                    int numChannels = 2,
+                                    PolyphaseResampler::Quality quality = PolyphaseResampler::highQuality);
+
+    /** Destructor. */
+    ~PolyphaseResamplingAudioSource();
+
+    /** Sets the rates to convert between.
+        Ratios between common rates, such as 44100 and 48000, are handled exactly.
+    */
+    void setSampleRates (double inputSampleRate, double outputSampleRate);
+
+    /** Changes the resampling ratio, in the same way as ResamplingAudioSource::setResamplingRatio().
+
+        @param samplesInPerOutputSample     if set to 1.0, the input is passed through; higher
+                                            values will speed it up; lower values will slow it
+                                            down. The ratio must be greater than 0
+    */
+    void setResamplingRatio (double samplesInPerOutputSample);
+
+    /** Returns the current resampling ratio, as the number of input samples per output sample. */
+    double getResamplingRatio() const noexcept;
+
+    //==============================================================================
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate);
+    void releaseResources();
+    void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill);
+
+private:
+    //==============================================================================
+    OptionalScopedPointer<AudioSource> input;
+    PolyphaseResampler resampler;
+    double inputRate, outputRate;
+    double currentInputRate, currentOutputRate;
+    SpinLock rateLock;
+    AudioSampleBuffer inputBuffer, spareOutput;
+    const int numChannels;
+    HeapBlock<float*> destBuffers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PolyphaseResamplingAudioSource)
+};
+
+
+#endif   // __JUCE_POLYPHASERESAMPLINGAUDIOSOURCE_JUCEHEADER__
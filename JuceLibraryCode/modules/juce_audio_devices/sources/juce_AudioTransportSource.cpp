@@ -22,13 +22,27 @@
   ==============================================================================
 */
 
+// The sources that are being played. Once published, these are only changed by
+// replacing the whole chain, so that the audio thread can read it without locking.
+struct AudioTransportSource::SourceChain
+{
+    SourceChain (PositionableAudioSource* const source_)
+        : source (source_), positionableSource (source_), masterSource (source_)
+    {
+    }
+
+    PositionableAudioSource* source;
+    ScopedPointer<ResamplingAudioSource> resamplerSource;
+    ScopedPointer<BufferingAudioSource> bufferingSource;
+    PositionableAudioSource* positionableSource;
+    AudioSource* masterSource;
+
+    JUCE_DECLARE_NON_COPYABLE (SourceChain)
+};
+
+//==============================================================================
 AudioTransportSource::AudioTransportSource()
-    : source (nullptr),
-      resamplerSource (nullptr),
-      bufferingSource (nullptr),
-      positionableSource (nullptr),
-      masterSource (nullptr),
-      gain (1.0f),
+    : gain (1.0f),
       lastGain (1.0f),
       playing (false),
       stopped (true),
@@ -54,9 +68,12 @@ void AudioTransportSource::setSource (PositionableAudioSource* const newSource,
                                       double sourceSampleRateToCorrectFor,
                                       int maxNumChannels)
 {
-    if (source == newSource)
+    const ScopedLock sl (sourceLock);
+    const SourceChain* const current = sources.get();
+
+    if ((current != nullptr ? current->source : nullptr) == newSource)
     {
-        if (source == nullptr)
+        if (newSource == nullptr)
             return;
 
         setSource (nullptr, 0, nullptr); // deselect and reselect to avoid releasing resources wrongly
@@ -65,18 +82,11 @@ void AudioTransportSource::setSource (PositionableAudioSource* const newSource,
     readAheadBufferSize = readAheadBufferSize_;
     sourceSampleRate = sourceSampleRateToCorrectFor;
 
-    ResamplingAudioSource* newResamplerSource = nullptr;
-    BufferingAudioSource* newBufferingSource = nullptr;
-    PositionableAudioSource* newPositionableSource = nullptr;
-    AudioSource* newMasterSource = nullptr;
-
-    ScopedPointer <ResamplingAudioSource> oldResamplerSource (resamplerSource);
-    ScopedPointer <BufferingAudioSource> oldBufferingSource (bufferingSource);
-    AudioSource* oldMasterSource = masterSource;
+    SourceChain* newChain = nullptr;
 
     if (newSource != nullptr)
     {
-        newPositionableSource = newSource;
+        newChain = new SourceChain (newSource);
 
         if (readAheadBufferSize_ > 0)
         {
@@ -84,54 +94,46 @@ void AudioTransportSource::setSource (PositionableAudioSource* const newSource,
             // for it to use!
             jassert (readAheadThread != nullptr);
 
-            newPositionableSource = newBufferingSource
-                = new BufferingAudioSource (newPositionableSource, *readAheadThread,
+            newChain->positionableSource = newChain->bufferingSource
+                = new BufferingAudioSource (newChain->positionableSource, *readAheadThread,
                                             false, readAheadBufferSize_, maxNumChannels);
         }
 
-        newPositionableSource->setNextReadPosition (0);
+        newChain->positionableSource->setNextReadPosition (0);
 
         if (sourceSampleRateToCorrectFor > 0)
-            newMasterSource = newResamplerSource
-                = new ResamplingAudioSource (newPositionableSource, false, maxNumChannels);
+            newChain->masterSource = newChain->resamplerSource
+                = new ResamplingAudioSource (newChain->positionableSource, false, maxNumChannels);
         else
-            newMasterSource = newPositionableSource;
+            newChain->masterSource = newChain->positionableSource;
 
         if (isPrepared)
         {
-            if (newResamplerSource != nullptr && sourceSampleRate > 0 && sampleRate > 0)
-                newResamplerSource->setResamplingRatio (sourceSampleRate / sampleRate);
+            if (newChain->resamplerSource != nullptr && sourceSampleRate > 0 && sampleRate > 0)
+                newChain->resamplerSource->setResamplingRatio (sourceSampleRate / sampleRate);
 
-            newMasterSource->prepareToPlay (blockSize, sampleRate);
+            newChain->masterSource->prepareToPlay (blockSize, sampleRate);
         }
     }
 
-    {
-        const ScopedLock sl (callbackLock);
-
-        source = newSource;
-        resamplerSource = newResamplerSource;
-        bufferingSource = newBufferingSource;
-        masterSource = newMasterSource;
-        positionableSource = newPositionableSource;
+    playing = false;
 
-        playing = false;
-    }
+    // (this waits until the audio thread has finished with the old chain)
+    const ScopedPointer<SourceChain> oldChain (sources.exchange (newChain));
 
-    if (oldMasterSource != nullptr)
-        oldMasterSource->releaseResources();
+    if (oldChain != nullptr)
+        oldChain->masterSource->releaseResources();
 }
 
 void AudioTransportSource::start()
 {
-    if ((! playing) && masterSource != nullptr)
+    if ((! playing) && sources.get() != nullptr)
     {
-        {
-            const ScopedLock sl (callbackLock);
-            playing = true;
-            stopped = false;
-            inputStreamEOF = false;
-        }
+        // (playing has to be set before stopped is cleared, in case the
+        //  audio thread sees one change without the other)
+        inputStreamEOF = false;
+        playing = true;
+        stopped = false;
 
         sendChangeMessage();
     }
@@ -141,10 +143,7 @@ void AudioTransportSource::stop()
 {
     if (playing)
     {
-        {
-            const ScopedLock sl (callbackLock);
-            playing = false;
-        }
+        playing = false;
 
         int n = 500;
         while (--n >= 0 && ! stopped)
@@ -175,22 +174,26 @@ double AudioTransportSource::getLengthInSeconds() const
 
 void AudioTransportSource::setNextReadPosition (int64 newPosition)
 {
-    if (positionableSource != nullptr)
+    const ReadCopyUpdatePointer<SourceChain>::ScopedRead chain (sources);
+
+    if (chain != nullptr)
     {
         if (sampleRate > 0 && sourceSampleRate > 0)
             newPosition = (int64) (newPosition * sourceSampleRate / sampleRate);
 
-        positionableSource->setNextReadPosition (newPosition);
+        chain->positionableSource->setNextReadPosition (newPosition);
     }
 }
 
 int64 AudioTransportSource::getNextReadPosition() const
 {
-    if (positionableSource != nullptr)
+    const ReadCopyUpdatePointer<SourceChain>::ScopedRead chain (sources);
+
+    if (chain != nullptr)
     {
         const double ratio = (sampleRate > 0 && sourceSampleRate > 0) ? sampleRate / sourceSampleRate : 1.0;
 
-        return (int64) (positionableSource->getNextReadPosition() * ratio);
+        return (int64) (chain->positionableSource->getNextReadPosition() * ratio);
     }
 
     return 0;
@@ -198,13 +201,13 @@ int64 AudioTransportSource::getNextReadPosition() const
 
 int64 AudioTransportSource::getTotalLength() const
 {
-    const ScopedLock sl (callbackLock);
+    const ReadCopyUpdatePointer<SourceChain>::ScopedRead chain (sources);
 
-    if (positionableSource != nullptr)
+    if (chain != nullptr)
     {
         const double ratio = (sampleRate > 0 && sourceSampleRate > 0) ? sampleRate / sourceSampleRate : 1.0;
 
-        return (int64) (positionableSource->getTotalLength() * ratio);
+        return (int64) (chain->positionableSource->getTotalLength() * ratio);
     }
 
     return 0;
@@ -212,10 +215,10 @@ int64 AudioTransportSource::getTotalLength() const
 
 bool AudioTransportSource::isLooping() const
 {
-    const ScopedLock sl (callbackLock);
+    const ReadCopyUpdatePointer<SourceChain>::ScopedRead chain (sources);
 
-    return positionableSource != nullptr
-            && positionableSource->isLooping();
+    return chain != nullptr
+            && chain->positionableSource->isLooping();
 }
 
 void AudioTransportSource::setGain (const float newGain) noexcept
@@ -225,26 +228,30 @@ void AudioTransportSource::setGain (const float newGain) noexcept
 
 void AudioTransportSource::prepareToPlay (int samplesPerBlockExpected, double newSampleRate)
 {
-    const ScopedLock sl (callbackLock);
+    const ScopedLock sl (sourceLock);
+    SourceChain* const chain = sources.get();
 
     sampleRate = newSampleRate;
     blockSize = samplesPerBlockExpected;
 
-    if (masterSource != nullptr)
-        masterSource->prepareToPlay (samplesPerBlockExpected, sampleRate);
+    if (chain != nullptr)
+    {
+        chain->masterSource->prepareToPlay (samplesPerBlockExpected, sampleRate);
 
-    if (resamplerSource != nullptr && sourceSampleRate > 0)
-        resamplerSource->setResamplingRatio (sourceSampleRate / sampleRate);
+        if (chain->resamplerSource != nullptr && sourceSampleRate > 0)
+            chain->resamplerSource->setResamplingRatio (sourceSampleRate / sampleRate);
+    }
 
     isPrepared = true;
 }
 
 void AudioTransportSource::releaseMasterResources()
 {
-    const ScopedLock sl (callbackLock);
+    const ScopedLock sl (sourceLock);
+    SourceChain* const chain = sources.get();
 
-    if (masterSource != nullptr)
-        masterSource->releaseResources();
+    if (chain != nullptr)
+        chain->masterSource->releaseResources();
 
     isPrepared = false;
 }
@@ -256,13 +263,13 @@ void AudioTransportSource::releaseResources()
 
 void AudioTransportSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
 {
-    const ScopedLock sl (callbackLock);
+    const ReadCopyUpdatePointer<SourceChain>::ScopedRead chain (sources);
 
     inputStreamEOF = false;
 
-    if (masterSource != nullptr && ! stopped)
+    if (chain != nullptr && ! stopped)
     {
-        masterSource->getNextAudioBlock (info);
+        chain->masterSource->getNextAudioBlock (info);
 
         if (! playing)
         {
@@ -274,8 +281,8 @@ void AudioTransportSource::getNextAudioBlock (const AudioSourceChannelInfo& info
                 info.buffer->clear (info.startSample + 256, info.numSamples - 256);
         }
 
-        if (positionableSource->getNextReadPosition() > positionableSource->getTotalLength() + 1
-             && ! positionableSource->isLooping())
+        if (chain->positionableSource->getNextReadPosition() > chain->positionableSource->getTotalLength() + 1
+             && ! chain->positionableSource->isLooping())
         {
             playing = false;
             inputStreamEOF = true;
@@ -293,7 +300,11 @@ void AudioTransportSource::getNextAudioBlock (const AudioSourceChannelInfo& info
     else
     {
         info.clearActiveBufferRegion();
-        stopped = true;
+
+        // (when there's a chain, stopped is already set, and writing it again
+        //  could undo a start() that happened since it was read)
+        if (chain == nullptr)
+            stopped = true;
     }
 
     lastGain = gain;
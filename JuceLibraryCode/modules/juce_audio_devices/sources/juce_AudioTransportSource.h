@@ -37,6 +37,10 @@
     You may want to use one of these along with an AudioSourcePlayer and AudioIODevice
     to control playback of an audio file.
 
+    The audio callback never waits for the other methods. When setSource() changes
+    the source, it waits for any callback that's still reading from the old one to
+    finish before releasing it, so it mustn't be called from the audio thread.
+
     @see AudioSource, AudioSourcePlayer
 */
 class JUCE_API  AudioTransportSource  : public PositionableAudioSource,
@@ -164,13 +168,10 @@ public:
 
 private:
     //==============================================================================
-    PositionableAudioSource* source;
-    ResamplingAudioSource* resamplerSource;
-    BufferingAudioSource* bufferingSource;
-    PositionableAudioSource* positionableSource;
-    AudioSource* masterSource;
+    struct SourceChain;
+    ReadCopyUpdatePointer<SourceChain> sources;
 
-    CriticalSection callbackLock;
+    CriticalSection sourceLock;
     float volatile gain, lastGain;
     bool volatile playing, stopped;
     double sampleRate, sourceSampleRate;
@@ -639,9 +639,10 @@ public:
                             subFormat.data3 = (uint16) input->readShort();
                             input->read (subFormat.data4, sizeof (subFormat.data4));
 
-                            if (memcmp (&subFormat, &pcmFormat, sizeof (subFormat)) != 0
-                                 && memcmp (&subFormat, &IEEEFloatFormat, sizeof (subFormat)) != 0
-                                 && memcmp (&subFormat, &ambisonicFormat, sizeof (subFormat)) != 0)
+                            if (memcmp (&subFormat, &IEEEFloatFormat, sizeof (subFormat)) == 0)
+                                usesFloatingPointData = true;
+                            else if (memcmp (&subFormat, &pcmFormat, sizeof (subFormat)) != 0
+                                      && memcmp (&subFormat, &ambisonicFormat, sizeof (subFormat)) != 0)
                                 bytesPerFrame = 0;
                         }
                     }
@@ -656,6 +657,13 @@ public:
                         dataLength = length;
 
                     dataChunkStart = input->getPosition();
+
+                    // If the file has been cut short, only use the data that's actually there..
+                    const int64 totalLength = input->getTotalLength();
+
+                    if (totalLength > dataChunkStart)
+                        dataLength = jmin (dataLength, totalLength - dataChunkStart);
+
                     lengthInSamples = (bytesPerFrame > 0) ? (dataLength / bytesPerFrame) : 0;
                 }
                 else if (chunkType == chunkName ("bext"))
@@ -836,7 +844,8 @@ public:
         : AudioFormatWriter (out, TRANS (wavFormatName), sampleRate_, numChannels_, bits),
           lengthInSamples (0),
           bytesWritten (0),
-          writeFailed (false)
+          writeFailed (false),
+          isRF64 (false)
     {
         using namespace WavFileHelpers;
 
@@ -903,6 +912,16 @@ public:
             bytesWritten += bytes;
             lengthInSamples += numSamples;
 
+            // As soon as the file grows too big for a RIFF header, rewrite the header in
+            // place as RF64. The JUNK chunk that we wrote at the start has reserved exactly
+            // enough room for the ds64 chunk, so none of the audio data needs to move.
+            if (! isRF64 && getRiffChunkSize() >= 0x100000000LL)
+            {
+                const int64 endPos = output->getPosition();
+                writeHeader();
+                output->setPosition (endPos);
+            }
+
             return true;
         }
     }
@@ -911,7 +930,7 @@ private:
     MemoryBlock tempBlock, bwavChunk, smplChunk, instChunk, cueChunk, listChunk;
     uint64 lengthInSamples, bytesWritten;
     int64 headerPosition;
-    bool writeFailed;
+    bool writeFailed, isRF64;
 
     static int getChannelMask (const int numChannels) noexcept
     {
@@ -940,22 +959,12 @@ private:
         jassert (seekedOk);
 
         const size_t bytesPerFrame = numChannels * bitsPerSample / 8;
-        uint64 audioDataSize = bytesPerFrame * lengthInSamples;
+        const uint64 audioDataSize = getAudioDataSize();
+        const int64 riffChunkSize = getRiffChunkSize();
 
-        const bool isRF64 = (bytesWritten >= 0x100000000LL);
+        isRF64 = (riffChunkSize >= 0x100000000LL);
         const bool isWaveFmtEx = isRF64 || (numChannels > 2);
 
-        int64 riffChunkSize = (int64) (4 /* 'RIFF' */ + 8 + 40 /* WAVEFORMATEX */
-                                       + 8 + audioDataSize + (audioDataSize & 1)
-                                       + (bwavChunk.getSize() > 0 ? (8  + bwavChunk.getSize()) : 0)
-                                       + (smplChunk.getSize() > 0 ? (8  + smplChunk.getSize()) : 0)
-                                       + (instChunk.getSize() > 0 ? (8  + instChunk.getSize()) : 0)
-                                       + (cueChunk .getSize() > 0 ? (8  + cueChunk .getSize()) : 0)
-                                       + (listChunk.getSize() > 0 ? (12 + listChunk.getSize()) : 0)
-                                       + (8 + 28)); // (ds64 chunk)
-
-        riffChunkSize += (riffChunkSize & 1);
-
         output->writeInt (chunkName (isRF64 ? "RF64" : "RIFF"));
         output->writeInt (isRF64 ? -1 : (int) riffChunkSize);
         output->writeInt (chunkName ("WAVE"));
@@ -973,7 +982,8 @@ private:
             output->writeInt (28);  // chunk size for uncompressed data (no table)
             output->writeInt64 (riffChunkSize);
             output->writeInt64 ((int64) audioDataSize);
-            output->writeRepeatedByte (0, 12);
+            output->writeInt64 ((int64) lengthInSamples);
+            output->writeInt (0);   // table length
         }
 
         output->writeInt (chunkName ("fmt "));
@@ -1047,11 +1057,32 @@ private:
         }
 
         output->writeInt (chunkName ("data"));
-        output->writeInt (isRF64 ? -1 : (int) (lengthInSamples * bytesPerFrame));
+        output->writeInt (isRF64 ? -1 : (int) audioDataSize);
 
         usesFloatingPointData = (bitsPerSample == 32);
     }
 
+    uint64 getAudioDataSize() const noexcept
+    {
+        return (numChannels * bitsPerSample / 8) * lengthInSamples;
+    }
+
+    int64 getRiffChunkSize() const noexcept
+    {
+        const uint64 audioDataSize = getAudioDataSize();
+
+        const int64 riffChunkSize = (int64) (4 /* 'RIFF' */ + 8 + 40 /* WAVEFORMATEX */
+                                               + 8 + audioDataSize + (audioDataSize & 1)
+                                               + (bwavChunk.getSize() > 0 ? (8  + bwavChunk.getSize()) : 0)
+                                               + (smplChunk.getSize() > 0 ? (8  + smplChunk.getSize()) : 0)
+                                               + (instChunk.getSize() > 0 ? (8  + instChunk.getSize()) : 0)
+                                               + (cueChunk .getSize() > 0 ? (8  + cueChunk .getSize()) : 0)
+                                               + (listChunk.getSize() > 0 ? (12 + listChunk.getSize()) : 0)
+                                               + (8 + 28)); // (ds64 chunk)
+
+        return riffChunkSize + (riffChunkSize & 1);
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WavAudioFormatWriter)
 };
 
@@ -240,6 +240,9 @@ public:
 
     int writePendingData()
     {
+        JUCE_TRACE_SCOPE ("AudioFormatWriter::ThreadedWriter::writePendingData");
+        JUCE_TRACE_COUNTER ("ThreadedWriter samples buffered", getNumReady());
+
         const int numToDo = getTotalSize() / 4;
 
         int start1, size1, start2, size2;
@@ -22,13 +22,129 @@
   ==============================================================================
 */
 
+BufferingAudioReaderPool::BufferingAudioReaderPool (const int numThreads, const int64 maxBytesToBuffer)
+    : threadPool (jmax (1, numThreads)),
+      maxBytes (maxBytesToBuffer),
+      bytesInUse (0)
+{
+}
+
+BufferingAudioReaderPool::~BufferingAudioReaderPool()
+{
+    // You need to delete all the readers that use this pool before deleting it!
+    jassert (readers.size() == 0);
+}
+
+void BufferingAudioReaderPool::setMaxBytesToBuffer (const int64 newMaxBytes) noexcept
+{
+    const ScopedLock sl (lock);
+    maxBytes = newMaxBytes;
+}
+
+int64 BufferingAudioReaderPool::getBytesInUse() const noexcept
+{
+    const ScopedLock sl (lock);
+    return bytesInUse;
+}
+
+void BufferingAudioReaderPool::addReader (BufferingAudioReader* const reader)
+{
+    const ScopedLock sl (lock);
+    readers.add (reader);
+}
+
+void BufferingAudioReaderPool::removeReader (BufferingAudioReader* const reader)
+{
+    const ScopedLock sl (lock);
+    readers.removeFirstMatchingValue (reader);
+
+    const ScopedLock rl (reader->lock);
+    bytesInUse -= reader->blocks.size() * reader->getBytesPerBlock();
+}
+
+bool BufferingAudioReaderPool::reserve (BufferingAudioReader* const requester, const int64 numBytes,
+                                        const bool isNeededImmediately)
+{
+    OwnedArray<BufferingAudioReader::BufferedBlock> evictedBlocks;
+    const ScopedLock sl (lock);
+
+    jassert (readers.contains (requester));
+    (void) requester;
+
+    while (bytesInUse + numBytes > maxBytes)
+    {
+        BufferingAudioReader* victim = nullptr;
+        uint32 oldestTime = 0;
+
+        for (int i = readers.size(); --i >= 0;)
+        {
+            BufferingAudioReader* const r = readers.getUnchecked (i);
+            uint32 t;
+
+            if (r->getOldestUnneededBlockTime (t) && (victim == nullptr || t < oldestTime))
+            {
+                victim = r;
+                oldestTime = t;
+            }
+        }
+
+        if (victim == nullptr)
+        {
+            // If a reader is stuck waiting for this block, it's better to go over
+            // the limit than to leave it starved..
+            if (! isNeededImmediately)
+                return false;
+
+            break;
+        }
+
+        if (BufferingAudioReader::BufferedBlock* const b = victim->removeOldestUnneededBlock())
+        {
+            evictedBlocks.add (b);
+            bytesInUse -= victim->getBytesPerBlock();
+        }
+    }
+
+    bytesInUse += numBytes;
+    return true;
+}
+
+//==============================================================================
+class BufferingAudioReader::ReadAheadJob  : public ThreadPoolJob
+{
+public:
+    ReadAheadJob (BufferingAudioReader& r)
+        : ThreadPoolJob ("Read-ahead"), reader (r)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        if (reader.readNextPooledChunk() && ! shouldExit())
+            return jobNeedsRunningAgain;
+
+        return jobHasFinished;
+    }
+
+private:
+    BufferingAudioReader& reader;
+
+    JUCE_DECLARE_NON_COPYABLE (ReadAheadJob)
+};
+
+//==============================================================================
 BufferingAudioReader::BufferingAudioReader (AudioFormatReader* sourceReader,
                                             TimeSliceThread& timeSliceThread,
                                             int samplesToBuffer)
     : AudioFormatReader (nullptr, sourceReader->getFormatName()),
-      source (sourceReader), thread (timeSliceThread),
+      source (sourceReader), thread (&timeSliceThread), sharedPool (nullptr),
       nextReadPosition (0),
-      numBlocks (1 + (samplesToBuffer / samplesPerBlock))
+      numBlocks (1 + (samplesToBuffer / samplesPerBlock)),
+      numBlocksToReadAhead (numBlocks),
+      timeoutMs (0),
+      rateWindowStartTime (Time::getMillisecondCounterHiRes()),
+      samplesPerMs (0), blockReadTimeMs (0),
+      samplesInRateWindow (0)
 {
     sampleRate            = source->sampleRate;
     lengthInSamples       = source->lengthInSamples;
@@ -43,9 +159,46 @@ BufferingAudioReader::BufferingAudioReader (AudioFormatReader* sourceReader,
     timeSliceThread.addTimeSliceClient (this);
 }
 
+BufferingAudioReader::BufferingAudioReader (AudioFormatReader* sourceReader,
+                                            BufferingAudioReaderPool& pool,
+                                            int maxSamplesToBuffer)
+    : AudioFormatReader (nullptr, sourceReader->getFormatName()),
+      source (sourceReader), thread (nullptr), sharedPool (&pool),
+      nextReadPosition (0),
+      numBlocks (jmax (2, 1 + (maxSamplesToBuffer / samplesPerBlock))),
+      numBlocksToReadAhead (2),
+      timeoutMs (0),
+      rateWindowStartTime (Time::getMillisecondCounterHiRes()),
+      samplesPerMs (0), blockReadTimeMs (0),
+      samplesInRateWindow (0)
+{
+    sampleRate            = source->sampleRate;
+    lengthInSamples       = source->lengthInSamples;
+    numChannels           = source->numChannels;
+    metadataValues        = source->metadataValues;
+    bitsPerSample         = 32;
+    usesFloatingPointData = true;
+
+    readAheadJob = new ReadAheadJob (*this);
+    pool.addReader (this);
+
+    readNextPooledChunk();
+
+    const ScopedLock sl (lock);
+    triggerReadAheadIfNeeded();
+}
+
 BufferingAudioReader::~BufferingAudioReader()
 {
-    thread.removeTimeSliceClient (this);
+    if (sharedPool != nullptr)
+    {
+        sharedPool->threadPool.removeJob (readAheadJob, true, -1);
+        sharedPool->removeReader (this);
+    }
+    else
+    {
+        thread->removeTimeSliceClient (this);
+    }
 }
 
 void BufferingAudioReader::setReadTimeout (int timeoutMilliseconds) noexcept
@@ -53,6 +206,11 @@ void BufferingAudioReader::setReadTimeout (int timeoutMilliseconds) noexcept
     timeoutMs = timeoutMilliseconds;
 }
 
+int BufferingAudioReader::getCurrentReadAheadSamples() const noexcept
+{
+    return numBlocksToReadAhead * samplesPerBlock;
+}
+
 bool BufferingAudioReader::readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
                                         int64 startSampleInFile, int numSamples)
 {
@@ -62,10 +220,11 @@ bool BufferingAudioReader::readSamples (int** destSamples, int numDestChannels,
 
     const ScopedLock sl (lock);
     nextReadPosition = startSampleInFile;
+    updateConsumptionRate (numSamples);
 
     while (numSamples > 0)
     {
-        if (const BufferedBlock* const block = getBlockContaining (startSampleInFile))
+        if (BufferedBlock* const block = getBlockContaining (startSampleInFile))
         {
             const int offset = (int) (startSampleInFile - block->range.getStart());
             const int numToDo = jmin (numSamples, (int) (block->range.getEnd() - startSampleInFile));
@@ -83,12 +242,16 @@ bool BufferingAudioReader::readSamples (int** destSamples, int numDestChannels,
                 }
             }
 
+            block->lastUsedTime = startTime;
             startOffsetInDestBuffer += numToDo;
             startSampleInFile += numToDo;
             numSamples -= numToDo;
         }
         else
         {
+            if (sharedPool != nullptr)
+                triggerReadAheadIfNeeded();
+
             if (timeoutMs >= 0 && Time::getMillisecondCounter() >= startTime + timeoutMs)
             {
                 for (int j = 0; j < numDestChannels; ++j)
@@ -105,12 +268,19 @@ bool BufferingAudioReader::readSamples (int** destSamples, int numDestChannels,
         }
     }
 
+    if (sharedPool != nullptr)
+    {
+        nextReadPosition = startSampleInFile;
+        triggerReadAheadIfNeeded();
+    }
+
     return true;
 }
 
 BufferingAudioReader::BufferedBlock::BufferedBlock (AudioFormatReader& reader, int64 pos, int numSamples)
     : range (pos, pos + numSamples),
-      buffer (reader.numChannels, numSamples)
+      buffer (reader.numChannels, numSamples),
+      lastUsedTime (Time::getMillisecondCounter())
 {
     reader.read (&buffer, 0, numSamples, pos, true, true);
 }
@@ -128,6 +298,12 @@ BufferingAudioReader::BufferedBlock* BufferingAudioReader::getBlockContaining (i
     return nullptr;
 }
 
+Range<int64> BufferingAudioReader::getReadAheadRange() const noexcept
+{
+    const int64 startPos = ((nextReadPosition - 1024) / samplesPerBlock) * samplesPerBlock;
+    return Range<int64> (startPos, startPos + numBlocksToReadAhead * samplesPerBlock);
+}
+
 int BufferingAudioReader::useTimeSlice()
 {
     return readNextBufferChunk() ? 1 : 100;
@@ -135,9 +311,11 @@ int BufferingAudioReader::useTimeSlice()
 
 bool BufferingAudioReader::readNextBufferChunk()
 {
-    const int64 pos = nextReadPosition;
-    const int64 startPos = ((pos - 1024) / samplesPerBlock) * samplesPerBlock;
-    const int64 endPos = startPos + numBlocks * samplesPerBlock;
+    JUCE_TRACE_SCOPE ("BufferingAudioReader::readNextBufferChunk");
+
+    const Range<int64> readAheadRange (getReadAheadRange());
+    const int64 startPos = readAheadRange.getStart();
+    const int64 endPos = readAheadRange.getEnd();
 
     OwnedArray<BufferedBlock> newBlocks;
 
@@ -170,3 +348,129 @@ bool BufferingAudioReader::readNextBufferChunk()
 
     return true;
 }
+
+//==============================================================================
+bool BufferingAudioReader::readNextPooledChunk()
+{
+    int64 pos = -1;
+    bool isNeededImmediately = false;
+
+    {
+        const ScopedLock sl (lock);
+        updateReadAheadDepth();
+
+        const Range<int64> readAheadRange (getReadAheadRange());
+
+        for (int64 p = jmax ((int64) 0, readAheadRange.getStart()); p < readAheadRange.getEnd() && p < lengthInSamples; p += samplesPerBlock)
+        {
+            if (getBlockContaining (p) == nullptr)
+            {
+                pos = p;
+                isNeededImmediately = Range<int64> (p, p + samplesPerBlock).contains (nextReadPosition);
+                break;
+            }
+        }
+    }
+
+    if (pos < 0 || ! sharedPool->reserve (this, getBytesPerBlock(), isNeededImmediately))
+        return false;
+
+    const double startTime = Time::getMillisecondCounterHiRes();
+    BufferedBlock* const newBlock = new BufferedBlock (*source, pos, samplesPerBlock);
+    const double timeTaken = Time::getMillisecondCounterHiRes() - startTime;
+
+    const ScopedLock sl (lock);
+
+    // Jump straight up to any slow reads, but let the estimate decay gradually..
+    blockReadTimeMs = jmax (timeTaken, blockReadTimeMs * 0.9 + timeTaken * 0.1);
+    blocks.add (newBlock);
+    return true;
+}
+
+void BufferingAudioReader::updateConsumptionRate (const int numSamples) noexcept
+{
+    const double now = Time::getMillisecondCounterHiRes();
+    const double elapsed = now - rateWindowStartTime;
+    samplesInRateWindow += numSamples;
+
+    if (elapsed >= 250.0)
+    {
+        const double rate = samplesInRateWindow / elapsed;
+        samplesPerMs = rate > samplesPerMs ? rate : (samplesPerMs * 0.75 + rate * 0.25);
+
+        rateWindowStartTime = now;
+        samplesInRateWindow = 0;
+    }
+}
+
+void BufferingAudioReader::updateReadAheadDepth() noexcept
+{
+    if (sharedPool != nullptr)
+    {
+        // Try to stay far enough ahead to ride out a few worst-case block reads
+        // at the rate that samples are currently being consumed..
+        const double msToCover = 200.0 + 4.0 * blockReadTimeMs;
+        const int blocksNeeded = 2 + (int) (samplesPerMs * msToCover / samplesPerBlock);
+
+        numBlocksToReadAhead = jlimit (2, numBlocks, blocksNeeded);
+    }
+}
+
+void BufferingAudioReader::triggerReadAheadIfNeeded()
+{
+    const Range<int64> readAheadRange (getReadAheadRange());
+
+    for (int64 p = jmax ((int64) 0, readAheadRange.getStart()); p < readAheadRange.getEnd() && p < lengthInSamples; p += samplesPerBlock)
+    {
+        if (getBlockContaining (p) == nullptr)
+        {
+            if (! sharedPool->threadPool.contains (readAheadJob))
+                sharedPool->threadPool.addJob (readAheadJob, false);
+
+            break;
+        }
+    }
+}
+
+int64 BufferingAudioReader::getBytesPerBlock() const noexcept
+{
+    return (int64) numChannels * samplesPerBlock * (int64) sizeof (float);
+}
+
+bool BufferingAudioReader::getOldestUnneededBlockTime (uint32& lastUsedTime) const
+{
+    const ScopedLock sl (lock);
+    const Range<int64> readAheadRange (getReadAheadRange());
+    bool found = false;
+
+    for (int i = blocks.size(); --i >= 0;)
+    {
+        const BufferedBlock* const b = blocks.getUnchecked (i);
+
+        if (! b->range.intersects (readAheadRange) && (! found || b->lastUsedTime < lastUsedTime))
+        {
+            lastUsedTime = b->lastUsedTime;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+BufferingAudioReader::BufferedBlock* BufferingAudioReader::removeOldestUnneededBlock()
+{
+    const ScopedLock sl (lock);
+    const Range<int64> readAheadRange (getReadAheadRange());
+    int oldestIndex = -1;
+
+    for (int i = blocks.size(); --i >= 0;)
+    {
+        const BufferedBlock* const b = blocks.getUnchecked (i);
+
+        if (! b->range.intersects (readAheadRange)
+             && (oldestIndex < 0 || b->lastUsedTime < blocks.getUnchecked (oldestIndex)->lastUsedTime))
+            oldestIndex = i;
+    }
+
+    return oldestIndex >= 0 ? blocks.removeAndReturn (oldestIndex) : nullptr;
+}
@@ -25,12 +25,77 @@
 #ifndef __JUCE_BUFFERINGAUDIOFORMATREADER_JUCEHEADER__
 #define __JUCE_BUFFERINGAUDIOFORMATREADER_JUCEHEADER__
 
+class BufferingAudioReader;
+
+//==============================================================================
+/**
+    A set of worker threads and a memory budget that can be shared between many
+    BufferingAudioReader objects.
+
+    Rather than pinning a thread and a fixed-size buffer to every reader, readers
+    that are created with one of these will queue their read-ahead work on its
+    ThreadPool, and all their buffered blocks are counted against a single memory
+    limit. When the limit is reached, the least-recently used block belonging to
+    any of the readers is evicted to make room.
+
+    The pool must outlive all the readers that use it.
+
+    @see BufferingAudioReader
+*/
+class JUCE_API  BufferingAudioReaderPool
+{
+public:
+    /** Creates a pool.
+
+        @param numThreads           the number of worker threads to use for reading
+        @param maxBytesToBuffer     the total amount of memory that all the readers using
+                                    this pool are allowed to use for their buffers
+    */
+    BufferingAudioReaderPool (int numThreads, int64 maxBytesToBuffer);
+
+    /** Destructor. */
+    ~BufferingAudioReaderPool();
+
+    /** Changes the memory limit.
+        If the new limit is lower than the amount currently in use, blocks will be
+        evicted as readers need to load new ones.
+    */
+    void setMaxBytesToBuffer (int64 newMaxBytes) noexcept;
+
+    /** Returns the memory limit. */
+    int64 getMaxBytesToBuffer() const noexcept          { return maxBytes; }
+
+    /** Returns the number of bytes currently held in buffers by all the readers. */
+    int64 getBytesInUse() const noexcept;
+
+private:
+    friend class BufferingAudioReader;
+
+    ThreadPool threadPool;
+    CriticalSection lock;
+    Array<BufferingAudioReader*> readers;
+    int64 maxBytes, bytesInUse;
+
+    void addReader (BufferingAudioReader*);
+    void removeReader (BufferingAudioReader*);
+    bool reserve (BufferingAudioReader* requester, int64 numBytes, bool isNeededImmediately);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BufferingAudioReaderPool)
+};
+
+
 //==============================================================================
 /**
     An AudioFormatReader that uses a background thread to pre-read data from
     another reader.
 
-    @see AudioFormatReader
+    This can either be given a TimeSliceThread of its own to use, in which case it
+    keeps a fixed number of samples buffered ahead of the read position, or it can
+    share a BufferingAudioReaderPool with other readers. When using a pool, the
+    reader measures the rate at which samples are being consumed and how long its
+    source takes to deliver each block, and adjusts how far it reads ahead to match.
+
+    @see AudioFormatReader, BufferingAudioReaderPool
 */
 class JUCE_API  BufferingAudioReader  : public AudioFormatReader,
                                         private TimeSliceClient
@@ -50,6 +115,20 @@ public:
                           TimeSliceThread& timeSliceThread,
                           int samplesToBuffer);
 
+    /** Creates a reader which shares its worker threads and memory with other readers.
+
+        @param sourceReader         the source reader to wrap. This BufferingAudioReader
+                                    takes ownership of this object and will delete it later
+                                    when no longer needed
+        @param pool                 the pool to use for background reading and for the buffer
+                                    memory. This must not be deleted while the reader still exists.
+        @param maxSamplesToBuffer   the furthest that the reader will ever read ahead of the
+                                    current position, however fast it is being consumed.
+    */
+    BufferingAudioReader (AudioFormatReader* sourceReader,
+                          BufferingAudioReaderPool& pool,
+                          int maxSamplesToBuffer);
+
     ~BufferingAudioReader();
 
     /** Sets a number of milliseconds that the reader can block for in its readSamples()
@@ -59,14 +138,21 @@ public:
     */
     void setReadTimeout (int timeoutMilliseconds) noexcept;
 
+    /** Returns the number of samples that the reader is currently trying to keep
+        buffered ahead of the read position.
+    */
+    int getCurrentReadAheadSamples() const noexcept;
+
     bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
                       int64 startSampleInFile, int numSamples);
 
 private:
     ScopedPointer<AudioFormatReader> source;
-    TimeSliceThread& thread;
+    TimeSliceThread* const thread;
+    BufferingAudioReaderPool* const sharedPool;
     int64 nextReadPosition;
     const int numBlocks;
+    int numBlocksToReadAhead;
     int timeoutMs;
 
     enum { samplesPerBlock = 32768 };
@@ -77,14 +163,32 @@ private:
 
         Range<int64> range;
         AudioSampleBuffer buffer;
+        uint32 lastUsedTime;
     };
 
+    class ReadAheadJob;
+    friend class ReadAheadJob;
+    friend class BufferingAudioReaderPool;
+    ScopedPointer<ReadAheadJob> readAheadJob;
+
+    // These are used to estimate how far ahead the reader needs to look..
+    double rateWindowStartTime, samplesPerMs, blockReadTimeMs;
+    int64 samplesInRateWindow;
+
     CriticalSection lock;
     OwnedArray<BufferedBlock> blocks;
 
     BufferedBlock* getBlockContaining (int64 pos) const noexcept;
+    Range<int64> getReadAheadRange() const noexcept;
     int useTimeSlice();
     bool readNextBufferChunk();
+    bool readNextPooledChunk();
+    void updateConsumptionRate (int numSamples) noexcept;
+    void updateReadAheadDepth() noexcept;
+    void triggerReadAheadIfNeeded();
+    int64 getBytesPerBlock() const noexcept;
+    bool getOldestUnneededBlockTime (uint32& lastUsedTime) const;
+    BufferedBlock* removeOldestUnneededBlock();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BufferingAudioReader)
 };
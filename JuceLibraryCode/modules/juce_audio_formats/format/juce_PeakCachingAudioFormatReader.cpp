@@ -0,0 +1,480 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+namespace LevelPyramidHelpers
+{
+    static const int fileMagicNumber = (int) ByteOrder::littleEndianInt ("JLVL");
+    static const int fileVersion = 1;
+}
+
+AudioLevelPyramid::Levels::Levels() noexcept
+    : minimum (std::numeric_limits<float>::max()),
+      maximum (-std::numeric_limits<float>::max()),
+      sumOfSquares (0), numSamples (0)
+{
+}
+
+void AudioLevelPyramid::Levels::add (const Levels& other) noexcept
+{
+    minimum = jmin (minimum, other.minimum);
+    maximum = jmax (maximum, other.maximum);
+    sumOfSquares += other.sumOfSquares;
+    numSamples += other.numSamples;
+}
+
+float AudioLevelPyramid::Levels::getRMS() const noexcept
+{
+    return numSamples > 0 ? (float) std::sqrt (sumOfSquares / (double) numSamples) : 0.0f;
+}
+
+//==============================================================================
+AudioLevelPyramid::AudioLevelPyramid (const int numChans, const int blockSize)
+    : numChannels (jlimit (1, 2, numChans)),
+      samplesPerBlock (jmax (16, blockSize))
+{
+    clear();
+}
+
+AudioLevelPyramid::~AudioLevelPyramid()
+{
+}
+
+void AudioLevelPyramid::clear()
+{
+    levels.clear();
+    levels.add (new Array<Entry>());
+    numSamplesAdded = 0;
+    finished = false;
+    numPending = 0;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        pending[i].minimum = std::numeric_limits<float>::max();
+        pending[i].maximum = -std::numeric_limits<float>::max();
+        pending[i].sumOfSquares = 0;
+    }
+}
+
+void AudioLevelPyramid::addToPending (const int channel, const float* const data, const int num) noexcept
+{
+    float mn, mx;
+    FloatVectorOperations::findMinAndMax (data, num, mn, mx);
+
+    Entry& e = pending[channel];
+    e.minimum = jmin (e.minimum, mn);
+    e.maximum = jmax (e.maximum, mx);
+    e.sumOfSquares += (float) FloatVectorOperations::findSumOfSquares (data, num);
+}
+
+void AudioLevelPyramid::flushPending()
+{
+    Array<Entry>& level0 = *levels.getUnchecked (0);
+
+    for (int i = 0; i < numChannels; ++i)
+    {
+        level0.add (pending[i]);
+
+        pending[i].minimum = std::numeric_limits<float>::max();
+        pending[i].maximum = -std::numeric_limits<float>::max();
+        pending[i].sumOfSquares = 0;
+    }
+
+    numPending = 0;
+}
+
+void AudioLevelPyramid::addSamples (const float* const* channels, const int numSourceChannels, int numSamples)
+{
+    jassert (! finished);    // you need to clear the pyramid before adding more data to it
+    jassert (numSourceChannels > 0);
+
+    int offset = 0;
+
+    while (numSamples > 0)
+    {
+        const int numToDo = jmin (numSamples, samplesPerBlock - numPending);
+
+        for (int i = 0; i < numChannels; ++i)
+            addToPending (i, channels [jmin (i, numSourceChannels - 1)] + offset, numToDo);
+
+        numPending += numToDo;
+        numSamplesAdded += numToDo;
+        offset += numToDo;
+        numSamples -= numToDo;
+
+        if (numPending == samplesPerBlock)
+            flushPending();
+    }
+}
+
+void AudioLevelPyramid::finish()
+{
+    if (finished)
+        return;
+
+    if (numPending > 0)
+        flushPending();
+
+    while (levels.getLast()->size() > numChannels)
+    {
+        const Array<Entry>& below = *levels.getLast();
+        const int numBelow = below.size() / numChannels;
+
+        Array<Entry>* const level = new Array<Entry>();
+        level->ensureStorageAllocated (((numBelow + 1) / 2) * numChannels);
+
+        for (int i = 0; i < numBelow; i += 2)
+        {
+            for (int chan = 0; chan < numChannels; ++chan)
+            {
+                Entry e (below.getReference (i * numChannels + chan));
+
+                if (i + 1 < numBelow)
+                {
+                    const Entry& e2 = below.getReference ((i + 1) * numChannels + chan);
+                    e.minimum = jmin (e.minimum, e2.minimum);
+                    e.maximum = jmax (e.maximum, e2.maximum);
+                    e.sumOfSquares += e2.sumOfSquares;
+                }
+
+                level->add (e);
+            }
+        }
+
+        levels.add (level);
+    }
+
+    finished = true;
+}
+
+void AudioLevelPyramid::addEntry (const Entry& e, const int64 numSamplesInEntry, Levels& result) const noexcept
+{
+    result.minimum = jmin (result.minimum, e.minimum);
+    result.maximum = jmax (result.maximum, e.maximum);
+    result.sumOfSquares += e.sumOfSquares;
+    result.numSamples += numSamplesInEntry;
+}
+
+void AudioLevelPyramid::getLevels (int64 firstBlock, int64 numBlocks, Levels& left, Levels& right) const noexcept
+{
+    jassert (finished);  // the pyramid can only be queried once it has been finished
+
+    const int64 numBlocksInLevel0 = levels.getUnchecked (0)->size() / numChannels;
+    int64 b0 = jlimit ((int64) 0, numBlocksInLevel0, firstBlock);
+    int64 b1 = jlimit (b0, numBlocksInLevel0, firstBlock + numBlocks);
+    int64 samplesPerEntry = samplesPerBlock;
+
+    for (int i = 0; b0 < b1 && i < levels.size(); ++i)
+    {
+        const Array<Entry>& level = *levels.getUnchecked (i);
+
+        // Adds the entry at index b in this level, working out how many real samples it covers..
+        #define JUCE_ADD_PYRAMID_ENTRY(b) \
+        { \
+            const int64 entryStart = (b) * samplesPerEntry; \
+            const int64 numInEntry = jmin (samplesPerEntry, numSamplesAdded - entryStart); \
+            addEntry (level.getReference ((int) ((b) * numChannels)), numInEntry, left); \
+            addEntry (level.getReference ((int) ((b) * numChannels + numChannels - 1)), numInEntry, right); \
+        }
+
+        if ((b0 & 1) != 0)  { JUCE_ADD_PYRAMID_ENTRY (b0); ++b0; }
+        if ((b1 & 1) != 0)  { --b1; JUCE_ADD_PYRAMID_ENTRY (b1); }
+
+        #undef JUCE_ADD_PYRAMID_ENTRY
+
+        b0 >>= 1;
+        b1 >>= 1;
+        samplesPerEntry <<= 1;
+    }
+}
+
+//==============================================================================
+bool AudioLevelPyramid::writeTo (const File& cacheFile, const File& audioFile) const
+{
+    jassert (finished);
+
+    TemporaryFile temp (cacheFile);
+    ScopedPointer<FileOutputStream> out (temp.getFile().createOutputStream());
+
+    if (out == nullptr)
+        return false;
+
+    const Array<Entry>& level0 = *levels.getUnchecked (0);
+
+    out->writeInt (LevelPyramidHelpers::fileMagicNumber);
+    out->writeInt (LevelPyramidHelpers::fileVersion);
+    out->writeInt64 (audioFile.getSize());
+    out->writeInt64 (audioFile.getLastModificationTime().toMilliseconds());
+    out->writeInt64 (numSamplesAdded);
+    out->writeInt (numChannels);
+    out->writeInt (samplesPerBlock);
+    out->writeInt (level0.size());
+
+    for (int i = 0; i < level0.size(); ++i)
+    {
+        const Entry& e = level0.getReference (i);
+        out->writeFloat (e.minimum);
+        out->writeFloat (e.maximum);
+        out->writeFloat (e.sumOfSquares);
+    }
+
+    out->flush();
+    out = nullptr;
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+bool AudioLevelPyramid::loadFrom (const File& cacheFile, const File& audioFile, const int64 expectedNumSamples)
+{
+    clear();
+
+    FileInputStream in (cacheFile);
+
+    if (in.failedToOpen()
+         || in.readInt() != LevelPyramidHelpers::fileMagicNumber
+         || in.readInt() != LevelPyramidHelpers::fileVersion
+         || in.readInt64() != audioFile.getSize()
+         || in.readInt64() != audioFile.getLastModificationTime().toMilliseconds())
+        return false;
+
+    const int64 numSamples = in.readInt64();
+    const int numChans = in.readInt();
+    const int blockSize = in.readInt();
+    const int numEntries = in.readInt();
+
+    if (numSamples != expectedNumSamples
+         || numChans != numChannels
+         || blockSize != samplesPerBlock
+         || numEntries != (int) ((numSamples + samplesPerBlock - 1) / samplesPerBlock) * numChannels
+         || in.getNumBytesRemaining() < numEntries * 3 * (int64) sizeof (float))
+        return false;
+
+    Array<Entry>& level0 = *levels.getUnchecked (0);
+    level0.ensureStorageAllocated (numEntries);
+
+    for (int i = 0; i < numEntries; ++i)
+    {
+        Entry e;
+        e.minimum      = in.readFloat();
+        e.maximum      = in.readFloat();
+        e.sumOfSquares = in.readFloat();
+        level0.add (e);
+    }
+
+    numSamplesAdded = numSamples;
+    finish();
+    return true;
+}
+
+//==============================================================================
+PeakCachingAudioReader::PeakCachingAudioReader (AudioFormatReader* sourceReader,
+                                                const File& audioFile, const File& levelsFile)
+    : AudioFormatReader (nullptr, sourceReader->getFormatName()),
+      source (sourceReader),
+      sourceFile (audioFile),
+      cacheFile (levelsFile != File::nonexistent ? levelsFile
+                                                 : audioFile.getSiblingFile (audioFile.getFileName() + ".levels")),
+      pyramid ((int) sourceReader->numChannels),
+      scratch (1, 1)
+{
+    sampleRate            = source->sampleRate;
+    bitsPerSample         = source->bitsPerSample;
+    lengthInSamples       = source->lengthInSamples;
+    numChannels           = source->numChannels;
+    metadataValues        = source->metadataValues;
+    usesFloatingPointData = source->usesFloatingPointData;
+
+    if (! pyramid.loadFrom (cacheFile, sourceFile, lengthInSamples))
+        pyramid.clear();
+}
+
+PeakCachingAudioReader::~PeakCachingAudioReader()
+{
+}
+
+bool PeakCachingAudioReader::readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                                          int64 startSampleInFile, int numSamples)
+{
+    if (! source->readSamples (destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples))
+        return false;
+
+    // If the file is being read from start to end, we can fill in the levels as we go..
+    if (! pyramid.isFinished()
+         && startSampleInFile == pyramid.getNumSamples()
+         && numDestChannels >= pyramid.getNumChannels())
+    {
+        const int numValid = (int) jmin ((int64) numSamples, lengthInSamples - startSampleInFile);
+        const int* chans[2] = { nullptr, nullptr };
+
+        for (int i = 0; i < pyramid.getNumChannels(); ++i)
+            if (destSamples[i] != nullptr)
+                chans[i] = destSamples[i] + startOffsetInDestBuffer;
+
+        if (numValid > 0 && chans[0] != nullptr && (pyramid.getNumChannels() == 1 || chans[1] != nullptr))
+        {
+            appendToPyramid (chans, numValid);
+
+            if (pyramid.getNumSamples() >= lengthInSamples)
+                finishPyramid();
+        }
+    }
+
+    return true;
+}
+
+void PeakCachingAudioReader::appendToPyramid (const int* const* data, const int numSamples)
+{
+    const int numChans = pyramid.getNumChannels();
+
+    if (usesFloatingPointData)
+    {
+        pyramid.addSamples (reinterpret_cast<const float* const*> (data), numChans, numSamples);
+    }
+    else
+    {
+        scratch.setSize (numChans, numSamples, false, false, true);
+
+        for (int i = 0; i < numChans; ++i)
+            FloatVectorOperations::convertFixedToFloat (scratch.getSampleData (i), data[i],
+                                                        1.0f / 0x7fffffff, numSamples);
+
+        pyramid.addSamples (scratch.getArrayOfChannels(), numChans, numSamples);
+    }
+}
+
+void PeakCachingAudioReader::finishPyramid()
+{
+    pyramid.finish();
+    pyramid.writeTo (cacheFile, sourceFile);
+}
+
+void PeakCachingAudioReader::buildRemainingLevels()
+{
+    const int chunkSize = 65536;
+    const int numChans = pyramid.getNumChannels();
+    scratch.setSize (numChans, chunkSize, false, false, true);
+
+    while (pyramid.getNumSamples() < lengthInSamples)
+    {
+        const int64 pos = pyramid.getNumSamples();
+        const int numToDo = (int) jmin ((int64) chunkSize, lengthInSamples - pos);
+
+        source->read (&scratch, 0, numToDo, pos, true, true);
+        pyramid.addSamples (scratch.getArrayOfChannels(), numChans, numToDo);
+    }
+
+    finishPyramid();
+}
+
+void PeakCachingAudioReader::scanSection (const int64 start, const int numSamples,
+                                          AudioLevelPyramid::Levels& left, AudioLevelPyramid::Levels& right)
+{
+    if (numSamples <= 0)
+        return;
+
+    const int numChans = pyramid.getNumChannels();
+    scratch.setSize (numChans, numSamples, false, false, true);
+    source->read (&scratch, 0, numSamples, start, true, true);
+
+    for (int i = 0; i < numChans; ++i)
+    {
+        AudioLevelPyramid::Levels l;
+        const float* const data = scratch.getSampleData (i);
+
+        FloatVectorOperations::findMinAndMax (data, numSamples, l.minimum, l.maximum);
+        l.sumOfSquares = FloatVectorOperations::findSumOfSquares (data, numSamples);
+        l.numSamples = numSamples;
+
+        (i == 0 ? left : right).add (l);
+    }
+
+    if (numChans == 1)
+        right = left;
+}
+
+void PeakCachingAudioReader::readLevels (int64 startSampleInFile, int64 numSamples,
+                                         float& lowestLeft, float& highestLeft,
+                                         float& lowestRight, float& highestRight,
+                                         float& rmsLeft, float& rmsRight)
+{
+    if (numSamples <= 0)
+    {
+        lowestLeft = lowestRight = highestLeft = highestRight = 0;
+        rmsLeft = rmsRight = 0;
+        return;
+    }
+
+    if (! pyramid.isFinished())
+        buildRemainingLevels();
+
+    AudioLevelPyramid::Levels left, right;
+
+    // Any parts of the range that lie outside the file are read as silence..
+    const int64 start = jlimit ((int64) 0, lengthInSamples, startSampleInFile);
+    const int64 end   = jlimit (start, lengthInSamples, startSampleInFile + numSamples);
+
+    if (end - start < numSamples)
+    {
+        AudioLevelPyramid::Levels silence;
+        silence.minimum = silence.maximum = 0;
+        silence.numSamples = numSamples - (end - start);
+        left.add (silence);
+        right.add (silence);
+    }
+
+    if (end > start)
+    {
+        const int64 blockSize = pyramid.getSamplesPerBlock();
+        const int64 firstWholeBlock = (start + blockSize - 1) / blockSize;
+        const int64 endWholeBlock = (end == lengthInSamples) ? (end + blockSize - 1) / blockSize
+                                                             : end / blockSize;
+
+        if (firstWholeBlock >= endWholeBlock)
+        {
+            scanSection (start, (int) (end - start), left, right);
+        }
+        else
+        {
+            const int64 wholeBlocksEnd = jmin (end, endWholeBlock * blockSize);
+
+            scanSection (start, (int) (firstWholeBlock * blockSize - start), left, right);
+            pyramid.getLevels (firstWholeBlock, endWholeBlock - firstWholeBlock, left, right);
+            scanSection (wholeBlocksEnd, (int) (end - wholeBlocksEnd), left, right);
+        }
+    }
+
+    lowestLeft   = left.minimum;
+    highestLeft  = left.maximum;
+    lowestRight  = right.minimum;
+    highestRight = right.maximum;
+    rmsLeft      = left.getRMS();
+    rmsRight     = right.getRMS();
+}
+
+void PeakCachingAudioReader::readMaxLevels (int64 startSampleInFile, int64 numSamples,
+                                            float& lowestLeft, float& highestLeft,
+                                            float& lowestRight, float& highestRight)
+{
+    float rmsLeft, rmsRight;
+    readLevels (startSampleInFile, numSamples, lowestLeft, highestLeft, lowestRight, highestRight, rmsLeft, rmsRight);
+}
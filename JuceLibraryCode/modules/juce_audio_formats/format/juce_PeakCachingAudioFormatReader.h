@@ -0,0 +1,213 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_PEAKCACHINGAUDIOFORMATREADER_JUCEHEADER__
+#define __JUCE_PEAKCACHINGAUDIOFORMATREADER_JUCEHEADER__
+
+#include "juce_AudioFormatReader.h"
+
+
+//==============================================================================
+/**
+    A multi-resolution table of the min, max and RMS levels of a stream of audio.
+
+    The levels are collected in fixed-size blocks as samples are appended, and once
+    the stream is finished, each higher level of the pyramid merges pairs of entries
+    from the level below. The levels of any run of whole blocks can then be found by
+    combining at most two entries per level, so queries take O(log n) time regardless
+    of how long the range is.
+
+    Only the first two channels are tracked, to match AudioFormatReader::readMaxLevels().
+
+    You can fill one of these while rendering a file and save it alongside the output
+    with writeTo(), so that a PeakCachingAudioReader opened on that file later can
+    pick it up without having to scan the audio.
+
+    @see PeakCachingAudioReader
+*/
+class JUCE_API  AudioLevelPyramid
+{
+public:
+    //==============================================================================
+    /** Creates an empty pyramid.
+        @param numChannels      the number of channels in the source (only the first 2 are tracked)
+        @param samplesPerBlock  the number of samples summarised by each entry in the lowest level
+    */
+    AudioLevelPyramid (int numChannels, int samplesPerBlock = 512);
+
+    /** Destructor. */
+    ~AudioLevelPyramid();
+
+    //==============================================================================
+    /** Removes all the collected levels. */
+    void clear();
+
+    /** Appends some samples to the end of the stream being measured.
+        This can't be called after finish() until the pyramid is cleared.
+    */
+    void addSamples (const float* const* channels, int numChannels, int numSamples);
+
+    /** Flushes any partial block and builds the upper levels of the pyramid.
+        After this has been called, getLevels() can be used.
+    */
+    void finish();
+
+    /** Returns true if finish() has been called. */
+    bool isFinished() const noexcept                    { return finished; }
+
+    /** Returns the number of samples that have been added so far. */
+    int64 getNumSamples() const noexcept                { return numSamplesAdded; }
+
+    /** Returns the number of samples summarised by each block. */
+    int getSamplesPerBlock() const noexcept             { return samplesPerBlock; }
+
+    /** Returns the number of channels that are being tracked (1 or 2). */
+    int getNumChannels() const noexcept                 { return numChannels; }
+
+    //==============================================================================
+    /** Holds the accumulated levels for one channel over a range of blocks. */
+    struct Levels
+    {
+        Levels() noexcept;
+
+        /** Merges another set of levels into this one. */
+        void add (const Levels& other) noexcept;
+
+        /** Returns the RMS level of the samples that were accumulated. */
+        float getRMS() const noexcept;
+
+        float minimum, maximum;
+        double sumOfSquares;
+        int64 numSamples;
+    };
+
+    /** Finds the combined levels of a run of whole blocks.
+        The blocks are indexed from the start of the stream, and the pyramid must
+        have been finished. The results are merged into the existing contents of
+        the left and right objects.
+    */
+    void getLevels (int64 firstBlock, int64 numBlocks, Levels& left, Levels& right) const noexcept;
+
+    //==============================================================================
+    /** Saves the pyramid to a file, tagging it with the size and modification time of
+        the audio file that it describes.
+    */
+    bool writeTo (const File& cacheFile, const File& audioFile) const;
+
+    /** Attempts to load a pyramid that was saved with writeTo().
+        This will fail if the audio file's size or modification time no longer match the
+        values that were stored, or if the cached data doesn't match the expected layout.
+    */
+    bool loadFrom (const File& cacheFile, const File& audioFile, int64 expectedNumSamples);
+
+private:
+    //==============================================================================
+    struct Entry
+    {
+        float minimum, maximum, sumOfSquares;
+    };
+
+    const int numChannels, samplesPerBlock;
+    OwnedArray<Array<Entry> > levels;
+    Entry pending[2];
+    int numPending;
+    int64 numSamplesAdded;
+    bool finished;
+
+    void addToPending (int channel, const float* data, int num) noexcept;
+    void flushPending();
+    void addEntry (const Entry& e, int64 numSamplesInEntry, Levels& result) const noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioLevelPyramid)
+};
+
+
+//==============================================================================
+/**
+    An AudioFormatReader that answers readMaxLevels() using a cached AudioLevelPyramid
+    rather than re-reading the source data every time.
+
+    The pyramid is filled in as a side-effect of reading the file sequentially from
+    the start, or by a single scan the first time readMaxLevels() is called before it
+    is complete. When finished, it gets saved to a small sidecar file which is keyed
+    by the source file's size and modification time, so later readers opened on an
+    unchanged file can load it instead of scanning again.
+
+    @see AudioLevelPyramid, AudioFormatReader::readMaxLevels
+*/
+class JUCE_API  PeakCachingAudioReader  : public AudioFormatReader
+{
+public:
+    /** Creates a reader.
+
+        @param sourceReader     the source reader to wrap. This PeakCachingAudioReader
+                                takes ownership of this object and will delete it later
+                                when no longer needed
+        @param sourceFile       the audio file that the source reader is reading from
+        @param cacheFile        the file to use for storing the levels. If this is
+                                File::nonexistent, a file with the suffix ".levels" will be
+                                created next to the source file.
+    */
+    PeakCachingAudioReader (AudioFormatReader* sourceReader,
+                            const File& sourceFile,
+                            const File& cacheFile = File::nonexistent);
+
+    /** Destructor. */
+    ~PeakCachingAudioReader();
+
+    /** Returns true if the complete level pyramid has been built or loaded. */
+    bool hasCompleteLevels() const noexcept             { return pyramid.isFinished(); }
+
+    /** Finds the min, max and RMS levels of the first two channels in a range of samples.
+        This works like readMaxLevels(), but also returns the RMS of each channel.
+    */
+    void readLevels (int64 startSample, int64 numSamples,
+                     float& lowestLeft, float& highestLeft,
+                     float& lowestRight, float& highestRight,
+                     float& rmsLeft, float& rmsRight);
+
+    //==============================================================================
+    bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                      int64 startSampleInFile, int numSamples);
+
+    void readMaxLevels (int64 startSample, int64 numSamples,
+                        float& lowestLeft, float& highestLeft,
+                        float& lowestRight, float& highestRight);
+
+private:
+    ScopedPointer<AudioFormatReader> source;
+    const File sourceFile, cacheFile;
+    AudioLevelPyramid pyramid;
+    AudioSampleBuffer scratch;
+
+    void buildRemainingLevels();
+    void appendToPyramid (const int* const* data, int numSamples);
+    void finishPyramid();
+    void scanSection (int64 start, int numSamples, AudioLevelPyramid::Levels& left, AudioLevelPyramid::Levels& right);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PeakCachingAudioReader)
+};
+
+
+#endif   // __JUCE_PEAKCACHINGAUDIOFORMATREADER_JUCEHEADER__
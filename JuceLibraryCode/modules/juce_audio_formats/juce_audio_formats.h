@@ -110,6 +110,9 @@ namespace juce
 #ifndef __JUCE_MEMORYMAPPEDAUDIOFORMATREADER_JUCEHEADER__
  #include "format/juce_MemoryMappedAudioFormatReader.h"
 #endif
+#ifndef __JUCE_PEAKCACHINGAUDIOFORMATREADER_JUCEHEADER__
+ #include "format/juce_PeakCachingAudioFormatReader.h"
+#endif
 #include "codecs/juce_AiffAudioFormat.h"
 #include "codecs/juce_CoreAudioFormat.h"
 #include "codecs/juce_FlacAudioFormat.h"
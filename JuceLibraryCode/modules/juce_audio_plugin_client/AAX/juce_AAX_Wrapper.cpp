@@ -361,7 +361,7 @@ struct AAXClasses
                                 public AudioProcessorListener
     {
     public:
-        JuceAAX_Processor()  : sampleRate (0), lastBufferSize (1024)
+        JuceAAX_Processor()  : sampleRate (0), lastBufferSize (1024), firstProcessCallback (true)
         {
             pluginInstance = createPluginFilterOfType (AudioProcessor::wrapperType_AAX);
             pluginInstance->setPlayHead (this);
@@ -646,6 +646,13 @@ struct AAXClasses
         {
             AudioSampleBuffer buffer (channels, numChans, bufferSize);
 
+            if (firstProcessCallback)
+            {
+                // (this is the first chance to see the render thread, before it records any events)
+                firstProcessCallback = false;
+                JUCE_TRACE_REGISTER_THREAD();
+            }
+
             midiBuffer.clear();
 
            #if JucePlugin_WantsMidiInput
@@ -674,6 +681,11 @@ struct AAXClasses
                 }
 
                 const ScopedLock sl (pluginInstance->getCallbackLock());
+                JUCE_REALTIME_THREAD_SCOPE;
+                const AudioProcessorTimingStats::ScopedBlockTimer blockTimer (pluginInstance->getTimingStats(), bufferSize,
+                                                                              pluginInstance->getSampleRate());
+                const AudioProcessorTimingStats::ScopedDenormalGuard denormalGuard (pluginInstance->getTimingStats(), buffer);
+                JUCE_TRACE_SCOPE ("processBlock");
 
                 if (bypass)
                     pluginInstance->processBlockBypassed (buffer, midiBuffer);
@@ -756,6 +768,7 @@ struct AAXClasses
 
             audioProcessor.setPlayConfigDetails (numberOfInputChannels, numberOfOutputChannels, sampleRate, lastBufferSize);
             audioProcessor.prepareToPlay (sampleRate, lastBufferSize);
+            firstProcessCallback = true;
 
             check (Controller()->SetSignalLatency (audioProcessor.getLatencySamples()));
         }
@@ -768,6 +781,7 @@ struct AAXClasses
         int32_t juceChunkIndex;
         AAX_CSampleRate sampleRate;
         int lastBufferSize;
+        bool firstProcessCallback;
 
         // tempFilterData is initialized in GetChunkSize.
         // To avoid generating it again in GetChunk, we keep it as a member.
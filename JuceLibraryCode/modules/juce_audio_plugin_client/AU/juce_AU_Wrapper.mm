@@ -120,7 +120,8 @@ public:
         : AUMIDIEffectBase (component),
       #endif
           bufferSpace (2, 16),
-          prepared (false)
+          prepared (false),
+          firstProcessCallback (true)
     {
         if (activePlugins.size() + activeUIs.size() == 0)
         {
@@ -650,6 +651,7 @@ public:
                                  (int) GetMaxFramesPerSlice() + 32);
 
             juceFilter->prepareToPlay (GetSampleRate(), (int) GetMaxFramesPerSlice());
+            firstProcessCallback = true;
 
             midiEvents.ensureSize (2048);
             midiEvents.clear();
@@ -667,6 +669,13 @@ public:
                             const AudioTimeStamp& inTimeStamp,
                             UInt32 nFrames)
     {
+        if (firstProcessCallback)
+        {
+            // (this is the first chance to see the render thread, before it records any events)
+            firstProcessCallback = false;
+            JUCE_TRACE_REGISTER_THREAD();
+        }
+
         lastSMPTETime = inTimeStamp.mSMPTETime;
 
        #if ! JucePlugin_IsSynth
@@ -771,6 +780,7 @@ public:
                 AudioSampleBuffer buffer (channels, jmax (numIn, numOut), (int) numSamples);
 
                 const ScopedLock sl (juceFilter->getCallbackLock());
+                JUCE_REALTIME_THREAD_SCOPE;
 
                 if (juceFilter->isSuspended())
                 {
@@ -785,6 +795,10 @@ public:
                #endif
                 else
                 {
+                    const AudioProcessorTimingStats::ScopedBlockTimer blockTimer (juceFilter->getTimingStats(), (int) numSamples,
+                                                                                  juceFilter->getSampleRate());
+                    const AudioProcessorTimingStats::ScopedDenormalGuard denormalGuard (juceFilter->getTimingStats(), buffer);
+                    JUCE_TRACE_SCOPE ("processBlock");
                     juceFilter->processBlock (buffer, midiEvents);
                 }
             }
@@ -1165,7 +1179,7 @@ private:
     AudioSampleBuffer bufferSpace;
     HeapBlock <float*> channels;
     MidiBuffer midiEvents, incomingEvents;
-    bool prepared;
+    bool prepared, firstProcessCallback;
     SMPTETime lastSMPTETime;
     AUChannelInfo channelInfo [numChannelConfigs];
     AudioUnitEvent auEvent;
@@ -151,6 +151,7 @@ public:
     //==============================================================================
     JucePlugInProcess()
         : prepared (false),
+          firstProcessCallback (true),
           sampleRate (44100.0)
     {
         asyncUpdater = new InternalAsyncUpdater (*this);
@@ -514,6 +515,7 @@ protected:
 
             juceFilter->prepareToPlay (sampleRate, mRTGlobals->mHWBufferSizeInSamples);
 
+            firstProcessCallback = true;
             prepared = true;
         }
     }
@@ -527,6 +529,13 @@ protected:
             return;
         }
 
+        if (firstProcessCallback)
+        {
+            // (this is the first chance to see the render thread, before it records any events)
+            firstProcessCallback = false;
+            JUCE_TRACE_REGISTER_THREAD();
+        }
+
        #if JucePlugin_WantsMidiInput
         midiEvents.clear();
 
@@ -562,6 +571,7 @@ protected:
 
         {
             const ScopedLock sl (juceFilter->getCallbackLock());
+            JUCE_REALTIME_THREAD_SCOPE;
 
             const int numIn = juceFilter->getNumInputChannels();
             const int numOut = juceFilter->getNumOutputChannels();
@@ -589,6 +599,10 @@ protected:
                 }
 
                 AudioSampleBuffer chans (channels, totalChans, numSamples);
+                const AudioProcessorTimingStats::ScopedBlockTimer blockTimer (juceFilter->getTimingStats(), (int) numSamples,
+                                                                              juceFilter->getSampleRate());
+                const AudioProcessorTimingStats::ScopedDenormalGuard denormalGuard (juceFilter->getTimingStats(), chans);
+                JUCE_TRACE_SCOPE ("processBlock");
 
                 if (mBypassed)
                     juceFilter->processBlockBypassed (chans, midiEvents);
@@ -802,7 +816,7 @@ private:
 
     juce::MemoryBlock tempFilterData;
     HeapBlock <float*> channels;
-    bool prepared;
+    bool prepared, firstProcessCallback;
     double sampleRate;
 
     static float longToFloat (const long n) noexcept
@@ -563,6 +563,9 @@ public:
             if (! isProcessing)
                 resume();
 
+            // (this is usually the first chance to see the audio thread, before it records any events)
+            JUCE_TRACE_REGISTER_THREAD();
+
             filter->setNonRealtime (getCurrentProcessLevel() == 4 /* kVstProcessLevelOffline */);
 
            #if JUCE_WINDOWS
@@ -580,6 +583,7 @@ public:
 
         {
             const ScopedLock sl (filter->getCallbackLock());
+            JUCE_REALTIME_THREAD_SCOPE;
 
             const int numIn = numInChans;
             const int numOut = numOutChans;
@@ -625,6 +629,10 @@ public:
 
                 {
                     AudioSampleBuffer chans (channels, jmax (numIn, numOut), numSamples);
+                    const AudioProcessorTimingStats::ScopedBlockTimer blockTimer (filter->getTimingStats(), numSamples,
+                                                                                  filter->getSampleRate());
+                    const AudioProcessorTimingStats::ScopedDenormalGuard denormalGuard (filter->getTimingStats(), chans);
+                    JUCE_TRACE_SCOPE ("processBlock");
 
                     if (isBypassed)
                         filter->processBlockBypassed (chans, midiEvents);
@@ -83,6 +83,9 @@ namespace juce
 #ifndef __JUCE_AUDIOPROCESSORLISTENER_JUCEHEADER__
  #include "processors/juce_AudioProcessorListener.h"
 #endif
+#ifndef __JUCE_AUDIOPROCESSORTIMINGSTATS_JUCEHEADER__
+ #include "processors/juce_AudioProcessorTimingStats.h"
+#endif
 #ifndef __JUCE_GENERICAUDIOPROCESSOREDITOR_JUCEHEADER__
  #include "processors/juce_GenericAudioProcessorEditor.h"
 #endif
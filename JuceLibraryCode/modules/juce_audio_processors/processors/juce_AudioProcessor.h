@@ -28,6 +28,7 @@
 #include "juce_AudioProcessorEditor.h"
 #include "juce_AudioProcessorListener.h"
 #include "juce_AudioPlayHead.h"
+#include "juce_AudioProcessorTimingStats.h"
 
 
 //==============================================================================
@@ -335,6 +336,16 @@ public:
     */
     void setNonRealtime (bool isNonRealtime) noexcept;
 
+    //==============================================================================
+    /** Returns the statistics that record how long each processBlock() call takes.
+
+        The plugin wrappers and the AudioProcessorGraph time every block they process,
+        but only once the statistics have been enabled with
+        AudioProcessorTimingStats::setEnabled(). They also process each block in
+        flush-to-zero mode, using an AudioProcessorTimingStats::ScopedDenormalGuard.
+    */
+    AudioProcessorTimingStats& getTimingStats() noexcept                { return timingStats; }
+
     //==============================================================================
     /** Creates the filter's UI.
 
@@ -630,6 +641,7 @@ private:
     bool suspended, nonRealtime;
     CriticalSection callbackLock, listenerLock;
     String inputSpeakerArrangement, outputSpeakerArrangement;
+    AudioProcessorTimingStats timingStats;
 
    #if JUCE_DEBUG
     BigInteger changingParams;
@@ -222,6 +222,10 @@ public:
             channels[i] = sharedBufferChans.getSampleData (audioChannelsToUse.getUnchecked (i), 0);
 
         AudioSampleBuffer buffer (channels, totalChans, numSamples);
+        const AudioProcessorTimingStats::ScopedBlockTimer blockTimer (processor->getTimingStats(), numSamples,
+                                                                      processor->getSampleRate());
+        const AudioProcessorTimingStats::ScopedDenormalGuard denormalGuard (processor->getTimingStats(), buffer);
+        JUCE_TRACE_SCOPE ("AudioProcessorGraph node");
 
         processor->processBlock (buffer, *sharedMidiBuffers.getUnchecked (midiBufferToUse));
     }
@@ -1302,6 +1306,8 @@ void AudioProcessorGraph::reset()
 
 void AudioProcessorGraph::processBlock (AudioSampleBuffer& buffer, MidiBuffer& midiMessages)
 {
+    JUCE_TRACE_SCOPE ("AudioProcessorGraph::processBlock");
+    JUCE_REALTIME_THREAD_SCOPE;
     const int numSamples = buffer.getNumSamples();
 
     currentAudioInputBuffer = &buffer;
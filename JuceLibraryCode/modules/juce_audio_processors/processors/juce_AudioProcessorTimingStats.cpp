@@ -0,0 +1,203 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+AudioProcessorTimingStats::AudioProcessorTimingStats() noexcept
+    : deadlineFraction (1.0)
+{
+}
+
+AudioProcessorTimingStats::~AudioProcessorTimingStats()
+{
+}
+
+void AudioProcessorTimingStats::setEnabled (const bool shouldBeEnabled) noexcept
+{
+    enabled = shouldBeEnabled ? 1 : 0;
+}
+
+void AudioProcessorTimingStats::setDeadlineFraction (const double fractionOfBlockDuration) noexcept
+{
+    jassert (fractionOfBlockDuration > 0);
+    deadlineFraction = fractionOfBlockDuration;
+}
+
+void AudioProcessorTimingStats::reset() noexcept
+{
+    numBlocks = 0;
+    numDeadlineMisses = 0;
+    numBlocksWithDenormals = 0;
+    numDenormalSamples = 0;
+    maxNanosPerSample = 0;
+
+    for (int i = 0; i < numBuckets; ++i)
+        buckets[i] = 0;
+}
+
+//==============================================================================
+int AudioProcessorTimingStats::getBucketIndex (const double nanosPerSample) noexcept
+{
+    // bucket 0 holds everything under 1ns, and bucket i covers [2^((i-1)/4), 2^(i/4))
+    if (nanosPerSample < 1.0)
+        return 0;
+
+    return jmin ((int) numBuckets - 1,
+                 1 + (int) (std::log (nanosPerSample) * (bucketsPerOctave / std::log (2.0))));
+}
+
+void AudioProcessorTimingStats::addBlock (const double elapsedSeconds, const int numSamples,
+                                          const double sampleRate) noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    const double nanosPerSample = elapsedSeconds * 1.0e9 / numSamples;
+
+    ++buckets [getBucketIndex (nanosPerSample)];
+    ++numBlocks;
+
+    if (sampleRate > 0 && elapsedSeconds > deadlineFraction * numSamples / sampleRate)
+        ++numDeadlineMisses;
+
+    const int rounded = (int) jmin (nanosPerSample + 0.5, (double) std::numeric_limits<int>::max());
+
+    for (;;)
+    {
+        const int oldMax = maxNanosPerSample.get();
+
+        if (rounded <= oldMax || maxNanosPerSample.compareAndSetBool (rounded, oldMax))
+            break;
+    }
+}
+
+//==============================================================================
+AudioProcessorTimingStats::ScopedBlockTimer::ScopedBlockTimer (AudioProcessorTimingStats& stats_,
+                                                               const int numSamples_,
+                                                               const double sampleRate_) noexcept
+    : stats (stats_), numSamples (numSamples_), sampleRate (sampleRate_),
+      startTicks (stats_.isEnabled() ? Time::getHighResolutionTicks() : 0)
+{
+}
+
+AudioProcessorTimingStats::ScopedBlockTimer::~ScopedBlockTimer() noexcept
+{
+    if (startTicks != 0)
+        stats.addBlock (Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks),
+                        numSamples, sampleRate);
+}
+
+//==============================================================================
+void AudioProcessorTimingStats::setDenormalDetectionEnabled (const bool shouldBeEnabled) noexcept
+{
+    detectDenormals = shouldBeEnabled ? 1 : 0;
+}
+
+void AudioProcessorTimingStats::addDenormals (const bool usedDenormalOperands, const int numSamples) noexcept
+{
+    if (usedDenormalOperands)
+        ++numBlocksWithDenormals;
+
+    if (numSamples > 0)
+        numDenormalSamples += numSamples;
+}
+
+AudioProcessorTimingStats::ScopedDenormalGuard::ScopedDenormalGuard (AudioProcessorTimingStats& stats_,
+                                                                     const AudioSampleBuffer& buffer_) noexcept
+    : stats (stats_), buffer (buffer_),
+      previousState (FloatVectorOperations::getFpStatusRegister()),
+      detecting (stats_.isDenormalDetectionEnabled())
+{
+    if (detecting)
+    {
+        FloatVectorOperations::enableFlushToZeroMode (false);
+        FloatVectorOperations::getAndClearDenormalOperandFlag();
+    }
+    else
+    {
+        FloatVectorOperations::enableFlushToZeroMode (true);
+    }
+}
+
+AudioProcessorTimingStats::ScopedDenormalGuard::~ScopedDenormalGuard() noexcept
+{
+    if (detecting)
+    {
+        const bool usedDenormals = FloatVectorOperations::getAndClearDenormalOperandFlag();
+        int numDenormals = 0;
+
+        for (int i = buffer.getNumChannels(); --i >= 0;)
+            numDenormals += FloatVectorOperations::countDenormals (buffer.getSampleData (i), buffer.getNumSamples());
+
+        stats.addDenormals (usedDenormals, numDenormals);
+    }
+
+    FloatVectorOperations::setFpStatusRegister (previousState);
+}
+
+//==============================================================================
+AudioProcessorTimingStats::Snapshot::Snapshot() noexcept
+    : numBlocks (0), numDeadlineMisses (0), maxNanosPerSample (0),
+      numBlocksWithDenormals (0), numDenormalSamples (0)
+{
+    zeromem (bucketCounts, sizeof (bucketCounts));
+}
+
+double AudioProcessorTimingStats::Snapshot::getPercentile (const double percent) const noexcept
+{
+    int64 total = 0;
+
+    for (int i = 0; i < numBuckets; ++i)
+        total += bucketCounts[i];
+
+    if (total == 0)
+        return 0;
+
+    const int64 target = jmax ((int64) 1, (int64) std::ceil (total * jlimit (0.0, 100.0, percent) / 100.0));
+    int64 count = 0;
+
+    for (int i = 0; i < numBuckets; ++i)
+    {
+        count += bucketCounts[i];
+
+        if (count >= target)
+            return jmin (maxNanosPerSample, std::pow (2.0, i / (double) bucketsPerOctave));
+    }
+
+    return maxNanosPerSample;
+}
+
+AudioProcessorTimingStats::Snapshot AudioProcessorTimingStats::getSnapshot() const noexcept
+{
+    Snapshot s;
+    s.numBlocks = numBlocks.get();
+    s.numDeadlineMisses = numDeadlineMisses.get();
+    s.maxNanosPerSample = maxNanosPerSample.get();
+    s.numBlocksWithDenormals = numBlocksWithDenormals.get();
+    s.numDenormalSamples = numDenormalSamples.get();
+
+    for (int i = 0; i < numBuckets; ++i)
+        s.bucketCounts[i] = buckets[i].get();
+
+    return s;
+}
@@ -0,0 +1,202 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+#ifndef __JUCE_AUDIOPROCESSORTIMINGSTATS_JUCEHEADER__
+#define __JUCE_AUDIOPROCESSORTIMINGSTATS_JUCEHEADER__
+
+
+//==============================================================================
+/**
+    Collects statistics about how long an AudioProcessor's processBlock() calls take.
+
+    Each AudioProcessor owns one of these, and the plugin wrappers and the
+    AudioProcessorGraph time every processBlock() call with a ScopedBlockTimer.
+    When it's enabled, the time is measured with the high-resolution clock and
+    added to a histogram of the processing time per sample, with logarithmic buckets
+    that are a quarter of an octave wide. Blocks that take longer than a given
+    fraction of their real-time deadline are also counted.
+
+    Everything is updated with atomic increments, so the audio thread never blocks,
+    and any other thread can call getSnapshot() at any time to find the median,
+    99th percentile and worst-case times. Unlike a smoothed CPU meter, this shows
+    the occasional spikes that actually cause dropouts.
+
+    When it's disabled (the default), timing a block costs a single flag check.
+
+    The same object also counts denormals when denormal detection is turned on; see
+    ScopedDenormalGuard.
+
+    @see AudioProcessor::getTimingStats
+*/
+class JUCE_API  AudioProcessorTimingStats
+{
+public:
+    //==============================================================================
+    /** Creates a disabled set of statistics. */
+    AudioProcessorTimingStats() noexcept;
+
+    /** Destructor. */
+    ~AudioProcessorTimingStats();
+
+    //==============================================================================
+    /** Turns the timing on or off. This can be called from any thread. */
+    void setEnabled (bool shouldBeEnabled) noexcept;
+
+    /** Returns true if the timing is turned on. */
+    bool isEnabled() const noexcept                     { return enabled.get() != 0; }
+
+    /** Sets the fraction of a block's duration beyond which it counts as a deadline miss.
+        For example, 0.5 would count any block that used more than half of the time
+        available to it. The default is 1.0.
+    */
+    void setDeadlineFraction (double fractionOfBlockDuration) noexcept;
+
+    /** Returns the fraction set with setDeadlineFraction(). */
+    double getDeadlineFraction() const noexcept         { return deadlineFraction; }
+
+    /** Clears all the collected statistics.
+        If a block is being added at the same moment, its result may be partly lost.
+    */
+    void reset() noexcept;
+
+    //==============================================================================
+    /** Records the time that a block took to process.
+        This is normally called by a ScopedBlockTimer rather than directly.
+    */
+    void addBlock (double elapsedSeconds, int numSamples, double sampleRate) noexcept;
+
+    //==============================================================================
+    /** Times the lifetime of this object, and adds it to a set of statistics as one block. */
+    class JUCE_API  ScopedBlockTimer
+    {
+    public:
+        ScopedBlockTimer (AudioProcessorTimingStats& stats, int numSamples, double sampleRate) noexcept;
+        ~ScopedBlockTimer() noexcept;
+
+    private:
+        AudioProcessorTimingStats& stats;
+        const int numSamples;
+        const double sampleRate;
+        const int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedBlockTimer)
+    };
+
+    //==============================================================================
+    /** Turns denormal detection on or off. This can be called from any thread.
+        @see ScopedDenormalGuard
+    */
+    void setDenormalDetectionEnabled (bool shouldBeEnabled) noexcept;
+
+    /** Returns true if denormal detection is turned on. */
+    bool isDenormalDetectionEnabled() const noexcept    { return detectDenormals.get() != 0; }
+
+    /** Records the denormals that were found in a block.
+        This is normally called by a ScopedDenormalGuard rather than directly.
+    */
+    void addDenormals (bool usedDenormalOperands, int numDenormalSamples) noexcept;
+
+    //==============================================================================
+    /** Puts the calling thread into flush-to-zero mode while a block is processed, and
+        restores the previous floating-point mode afterwards.
+
+        The plugin wrappers and the AudioProcessorGraph put one of these around every
+        processBlock() call, so that decaying signals can't fall into denormals, which
+        are very slow on x86.
+
+        If denormal detection has been turned on, it leaves denormals enabled instead, so
+        that their effect can be seen. Then, when the block finishes, it checks the CPU's
+        denormal-operand flag and counts any denormal samples left in the buffer.
+    */
+    class JUCE_API  ScopedDenormalGuard
+    {
+    public:
+        ScopedDenormalGuard (AudioProcessorTimingStats& stats, const AudioSampleBuffer& buffer) noexcept;
+        ~ScopedDenormalGuard() noexcept;
+
+    private:
+        AudioProcessorTimingStats& stats;
+        const AudioSampleBuffer& buffer;
+        const pointer_sized_int previousState;
+        const bool detecting;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedDenormalGuard)
+    };
+
+    //==============================================================================
+    enum
+    {
+        bucketsPerOctave = 4,
+        numBuckets = 100    /**< The top bucket covers everything above ~32ms per sample. */
+    };
+
+    /** A copy of the statistics at a moment in time. */
+    struct JUCE_API  Snapshot
+    {
+        Snapshot() noexcept;
+
+        /** Returns the processing time per sample, in nanoseconds, below which the given
+            percentage of blocks fell. Because of the bucketing, this is an upper bound
+            that's at most about 19% too high.
+        */
+        double getPercentile (double percent) const noexcept;
+
+        /** Returns the median processing time per sample, in nanoseconds. */
+        double getMedianNanosPerSample() const noexcept     { return getPercentile (50.0); }
+
+        /** Returns the 99th percentile processing time per sample, in nanoseconds. */
+        double get99thPercentileNanosPerSample() const noexcept { return getPercentile (99.0); }
+
+        int64 numBlocks;
+        int64 numDeadlineMisses;
+        double maxNanosPerSample;
+
+        /** The number of blocks that used a denormal operand, while detection was on. */
+        int64 numBlocksWithDenormals;
+
+        /** The total number of denormal samples left in the output, while detection was on. */
+        int64 numDenormalSamples;
+
+        int bucketCounts [numBuckets];
+    };
+
+    /** Returns a copy of the current statistics. This can be called from any thread. */
+    Snapshot getSnapshot() const noexcept;
+
+private:
+    //==============================================================================
+    Atomic<int> enabled, detectDenormals;
+    double deadlineFraction;
+    Atomic<int64> numBlocks, numDeadlineMisses, numBlocksWithDenormals, numDenormalSamples;
+    Atomic<int> maxNanosPerSample;
+    Atomic<int> buckets [numBuckets];
+
+    static int getBucketIndex (double nanosPerSample) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE (AudioProcessorTimingStats)
+};
+
+
+#endif   // __JUCE_AUDIOPROCESSORTIMINGSTATS_JUCEHEADER__
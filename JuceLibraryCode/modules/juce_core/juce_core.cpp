@@ -123,6 +123,7 @@ namespace juce
 #include "json/juce_JSON.cpp"
 #include "logging/juce_FileLogger.cpp"
 #include "logging/juce_Logger.cpp"
+#include "logging/juce_TraceRecorder.cpp"
 #include "maths/juce_BigInteger.cpp"
 #include "maths/juce_Expression.cpp"
 #include "maths/juce_Random.cpp"
@@ -151,7 +152,10 @@ namespace juce
 #include "text/juce_StringPool.cpp"
 #include "text/juce_TextDiff.cpp"
 #include "threads/juce_ChildProcess.cpp"
+#include "threads/juce_ReadCopyUpdatePointer.cpp"
 #include "threads/juce_ReadWriteLock.cpp"
+#include "threads/juce_RealtimeSafetyChecker.cpp"
+#include "threads/juce_RealtimeWorkerGroup.cpp"
 #include "threads/juce_Thread.cpp"
 #include "threads/juce_ThreadPool.cpp"
 #include "threads/juce_TimeSliceThread.cpp"
@@ -216,3 +220,8 @@ namespace juce
 #include "threads/juce_HighResolutionTimer.cpp"
 
 }
+
+//==============================================================================
+#if JUCE_ENABLE_REALTIME_SAFETY_CHECKS
+#include "native/juce_RealtimeSafetyHooks.h"
+#endif
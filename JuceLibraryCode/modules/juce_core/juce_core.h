@@ -117,6 +117,28 @@
  #define JUCE_ZLIB_INCLUDE_PATH <zlib.h>
 #endif
 
+/** Config: JUCE_ENABLE_TRACING
+    Turns on the JUCE_TRACE_SCOPE, JUCE_TRACE_BEGIN, JUCE_TRACE_END, JUCE_TRACE_COUNTER and
+    JUCE_TRACE_REGISTER_THREAD macros, so that TraceRecorder can log the timing of the audio
+    and I/O threads. When this is disabled, the macros compile to nothing.
+
+    @see TraceRecorder
+*/
+#ifndef JUCE_ENABLE_TRACING
+ #define JUCE_ENABLE_TRACING 0
+#endif
+
+/** Config: JUCE_ENABLE_REALTIME_SAFETY_CHECKS
+    Lets RealtimeSafetyChecker catch memory allocations and locks on the threads marked with
+    JUCE_REALTIME_THREAD_SCOPE. This replaces the global operator new and delete (and on Linux,
+    malloc and free), so it's meant for test builds rather than release ones.
+
+    @see RealtimeSafetyChecker
+*/
+#ifndef JUCE_ENABLE_REALTIME_SAFETY_CHECKS
+ #define JUCE_ENABLE_REALTIME_SAFETY_CHECKS 0
+#endif
+
 /*  Config: JUCE_CATCH_UNHANDLED_EXCEPTIONS
     If enabled, this will add some exception-catching code to forward unhandled exceptions
     to your JUCEApplication::unhandledException() callback.
@@ -218,6 +240,9 @@ namespace juce
 #ifndef __JUCE_LOGGER_JUCEHEADER__
  #include "logging/juce_Logger.h"
 #endif
+#ifndef __JUCE_TRACERECORDER_JUCEHEADER__
+ #include "logging/juce_TraceRecorder.h"
+#endif
 #ifndef __JUCE_BIGINTEGER_JUCEHEADER__
  #include "maths/juce_BigInteger.h"
 #endif
@@ -383,9 +408,18 @@ namespace juce
 #ifndef __JUCE_PROCESS_JUCEHEADER__
  #include "threads/juce_Process.h"
 #endif
+#ifndef __JUCE_READCOPYUPDATEPOINTER_JUCEHEADER__
+ #include "threads/juce_ReadCopyUpdatePointer.h"
+#endif
 #ifndef __JUCE_READWRITELOCK_JUCEHEADER__
  #include "threads/juce_ReadWriteLock.h"
 #endif
+#ifndef __JUCE_REALTIMESAFETYCHECKER_JUCEHEADER__
+ #include "threads/juce_RealtimeSafetyChecker.h"
+#endif
+#ifndef __JUCE_REALTIMEWORKERGROUP_JUCEHEADER__
+ #include "threads/juce_RealtimeWorkerGroup.h"
+#endif
 #ifndef __JUCE_SCOPEDLOCK_JUCEHEADER__
  #include "threads/juce_ScopedLock.h"
 #endif
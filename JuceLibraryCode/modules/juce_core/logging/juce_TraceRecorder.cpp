@@ -0,0 +1,284 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+namespace TraceHelpers
+{
+    struct Event
+    {
+        const char* name;
+        int64 ticks;
+        int64 value;
+        char phase;
+    };
+
+    //==============================================================================
+    // A ring of events that's written by one thread and drained by the flusher.
+    class ThreadRing
+    {
+    public:
+        ThreadRing (const int threadIndex_, const String& threadName_)
+            : threadIndex (threadIndex_), threadName (threadName_),
+              isNameWritten (false), events ((size_t) ringSize)
+        {
+        }
+
+        void push (const char* name, const char phase, const int64 value) noexcept
+        {
+            const int w = writePos.value;
+
+            if (w - readPos.get() >= ringSize)
+            {
+                ++numDropped;
+                return;
+            }
+
+            Event& e = events [w & (ringSize - 1)];
+            e.name = name;
+            e.ticks = Time::getHighResolutionTicks();
+            e.value = value;
+            e.phase = phase;
+
+            writePos = w + 1;
+        }
+
+        // Called by the flusher to take the events that have been written so far.
+        template <class Callback>
+        void drain (Callback& callback)
+        {
+            const int r = readPos.value;
+            const int w = writePos.get();
+
+            for (int i = r; i != w; ++i)
+                callback.writeEvent (*this, events [i & (ringSize - 1)]);
+
+            readPos = w;
+        }
+
+        void discardAll() noexcept          { readPos = writePos.get(); }
+
+        enum { ringSize = 16384 };
+
+        const int threadIndex;
+        const String threadName;
+        bool isNameWritten;     // (only used with the recorder's fileLock held)
+        Atomic<int> numDropped;
+
+    private:
+        HeapBlock<Event> events;
+        Atomic<int> writePos, readPos;
+
+        JUCE_DECLARE_NON_COPYABLE (ThreadRing)
+    };
+
+    //==============================================================================
+    class Recorder  : private Thread
+    {
+    public:
+        Recorder() : Thread ("Trace Recorder"), startTicks (0), numEventsWritten (0)
+        {
+        }
+
+        ~Recorder()
+        {
+            stop();
+        }
+
+        bool start (const File& file)
+        {
+            stop();
+
+            const ScopedLock sl (fileLock);
+
+            file.deleteFile();
+            output = file.createOutputStream();
+
+            if (output == nullptr)
+                return false;
+
+            *output << "[";
+            numEventsWritten = 0;
+            startTicks = Time::getHighResolutionTicks();
+
+            {
+                const ScopedLock rl (ringListLock);
+
+                for (int i = 0; i < rings.size(); ++i)
+                {
+                    rings.getUnchecked (i)->discardAll();
+                    rings.getUnchecked (i)->isNameWritten = false;
+                }
+            }
+
+            recording = 1;
+            startThread (3);
+            return true;
+        }
+
+        void stop()
+        {
+            if (recording.compareAndSetBool (0, 1))
+            {
+                stopThread (5000);
+                flush();
+
+                const ScopedLock sl (fileLock);
+                *output << "\n]\n";
+                output = nullptr;
+            }
+        }
+
+        ThreadRing* getRingForCurrentThread()
+        {
+            ThreadRing*& ring = currentThreadRing.get();
+
+            if (ring == nullptr)
+            {
+                // (the thread's name gets written by the flusher, so this never waits for the file)
+                const ScopedLock sl (ringListLock);
+
+                Thread* const thread = Thread::getCurrentThread();
+                const int index = rings.size() + 1;
+
+                ring = rings.add (new ThreadRing (index, thread != nullptr ? thread->getThreadName()
+                                                                           : "Thread " + String (index)));
+            }
+
+            return ring;
+        }
+
+        void writeEvent (const ThreadRing& ring, const Event& e)
+        {
+            // (called with the fileLock held)
+            *output << (numEventsWritten++ > 0 ? ",\n" : "\n")
+                    << "{\"name\":" << JSON::toString (String (e.name))
+                    << ",\"ph\":\"" << e.phase
+                    << "\",\"ts\":" << String (Time::highResolutionTicksToSeconds (e.ticks - startTicks) * 1.0e6, 3)
+                    << ",\"pid\":1,\"tid\":" << ring.threadIndex;
+
+            if (e.phase == 'C')
+                *output << ",\"args\":{\"value\":" << e.value << "}";
+
+            *output << "}";
+        }
+
+        int getNumDroppedEvents()
+        {
+            const ScopedLock sl (ringListLock);
+            int total = 0;
+
+            for (int i = 0; i < rings.size(); ++i)
+                total += rings.getUnchecked (i)->numDropped.get();
+
+            return total;
+        }
+
+        Atomic<int> recording;
+
+    private:
+        CriticalSection ringListLock, fileLock;
+        OwnedArray<ThreadRing> rings;
+        ThreadLocalValue<ThreadRing*> currentThreadRing;
+        ScopedPointer<FileOutputStream> output;
+        int64 startTicks;
+        int numEventsWritten;
+
+        void run()
+        {
+            while (! threadShouldExit())
+            {
+                wait (100);
+                flush();
+            }
+        }
+
+        void flush()
+        {
+            const ScopedLock sl (fileLock);
+
+            if (output == nullptr)
+                return;
+
+            Array<ThreadRing*> ringsToDrain;
+
+            {
+                const ScopedLock rl (ringListLock);
+
+                for (int i = 0; i < rings.size(); ++i)
+                    ringsToDrain.add (rings.getUnchecked (i));
+            }
+
+            // rings are never deleted while recording, so these stay valid after the lock is released
+            for (int i = 0; i < ringsToDrain.size(); ++i)
+            {
+                ThreadRing& ring = *ringsToDrain.getUnchecked (i);
+
+                if (! ring.isNameWritten)
+                {
+                    writeThreadName (ring);
+                    ring.isNameWritten = true;
+                }
+
+                ring.drain (*this);
+            }
+
+            output->flush();
+        }
+
+        void writeThreadName (const ThreadRing& ring)
+        {
+            // (called with the fileLock held)
+            *output << (numEventsWritten++ > 0 ? ",\n" : "\n")
+                    << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring.threadIndex
+                    << ",\"args\":{\"name\":" << JSON::toString (ring.threadName) << "}}";
+        }
+
+        JUCE_DECLARE_NON_COPYABLE (Recorder)
+    };
+
+    static Recorder& getRecorder()
+    {
+        static Recorder recorder;
+        return recorder;
+    }
+
+    static inline void addEvent (const char* name, const char phase, const int64 value) noexcept
+    {
+        Recorder& r = getRecorder();
+
+        if (r.recording.value != 0)
+            r.getRingForCurrentThread()->push (name, phase, value);
+    }
+}
+
+//==============================================================================
+bool TraceRecorder::start (const File& outputFile)      { return TraceHelpers::getRecorder().start (outputFile); }
+void TraceRecorder::stop()                              { TraceHelpers::getRecorder().stop(); }
+bool TraceRecorder::isRecording() noexcept              { return TraceHelpers::getRecorder().recording.get() != 0; }
+int TraceRecorder::getNumDroppedEvents() noexcept       { return TraceHelpers::getRecorder().getNumDroppedEvents(); }
+void TraceRecorder::registerCurrentThread()             { TraceHelpers::getRecorder().getRingForCurrentThread(); }
+
+void TraceRecorder::beginEvent (const char* name) noexcept                  { TraceHelpers::addEvent (name, 'B', 0); }
+void TraceRecorder::endEvent (const char* name) noexcept                    { TraceHelpers::addEvent (name, 'E', 0); }
+void TraceRecorder::counterEvent (const char* name, const int64 value) noexcept { TraceHelpers::addEvent (name, 'C', value); }
@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+#ifndef __JUCE_TRACERECORDER_JUCEHEADER__
+#define __JUCE_TRACERECORDER_JUCEHEADER__
+
+class File;
+
+
+//==============================================================================
+/**
+    Records timed events from any thread, and streams them to a file in the Chrome
+    trace event format, so they can be viewed in chrome://tracing.
+
+    Each thread that records an event gets its own fixed-size ring of events, which
+    only that thread writes to, so recording an event takes no locks and just copies
+    a name pointer and a high-resolution timestamp. A background thread drains the
+    rings a few times a second and writes the JSON. If a ring fills up before it's
+    drained, new events on that thread are dropped and counted.
+
+    Events are normally added with the JUCE_TRACE_SCOPE, JUCE_TRACE_BEGIN/END and
+    JUCE_TRACE_COUNTER macros. These compile to nothing unless the JUCE_ENABLE_TRACING
+    flag is set, and when it is set but no recording is running, each one costs a
+    single flag check.
+
+    The names must be string literals (or other strings that are never freed),
+    because only their pointers are stored.
+
+    e.g. @code
+    void processBlock (AudioSampleBuffer& buffer, MidiBuffer&)
+    {
+        JUCE_TRACE_SCOPE ("MyProcessor::processBlock");
+        ...
+    }
+
+    TraceRecorder::start (File ("~/render.json"));
+    @endcode
+
+    The first event recorded by each thread allocates its ring. A real-time thread
+    can call registerCurrentThread() beforehand to avoid this happening in a callback,
+    and the plugin wrappers do this with JUCE_TRACE_REGISTER_THREAD when they prepare
+    their processors.
+*/
+class JUCE_API  TraceRecorder
+{
+public:
+    //==============================================================================
+    /** Starts recording, and begins writing events to the given file.
+        If a recording was already running, it's stopped first.
+        Returns false if the file couldn't be opened.
+    */
+    static bool start (const File& outputFile);
+
+    /** Stops recording, writes any remaining events and closes the file. */
+    static void stop();
+
+    /** Returns true if a recording is running. */
+    static bool isRecording() noexcept;
+
+    /** Returns the number of events that had to be dropped because a thread's ring was full. */
+    static int getNumDroppedEvents() noexcept;
+
+    /** Allocates the calling thread's event ring, if it hasn't already got one.
+        This allocates and takes a short lock, but never waits for the file to be written.
+    */
+    static void registerCurrentThread();
+
+    //==============================================================================
+    /** Marks the start of a timed section on the calling thread. */
+    static void beginEvent (const char* name) noexcept;
+
+    /** Marks the end of a section that was started with beginEvent(). */
+    static void endEvent (const char* name) noexcept;
+
+    /** Records the current value of a counter, which is drawn as a graph over time. */
+    static void counterEvent (const char* name, int64 value) noexcept;
+
+private:
+    TraceRecorder();
+    JUCE_DECLARE_NON_COPYABLE (TraceRecorder)
+};
+
+//==============================================================================
+/** Records a begin event when created and an end event when deleted.
+    @see TraceRecorder, JUCE_TRACE_SCOPE
+*/
+class JUCE_API  ScopedTraceEvent
+{
+public:
+    inline explicit ScopedTraceEvent (const char* name_) noexcept : name (name_)    { TraceRecorder::beginEvent (name); }
+    inline ~ScopedTraceEvent() noexcept                                             { TraceRecorder::endEvent (name); }
+
+private:
+    const char* const name;
+
+    JUCE_DECLARE_NON_COPYABLE (ScopedTraceEvent)
+};
+
+//==============================================================================
+#if JUCE_ENABLE_TRACING || DOXYGEN
+ /** Times the rest of the enclosing scope as a trace event.
+     @see TraceRecorder
+ */
+ #define JUCE_TRACE_SCOPE(name)             const juce::ScopedTraceEvent JUCE_JOIN_MACRO (traceEvent_, __LINE__) (name)
+
+ /** Marks the start of a trace event. @see TraceRecorder */
+ #define JUCE_TRACE_BEGIN(name)             juce::TraceRecorder::beginEvent (name)
+
+ /** Marks the end of a trace event. @see TraceRecorder */
+ #define JUCE_TRACE_END(name)               juce::TraceRecorder::endEvent (name)
+
+ /** Records the value of a trace counter. @see TraceRecorder */
+ #define JUCE_TRACE_COUNTER(name, value)    juce::TraceRecorder::counterEvent (name, (juce::int64) (value))
+
+ /** Allocates the calling thread's event ring ahead of its first event. @see TraceRecorder::registerCurrentThread */
+ #define JUCE_TRACE_REGISTER_THREAD()       juce::TraceRecorder::registerCurrentThread()
+#else
+ #define JUCE_TRACE_SCOPE(name)
+ #define JUCE_TRACE_BEGIN(name)
+ #define JUCE_TRACE_END(name)
+ #define JUCE_TRACE_COUNTER(name, value)
+ #define JUCE_TRACE_REGISTER_THREAD()
+#endif
+
+
+#endif   // __JUCE_TRACERECORDER_JUCEHEADER__
@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+/*
+    Replacements for the global allocation functions, which report their use on
+    real-time threads to the RealtimeSafetyChecker. This is included by juce_core.cpp,
+    outside the juce namespace, when JUCE_ENABLE_REALTIME_SAFETY_CHECKS is set.
+*/
+
+#if JUCE_COMPILER_SUPPORTS_NOEXCEPT
+ #define JUCE_THROWS_BAD_ALLOC
+#else
+ #define JUCE_THROWS_BAD_ALLOC  throw (std::bad_alloc)
+#endif
+
+#if JUCE_LINUX
+extern "C"
+{
+    // glibc's own implementations, which the replacements below forward to.
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+    void  __libc_free (void*);
+
+    void* malloc (size_t size) noexcept
+    {
+        juce::RealtimeSafetyChecker::checkCall (juce::RealtimeSafetyChecker::memoryAllocation);
+        return __libc_malloc (size);
+    }
+
+    void* calloc (size_t numElements, size_t elementSize) noexcept
+    {
+        juce::RealtimeSafetyChecker::checkCall (juce::RealtimeSafetyChecker::memoryAllocation);
+        return __libc_calloc (numElements, elementSize);
+    }
+
+    void* realloc (void* data, size_t newSize) noexcept
+    {
+        juce::RealtimeSafetyChecker::checkCall (juce::RealtimeSafetyChecker::memoryAllocation);
+        return __libc_realloc (data, newSize);
+    }
+
+    void free (void* data) noexcept
+    {
+        if (data != nullptr)
+            juce::RealtimeSafetyChecker::checkCall (juce::RealtimeSafetyChecker::memoryDeallocation);
+
+        __libc_free (data);
+    }
+}
+#endif
+
+//==============================================================================
+namespace RealtimeSafetyHooks
+{
+    static void* allocate (const size_t size) noexcept
+    {
+        juce::RealtimeSafetyChecker::checkCall (juce::RealtimeSafetyChecker::memoryAllocation);
+
+       #if JUCE_LINUX
+        return __libc_malloc (size > 0 ? size : 1);  // (bypasses the malloc above, so it isn't counted twice)
+       #else
+        return std::malloc (size > 0 ? size : 1);
+       #endif
+    }
+
+    static void release (void* const data) noexcept
+    {
+        if (data != nullptr)
+        {
+            juce::RealtimeSafetyChecker::checkCall (juce::RealtimeSafetyChecker::memoryDeallocation);
+
+           #if JUCE_LINUX
+            __libc_free (data);
+           #else
+            std::free (data);
+           #endif
+        }
+    }
+
+    static void* allocateOrThrow (const size_t size)
+    {
+        if (void* const data = allocate (size))
+            return data;
+
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new (size_t size) JUCE_THROWS_BAD_ALLOC                      { return RealtimeSafetyHooks::allocateOrThrow (size); }
+void* operator new[] (size_t size) JUCE_THROWS_BAD_ALLOC                    { return RealtimeSafetyHooks::allocateOrThrow (size); }
+void* operator new (size_t size, const std::nothrow_t&) noexcept            { return RealtimeSafetyHooks::allocate (size); }
+void* operator new[] (size_t size, const std::nothrow_t&) noexcept          { return RealtimeSafetyHooks::allocate (size); }
+
+void operator delete (void* data) noexcept                                  { RealtimeSafetyHooks::release (data); }
+void operator delete[] (void* data) noexcept                                { RealtimeSafetyHooks::release (data); }
+void operator delete (void* data, const std::nothrow_t&) noexcept           { RealtimeSafetyHooks::release (data); }
+void operator delete[] (void* data, const std::nothrow_t&) noexcept         { RealtimeSafetyHooks::release (data); }
+
+#undef JUCE_THROWS_BAD_ALLOC
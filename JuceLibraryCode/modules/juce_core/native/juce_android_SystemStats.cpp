@@ -293,17 +293,17 @@ int64 Time::getHighResolutionTicks() noexcept
     timespec t;
     clock_gettime (CLOCK_MONOTONIC, &t);
 
-    return (t.tv_sec * (int64) 1000000) + (t.tv_nsec / 1000);
+    return (t.tv_sec * (int64) 1000000000) + t.tv_nsec;
 }
 
 int64 Time::getHighResolutionTicksPerSecond() noexcept
 {
-    return 1000000;  // (microseconds)
+    return 1000000000;  // (nanoseconds)
 }
 
 double Time::getMillisecondCounterHiRes() noexcept
 {
-    return getHighResolutionTicks() * 0.001;
+    return getHighResolutionTicks() * 1.0e-6;
 }
 
 bool Time::setSystemTimeToThisTime() const
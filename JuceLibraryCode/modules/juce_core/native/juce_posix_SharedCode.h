@@ -44,6 +44,7 @@ CriticalSection::~CriticalSection() noexcept
 
 void CriticalSection::enter() const noexcept
 {
+    JUCE_CHECK_REALTIME_SAFE_CALL (lockAcquisition);
     pthread_mutex_lock (&internal);
 }
 
@@ -919,6 +920,15 @@ bool Thread::setThreadPriority (void* handle, int priority)
     return pthread_setschedparam ((pthread_t) handle, policy, &param) == 0;
 }
 
+bool Thread::setCurrentThreadRealtimePriority (int priority)
+{
+    struct sched_param param;
+    param.sched_priority = jlimit (sched_get_priority_min (SCHED_FIFO),
+                                   sched_get_priority_max (SCHED_FIFO), priority);
+
+    return pthread_setschedparam (pthread_self(), SCHED_FIFO, &param) == 0;
+}
+
 Thread::ThreadID Thread::getCurrentThreadId()
 {
     return (ThreadID) pthread_self();
@@ -955,7 +965,7 @@ void Thread::setCurrentThreadAffinityMask (const uint32 affinityMask)
        If you don't want to update your copy of glibc and don't care about cpu affinities,
        then you can just disable all this stuff by setting the SUPPORT_AFFINITIES macro to 0.
     */
-    sched_setaffinity (getpid(), sizeof (cpu_set_t), &affinity);
+    sched_setaffinity (0, sizeof (cpu_set_t), &affinity);
     sched_yield();
 
    #else
@@ -967,6 +977,12 @@ void Thread::setCurrentThreadAffinityMask (const uint32 affinityMask)
    #endif
 }
 
+//==============================================================================
+bool Process::lockMemory()
+{
+    return mlockall (MCL_CURRENT | MCL_FUTURE) == 0;
+}
+
 //==============================================================================
 bool DynamicLibrary::open (const String& name)
 {
@@ -71,6 +71,7 @@ CriticalSection::~CriticalSection() noexcept
 
 void CriticalSection::enter() const noexcept
 {
+    JUCE_CHECK_REALTIME_SAFE_CALL (lockAcquisition);
     EnterCriticalSection ((CRITICAL_SECTION*) internal);
 }
 
@@ -199,6 +200,11 @@ bool Thread::setThreadPriority (void* handle, int priority)
     return SetThreadPriority (handle, pri) != FALSE;
 }
 
+bool Thread::setCurrentThreadRealtimePriority (int /*priority*/)
+{
+    return SetThreadPriority (GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != FALSE;
+}
+
 void Thread::setCurrentThreadAffinityMask (const uint32 affinityMask)
 {
     SetThreadAffinityMask (GetCurrentThread(), affinityMask);
@@ -280,6 +286,13 @@ void Process::setPriority (ProcessPriority prior)
     }
 }
 
+bool Process::lockMemory()
+{
+    // there's no equivalent of mlockall() here - VirtualLock() only works on ranges that
+    // already exist, and is limited by the working set size.
+    return false;
+}
+
 JUCE_API bool JUCE_CALLTYPE juce_isRunningUnderDebugger()
 {
     return IsDebuggerPresent() != FALSE;
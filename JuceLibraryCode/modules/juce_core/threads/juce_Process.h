@@ -59,6 +59,14 @@ public:
     */
     static void setPriority (const ProcessPriority priority);
 
+    /** Locks all of the process's current and future memory pages into physical RAM,
+        so that real-time threads can't be stalled by page faults.
+
+        This usually needs elevated privileges or a raised memlock limit, and
+        returns false if it couldn't be done or isn't supported on this OS.
+    */
+    static bool lockMemory();
+
     /** Kills the current process immediately.
 
         This is an emergency process terminator that kills the application
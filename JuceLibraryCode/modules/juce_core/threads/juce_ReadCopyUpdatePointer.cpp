@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+ReadCopyUpdateBase::ReadCopyUpdateBase() noexcept {}
+ReadCopyUpdateBase::~ReadCopyUpdateBase()
+{
+    // A reader is still using the object that's being deleted!
+    jassert (readerCounts[0].get() == 0 && readerCounts[1].get() == 0);
+}
+
+void ReadCopyUpdateBase::waitForReaders() const
+{
+    const ScopedLock sl (writerLock);
+
+    // Flipping the epoch sends new readers to the other counter, so the one being
+    // waited on can only go down. It's done for both counters, because a reader
+    // that fetched the epoch before an earlier flip could still be registering
+    // with the other one, and might have picked up the old object.
+    for (int i = 0; i < 2; ++i)
+    {
+        const int index = epoch.get() & 1;
+        ++epoch;
+
+        while (readerCounts [index].get() != 0)
+            Thread::sleep (1);
+    }
+}
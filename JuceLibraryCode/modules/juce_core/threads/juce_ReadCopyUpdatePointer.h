@@ -0,0 +1,161 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+#ifndef __JUCE_READCOPYUPDATEPOINTER_JUCEHEADER__
+#define __JUCE_READCOPYUPDATEPOINTER_JUCEHEADER__
+
+
+//==============================================================================
+/**
+    The non-templated part of ReadCopyUpdatePointer, which keeps track of its readers.
+    @see ReadCopyUpdatePointer
+*/
+class JUCE_API  ReadCopyUpdateBase
+{
+protected:
+    ReadCopyUpdateBase() noexcept;
+    ~ReadCopyUpdateBase();
+
+    /** Registers a reader, and returns the index that must be passed to endRead(). */
+    inline int beginRead() const noexcept           { const int index = epoch.get() & 1; ++(readerCounts [index]); return index; }
+
+    /** Unregisters a reader. */
+    inline void endRead (int index) const noexcept  { --(readerCounts [index]); }
+
+    /** Blocks until every reader that had begun before this call has finished. */
+    void waitForReaders() const;
+
+private:
+    mutable Atomic<int> epoch;
+    mutable Atomic<int> readerCounts[2];
+    CriticalSection writerLock;
+
+    JUCE_DECLARE_NON_COPYABLE (ReadCopyUpdateBase)
+};
+
+//==============================================================================
+/**
+    Holds a pointer to an object that real-time threads can read while other threads
+    replace it, without the readers ever locking or waiting.
+
+    The object is treated as immutable once it has been published. To change it, a
+    writer builds a new copy and passes it to exchange(), which swaps the pointer and
+    then waits until no reader can still be using the old object, before handing it
+    back to be deleted. The readers just increment and decrement a counter around each
+    access, so they're wait-free, and any number of them can run at once. Writers can
+    block for as long as the longest read that was running when they made the swap,
+    so they shouldn't be on the audio thread (and must never be inside a ScopedRead
+    of the same pointer, which would deadlock).
+
+    e.g. @code
+    ReadCopyUpdatePointer<Array<AudioSource*> > sources (new Array<AudioSource*>());
+
+    void addSource (AudioSource* newSource)     // (message thread)
+    {
+        Array<AudioSource*>* newList = new Array<AudioSource*> (*sources.get());
+        newList->add (newSource);
+        delete sources.exchange (newList);
+    }
+
+    void getNextAudioBlock (...)                // (audio thread)
+    {
+        const ReadCopyUpdatePointer<Array<AudioSource*> >::ScopedRead list (sources);
+        ...
+    }
+    @endcode
+
+    The ReadCopyUpdatePointer owns its current object, and deletes it when it's deleted.
+*/
+template <class ObjectType>
+class ReadCopyUpdatePointer  : private ReadCopyUpdateBase
+{
+public:
+    //==============================================================================
+    /** Creates a ReadCopyUpdatePointer that holds the given object, which may be null. */
+    explicit ReadCopyUpdatePointer (ObjectType* const initialObject = nullptr) noexcept
+        : object (initialObject)
+    {
+    }
+
+    /** Destructor. This deletes the current object. */
+    ~ReadCopyUpdatePointer()
+    {
+        delete object.get();
+    }
+
+    //==============================================================================
+    /** Returns the current object.
+
+        This doesn't register the caller as a reader, so it's only safe to use on a
+        thread that's responsible for replacing the object. Readers should use a
+        ScopedRead instead.
+    */
+    ObjectType* get() const noexcept                { return object.get(); }
+
+    /** Publishes a new object, and returns the previous one once no reader could still
+        be using it. The caller becomes responsible for deleting the object that's returned.
+    */
+    ObjectType* exchange (ObjectType* const newObject)
+    {
+        ObjectType* const oldObject = object.exchange (newObject);
+        waitForReaders();
+        return oldObject;
+    }
+
+    //==============================================================================
+    /** Gives a reader access to the current object for the lifetime of the ScopedRead.
+        The object it points to won't be deleted until the ScopedRead is deleted.
+    */
+    class ScopedRead
+    {
+    public:
+        inline explicit ScopedRead (const ReadCopyUpdatePointer& owner_) noexcept
+            : owner (owner_), index (owner_.beginRead()), object (owner_.object.get())
+        {
+        }
+
+        inline ~ScopedRead() noexcept                       { owner.endRead (index); }
+
+        inline operator ObjectType*() const noexcept        { return object; }
+        inline ObjectType* get() const noexcept             { return object; }
+        inline ObjectType* operator->() const noexcept      { return object; }
+
+    private:
+        const ReadCopyUpdatePointer& owner;
+        const int index;
+        ObjectType* const object;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedRead)
+    };
+
+private:
+    //==============================================================================
+    Atomic<ObjectType*> object;
+
+    JUCE_DECLARE_NON_COPYABLE (ReadCopyUpdatePointer)
+};
+
+
+#endif   // __JUCE_READCOPYUPDATEPOINTER_JUCEHEADER__
@@ -0,0 +1,307 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+namespace RealtimeSafetyHelpers
+{
+   #if JUCE_MSVC
+    #define JUCE_REALTIME_THREAD_LOCAL  __declspec(thread)
+   #else
+    #define JUCE_REALTIME_THREAD_LOCAL  __thread
+   #endif
+
+    // These have to be plain thread-locals rather than ThreadLocalValues, because
+    // they're read from inside malloc, where nothing is allowed to allocate.
+    static JUCE_REALTIME_THREAD_LOCAL int realtimeScopeDepth = 0;
+    static JUCE_REALTIME_THREAD_LOCAL int exemptionDepth = 0;
+
+    enum
+    {
+        maxCallSites = 256,
+        maxFrames = 16,
+        numFramesToSkip = 2   // recordViolation() and checkCall()
+    };
+
+    struct CallSite
+    {
+        Atomic<pointer_sized_int> key;
+        Atomic<int> count, isReady;
+        int type, numFrames;
+        void* frames [maxFrames];
+    };
+
+    static CallSite callSites [maxCallSites];
+    static Atomic<int> numViolations, numUnrecordedViolations;
+    static volatile bool isCheckingEnabled = false, isStrict = false;
+
+    static const char* getTypeName (const int type) noexcept
+    {
+        switch (type)
+        {
+            case RealtimeSafetyChecker::memoryAllocation:    return "memory allocation";
+            case RealtimeSafetyChecker::memoryDeallocation:  return "memory deallocation";
+            default:                                         return "lock acquisition";
+        }
+    }
+
+    static int captureStack (void** frames) noexcept
+    {
+       #if JUCE_ANDROID || JUCE_MINGW
+        (void) frames;
+        return 0;
+       #elif JUCE_WINDOWS
+        return (int) CaptureStackBackTrace (numFramesToSkip, maxFrames, frames, nullptr);
+       #else
+        void* stack [maxFrames + numFramesToSkip];
+        const int numFrames = backtrace (stack, numElementsInArray (stack)) - numFramesToSkip;
+
+        for (int i = 0; i < numFrames; ++i)
+            frames[i] = stack [i + numFramesToSkip];
+
+        return jmax (0, numFrames);
+       #endif
+    }
+
+   #if JUCE_ENABLE_REALTIME_SAFETY_CHECKS
+    static String describeStack (void* const* frames, const int numFrames)
+    {
+        String result;
+
+       #if JUCE_WINDOWS && ! JUCE_MINGW
+        HANDLE process = GetCurrentProcess();
+        SymInitialize (process, nullptr, TRUE);
+
+        HeapBlock<SYMBOL_INFO> symbol;
+        symbol.calloc (sizeof (SYMBOL_INFO) + 256, 1);
+        symbol->MaxNameLen = 255;
+        symbol->SizeOfStruct = sizeof (SYMBOL_INFO);
+
+        for (int i = 0; i < numFrames; ++i)
+        {
+            DWORD64 displacement = 0;
+
+            if (SymFromAddr (process, (DWORD64) frames[i], &displacement, symbol))
+                result << "    " << symbol->Name << " + 0x" << String::toHexString ((int64) displacement) << newLine;
+            else
+                result << "    0x" << String::toHexString ((int64) (pointer_sized_int) frames[i]) << newLine;
+        }
+
+       #elif JUCE_ANDROID || JUCE_MINGW
+        for (int i = 0; i < numFrames; ++i)
+            result << "    0x" << String::toHexString ((int64) (pointer_sized_int) frames[i]) << newLine;
+
+       #else
+        char** const names = backtrace_symbols (frames, numFrames);
+
+        if (names != nullptr)
+        {
+            for (int i = 0; i < numFrames; ++i)
+                result << "    " << String (CharPointer_UTF8 (names[i])) << newLine;
+
+            ::free (names);
+        }
+       #endif
+
+        return result;
+    }
+   #endif
+
+    static void abortWithViolation (const int type, void* const* frames, const int numFrames) noexcept
+    {
+        fputs ("Real-time safety violation: ", stderr);
+        fputs (getTypeName (type), stderr);
+        fputs (" on a real-time thread\n", stderr);
+
+       #if ! (JUCE_WINDOWS || JUCE_ANDROID)
+        backtrace_symbols_fd (frames, numFrames, 2);
+       #else
+        (void) frames; (void) numFrames;
+       #endif
+
+        std::abort();
+    }
+
+    static void recordViolation (const int type) noexcept
+    {
+        void* frames [maxFrames];
+        const int numFrames = captureStack (frames);
+
+        if (isStrict)
+            abortWithViolation (type, frames, numFrames);
+
+        ++numViolations;
+
+        pointer_sized_uint hash = (pointer_sized_uint) type + 1;
+
+        for (int i = 0; i < numFrames; ++i)
+            hash = hash * 31 + (pointer_sized_uint) frames[i];
+
+        const pointer_sized_int key = hash != 0 ? (pointer_sized_int) hash : 1;
+
+        for (int i = 0; i < maxCallSites; ++i)
+        {
+            CallSite& site = callSites [(hash + (pointer_sized_uint) i) % maxCallSites];
+
+            for (;;)
+            {
+                const pointer_sized_int existingKey = site.key.value;
+
+                if (existingKey == key)
+                {
+                    ++(site.count);
+                    return;
+                }
+
+                if (existingKey != 0)
+                    break;
+
+                if (site.key.compareAndSetBool (key, 0))
+                {
+                    site.type = type;
+                    site.numFrames = numFrames;
+                    memcpy (site.frames, frames, sizeof (void*) * (size_t) numFrames);
+                    ++(site.count);
+                    site.isReady.compareAndSetBool (1, 0);
+                    return;
+                }
+            }
+        }
+
+        ++numUnrecordedViolations;
+    }
+
+    struct CallSiteCountComparator
+    {
+        static int compareElements (const CallSite* first, const CallSite* second) noexcept
+        {
+            return second->count.value - first->count.value;
+        }
+    };
+}
+
+//==============================================================================
+void RealtimeSafetyChecker::setEnabled (const bool shouldBeEnabled)
+{
+   #if ! (JUCE_WINDOWS || JUCE_ANDROID)
+    if (shouldBeEnabled)
+    {
+        // The first call to backtrace() can allocate while it loads the unwinder,
+        // so get that out of the way now rather than on the audio thread.
+        void* stack [1];
+        backtrace (stack, 1);
+    }
+   #endif
+
+    RealtimeSafetyHelpers::isCheckingEnabled = shouldBeEnabled;
+}
+
+bool RealtimeSafetyChecker::isEnabled() noexcept
+{
+    return RealtimeSafetyHelpers::isCheckingEnabled;
+}
+
+void RealtimeSafetyChecker::setStrictMode (const bool shouldAbortOnViolation) noexcept
+{
+    RealtimeSafetyHelpers::isStrict = shouldAbortOnViolation;
+}
+
+bool RealtimeSafetyChecker::isCurrentThreadRealtime() noexcept
+{
+    return RealtimeSafetyHelpers::realtimeScopeDepth > 0;
+}
+
+int RealtimeSafetyChecker::getNumViolations() noexcept
+{
+    return RealtimeSafetyHelpers::numViolations.get();
+}
+
+void RealtimeSafetyChecker::reset() noexcept
+{
+    using namespace RealtimeSafetyHelpers;
+
+    for (int i = 0; i < maxCallSites; ++i)
+    {
+        CallSite& site = callSites[i];
+        site.isReady = 0;
+        site.count = 0;
+        site.key = 0;
+    }
+
+    numViolations = 0;
+    numUnrecordedViolations = 0;
+}
+
+String RealtimeSafetyChecker::getReport()
+{
+    using namespace RealtimeSafetyHelpers;
+
+   #if ! JUCE_ENABLE_REALTIME_SAFETY_CHECKS
+    return "Real-time safety checks aren't compiled into this build (see JUCE_ENABLE_REALTIME_SAFETY_CHECKS)" + String (newLine);
+   #else
+    const ScopedExemption exemption;
+
+    Array<const CallSite*> sites;
+    CallSiteCountComparator comparator;
+
+    for (int i = 0; i < maxCallSites; ++i)
+        if (callSites[i].isReady.get() != 0)
+            sites.addSorted (comparator, callSites + i);
+
+    String report;
+    report << numViolations.get() << " real-time safety violations, at " << sites.size() << " call sites" << newLine;
+
+    for (int i = 0; i < sites.size(); ++i)
+    {
+        const CallSite& site = *sites.getUnchecked (i);
+
+        report << newLine << site.count.get() << " x " << getTypeName (site.type) << ", at:" << newLine
+               << describeStack (site.frames, site.numFrames);
+    }
+
+    if (numUnrecordedViolations.get() > 0)
+        report << newLine << numUnrecordedViolations.get() << " more at call sites that didn't fit in the table" << newLine;
+
+    return report;
+   #endif
+}
+
+void RealtimeSafetyChecker::checkCall (const ViolationType type) noexcept
+{
+    using namespace RealtimeSafetyHelpers;
+
+    if (realtimeScopeDepth > 0 && exemptionDepth == 0 && isCheckingEnabled)
+    {
+        // (capturing the stack may itself allocate, so mustn't recurse back into here)
+        ++exemptionDepth;
+        recordViolation (type);
+        --exemptionDepth;
+    }
+}
+
+//==============================================================================
+RealtimeSafetyChecker::ScopedRealtimeThread::ScopedRealtimeThread() noexcept    { ++RealtimeSafetyHelpers::realtimeScopeDepth; }
+RealtimeSafetyChecker::ScopedRealtimeThread::~ScopedRealtimeThread() noexcept   { --RealtimeSafetyHelpers::realtimeScopeDepth; }
+
+RealtimeSafetyChecker::ScopedExemption::ScopedExemption() noexcept              { ++RealtimeSafetyHelpers::exemptionDepth; }
+RealtimeSafetyChecker::ScopedExemption::~ScopedExemption() noexcept             { --RealtimeSafetyHelpers::exemptionDepth; }
@@ -0,0 +1,158 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+#ifndef __JUCE_REALTIMESAFETYCHECKER_JUCEHEADER__
+#define __JUCE_REALTIMESAFETYCHECKER_JUCEHEADER__
+
+
+//==============================================================================
+/**
+    Catches memory allocations and lock acquisitions that happen on a real-time
+    thread, so that an audio callback can be shown to be free of them.
+
+    Code that must be real-time safe is marked with JUCE_REALTIME_THREAD_SCOPE,
+    which flags the calling thread as real-time until the end of the scope. While
+    the checker is enabled, any call to operator new or delete, or any wait on a
+    CriticalSection or SpinLock, made by a flagged thread counts as a violation.
+    On Linux, malloc, calloc, realloc and free are intercepted too.
+
+    Each violation is recorded against a stack trace of its call site, in a fixed-
+    size table, so recording one doesn't allocate anything itself. When the run is
+    finished, getReport() lists the call sites and how many times each one was hit.
+    In strict mode, the first violation prints its stack trace and aborts the
+    process instead, which is handy when running under a debugger.
+
+    All of this is only compiled in when the JUCE_ENABLE_REALTIME_SAFETY_CHECKS flag
+    is set, because it replaces the global operator new and delete. Otherwise, the
+    macros do nothing and no violations are ever reported.
+
+    e.g. @code
+    void processBlock (AudioSampleBuffer& buffer, MidiBuffer& midi)
+    {
+        JUCE_REALTIME_THREAD_SCOPE;
+        ...
+    }
+
+    RealtimeSafetyChecker::setEnabled (true);
+    runTheAudio();
+    std::cerr << RealtimeSafetyChecker::getReport();
+    @endcode
+*/
+class JUCE_API  RealtimeSafetyChecker
+{
+public:
+    //==============================================================================
+    /** The kinds of call that aren't allowed on a real-time thread. */
+    enum ViolationType
+    {
+        memoryAllocation = 0,
+        memoryDeallocation,
+        lockAcquisition
+    };
+
+    //==============================================================================
+    /** Turns the checking on or off. It's off by default. */
+    static void setEnabled (bool shouldBeEnabled);
+
+    /** Returns true if the checking is turned on. */
+    static bool isEnabled() noexcept;
+
+    /** In strict mode, the first violation aborts the process rather than being recorded. */
+    static void setStrictMode (bool shouldAbortOnViolation) noexcept;
+
+    /** Returns true if the calling thread is inside a JUCE_REALTIME_THREAD_SCOPE. */
+    static bool isCurrentThreadRealtime() noexcept;
+
+    //==============================================================================
+    /** Returns the total number of violations that have been recorded. */
+    static int getNumViolations() noexcept;
+
+    /** Returns a list of the call sites that have been recorded, with their stack
+        traces and counts, most frequent first.
+    */
+    static String getReport();
+
+    /** Clears all the recorded violations.
+        This mustn't be called while a real-time thread could be recording one.
+    */
+    static void reset() noexcept;
+
+    //==============================================================================
+    /** Records a violation if the calling thread is currently flagged as real-time.
+        This is called by the allocation and locking functions, and can be called by
+        other code that shouldn't be used on an audio thread.
+    */
+    static void checkCall (ViolationType type) noexcept;
+
+    //==============================================================================
+    /** Flags the calling thread as real-time for the lifetime of this object.
+        These can be nested. @see JUCE_REALTIME_THREAD_SCOPE
+    */
+    class JUCE_API  ScopedRealtimeThread
+    {
+    public:
+        ScopedRealtimeThread() noexcept;
+        ~ScopedRealtimeThread() noexcept;
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE (ScopedRealtimeThread)
+    };
+
+    /** Suspends the checks on the calling thread for the lifetime of this object.
+
+        This is for calls that are known to be unsafe, but which are deliberately
+        allowed, so that they don't hide the ones that aren't.
+    */
+    class JUCE_API  ScopedExemption
+    {
+    public:
+        ScopedExemption() noexcept;
+        ~ScopedExemption() noexcept;
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE (ScopedExemption)
+    };
+
+private:
+    RealtimeSafetyChecker();
+    JUCE_DECLARE_NON_COPYABLE (RealtimeSafetyChecker)
+};
+
+//==============================================================================
+#if JUCE_ENABLE_REALTIME_SAFETY_CHECKS || DOXYGEN
+ /** Flags the calling thread as real-time for the rest of the enclosing scope.
+     @see RealtimeSafetyChecker
+ */
+ #define JUCE_REALTIME_THREAD_SCOPE             const juce::RealtimeSafetyChecker::ScopedRealtimeThread JUCE_JOIN_MACRO (realtimeThread_, __LINE__)
+
+ /** Records a violation of the given RealtimeSafetyChecker::ViolationType if called on a real-time thread. */
+ #define JUCE_CHECK_REALTIME_SAFE_CALL(type)    juce::RealtimeSafetyChecker::checkCall (juce::RealtimeSafetyChecker::type)
+#else
+ #define JUCE_REALTIME_THREAD_SCOPE
+ #define JUCE_CHECK_REALTIME_SAFE_CALL(type)
+#endif
+
+
+#endif   // __JUCE_REALTIMESAFETYCHECKER_JUCEHEADER__
@@ -0,0 +1,272 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+class RealtimeWorkerGroup::WaitableCounter
+{
+public:
+    WaitableCounter() noexcept {}
+
+    int get() const noexcept                { return value.get(); }
+
+    void set (const int newValue) noexcept
+    {
+        value = newValue;
+        wakeIfWaiting();
+    }
+
+    void decrement() noexcept
+    {
+        if (--value == 0)
+            wakeIfWaiting();
+    }
+
+    // Spins until the value differs from oldValue, then falls back to sleeping.
+    void waitWhileEqual (const int oldValue, const int spinMicroseconds) noexcept
+    {
+        if (spinMicroseconds > 0)
+        {
+            const int64 spinEnd = Time::getHighResolutionTicks()
+                                    + Time::secondsToHighResolutionTicks (spinMicroseconds * 1.0e-6);
+
+            do
+            {
+                // plain reads, so that spinning doesn't keep stealing the cache line from the writer
+                for (int i = 64; --i >= 0;)
+                    if (value.value != oldValue)
+                        return;
+            }
+            while (Time::getHighResolutionTicks() < spinEnd);
+        }
+
+        ++numWaiters;
+
+        while (value.get() == oldValue)
+            sleep (oldValue);
+
+        --numWaiters;
+    }
+
+private:
+    Atomic<int> value, numWaiters;
+
+    void wakeIfWaiting() noexcept
+    {
+        if (numWaiters.get() > 0)
+            wake();
+    }
+
+   #if JUCE_LINUX
+    void sleep (const int oldValue) noexcept
+    {
+        syscall (SYS_futex, &value.value, FUTEX_WAIT_PRIVATE, oldValue, nullptr, nullptr, 0);
+    }
+
+    void wake() noexcept
+    {
+        syscall (SYS_futex, &value.value, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    }
+   #else
+    WaitableEvent event;
+
+    void sleep (int) noexcept   { event.wait(); }
+    void wake() noexcept        { event.signal(); }
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE (WaitableCounter)
+};
+
+//==============================================================================
+class RealtimeWorkerGroup::Worker  : public Thread
+{
+public:
+    Worker (RealtimeWorkerGroup& owner_, const int index_)
+        : Thread (owner_.groupName + " " + String (index_)),
+          owner (owner_), index (index_), isRealtime (false)
+    {
+    }
+
+    void run()
+    {
+        isRealtime = owner.priority <= 0 || setCurrentThreadRealtimePriority (owner.priority);
+
+        int lastGeneration = trigger.get();
+        ready.signal();
+
+        for (;;)
+        {
+            trigger.waitWhileEqual (lastGeneration, owner.getEffectiveSpinTime());
+            lastGeneration = trigger.get();
+
+            if (threadShouldExit())
+                break;
+
+            owner.currentTask->runWorkerTask (index, owner.getNumParticipants());
+            owner.numUnfinished->decrement();
+        }
+    }
+
+    RealtimeWorkerGroup& owner;
+    const int index;
+    WaitableCounter trigger;
+    WaitableEvent ready;
+    bool isRealtime;
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (Worker)
+};
+
+//==============================================================================
+RealtimeWorkerGroup::RealtimeWorkerGroup (const String& groupName_, const int numWorkers)
+    : groupName (groupName_),
+      numUnfinished (new WaitableCounter()),
+      currentTask (nullptr),
+      generation (0),
+      priority (0),
+      spinTime (100),
+      shouldLockMemory (false),
+      running (false)
+{
+    jassert (numWorkers >= 0);
+
+    for (int i = 1; i <= numWorkers; ++i)
+        workers.add (new Worker (*this, i));
+}
+
+RealtimeWorkerGroup::~RealtimeWorkerGroup()
+{
+    stop();
+}
+
+//==============================================================================
+void RealtimeWorkerGroup::setWorkerCores (const Array<int>& newCoreIndexes)
+{
+    jassert (! running);  // this needs to be set before the workers are started
+    coreIndexes = newCoreIndexes;
+}
+
+void RealtimeWorkerGroup::setRealtimePriority (const int newPriority) noexcept
+{
+    jassert (! running);
+    priority = newPriority;
+}
+
+void RealtimeWorkerGroup::setShouldLockMemory (const bool shouldLock) noexcept
+{
+    shouldLockMemory = shouldLock;
+}
+
+void RealtimeWorkerGroup::setSpinTime (const int microseconds) noexcept
+{
+    spinTime = jmax (0, microseconds);
+}
+
+int RealtimeWorkerGroup::getEffectiveSpinTime() const noexcept
+{
+    return SystemStats::getNumCpus() >= getNumParticipants() ? spinTime : 0;
+}
+
+//==============================================================================
+bool RealtimeWorkerGroup::start()
+{
+    if (running)
+        return true;
+
+    bool succeeded = ! shouldLockMemory || Process::lockMemory();
+
+    for (int i = 0; i < workers.size(); ++i)
+    {
+        Worker* const w = workers.getUnchecked (i);
+        const int core = coreIndexes [i];
+
+        jassert (core < 32);
+        w->setAffinityMask (isPositiveAndBelow (core, 32) ? (uint32) (1 << core) : 0);
+        w->startThread();
+    }
+
+    for (int i = 0; i < workers.size(); ++i)
+    {
+        Worker* const w = workers.getUnchecked (i);
+        w->ready.wait();
+        succeeded = succeeded && w->isRealtime;
+    }
+
+    running = true;
+    return succeeded;
+}
+
+void RealtimeWorkerGroup::stop()
+{
+    if (! running)
+        return;
+
+    running = false;
+    ++generation;
+
+    for (int i = 0; i < workers.size(); ++i)
+    {
+        Worker* const w = workers.getUnchecked (i);
+        w->signalThreadShouldExit();
+        w->trigger.set (generation);
+    }
+
+    for (int i = 0; i < workers.size(); ++i)
+        workers.getUnchecked (i)->stopThread (5000);
+}
+
+//==============================================================================
+void RealtimeWorkerGroup::perform (Task& task)
+{
+    const int numParticipants = getNumParticipants();
+
+    if (! running)
+    {
+        for (int i = 0; i < numParticipants; ++i)
+            task.runWorkerTask (i, numParticipants);
+
+        return;
+    }
+
+    currentTask = &task;
+    numUnfinished->set (workers.size());
+    ++generation;
+
+    for (int i = 0; i < workers.size(); ++i)
+        workers.getUnchecked (i)->trigger.set (generation);
+
+    task.runWorkerTask (0, numParticipants);
+    const int waitSpinTime = getEffectiveSpinTime();
+
+    for (;;)
+    {
+        const int remaining = numUnfinished->get();
+
+        if (remaining == 0)
+            break;
+
+        numUnfinished->waitWhileEqual (remaining, waitSpinTime);
+    }
+
+    currentTask = nullptr;
+}
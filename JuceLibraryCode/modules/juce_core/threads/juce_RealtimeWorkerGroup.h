@@ -0,0 +1,186 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2013 - Raw Material Software Ltd.
+
+   Permission is granted to use this software under the terms of either:
+   a) the GPL v2 (or any later version)
+   b) the Affero GPL v3
+
+   Details of these licenses can be found at: www.gnu.org/licenses
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+   ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.juce.com for more information.
+
+  ==============================================================================
+*/
+
+
+#ifndef __JUCE_REALTIMEWORKERGROUP_JUCEHEADER__
+#define __JUCE_REALTIMEWORKERGROUP_JUCEHEADER__
+
+#include "juce_Thread.h"
+#include "../containers/juce_Array.h"
+#include "../containers/juce_OwnedArray.h"
+#include "../memory/juce_ScopedPointer.h"
+
+
+//==============================================================================
+/**
+    A fixed group of real-time helper threads that can share the work of an audio
+    callback.
+
+    Each call to perform() wakes the workers, runs a task on all of them and on the
+    calling thread at the same time, and then waits until every one of them has
+    finished, so the whole job fits inside a single block's deadline. Between blocks
+    the workers spin for a short while, then go to sleep on a futex (or a
+    WaitableEvent on other platforms), so that a steady callback cycle wakes them
+    with very little latency while an idle group costs nothing.
+
+    The workers can be pinned to chosen CPU cores and given SCHED_FIFO priority, and
+    the process's memory can be locked so that page faults can't stall them. These
+    need to be configured before start() is called.
+
+    e.g. @code
+    struct ChannelTask  : public RealtimeWorkerGroup::Task
+    {
+        void runWorkerTask (int index, int numParticipants)
+        {
+            for (int i = index; i < buffer->getNumChannels(); i += numParticipants)
+                processChannel (i);
+        }
+        ...
+    };
+
+    // in the audio callback:
+    workers.perform (channelTask);
+    @endcode
+
+    @see ThreadPool
+*/
+class JUCE_API  RealtimeWorkerGroup
+{
+public:
+    //==============================================================================
+    /** Creates a group.
+        The threads aren't started until start() is called.
+
+        @param groupName    a name used for the worker threads
+        @param numWorkers   the number of extra threads to create. The thread that
+                            calls perform() also takes part, so this is usually one
+                            less than the number of cores you want to use.
+    */
+    RealtimeWorkerGroup (const String& groupName, int numWorkers);
+
+    /** Destructor.
+        This stops the workers if they're still running.
+    */
+    ~RealtimeWorkerGroup();
+
+    //==============================================================================
+    /** A piece of work that's run by every participant in a perform() call. */
+    class JUCE_API  Task
+    {
+    public:
+        /** Destructor. */
+        virtual ~Task() {}
+
+        /** Does this participant's share of the work.
+
+            The calling thread always has index 0, and the workers have indexes from
+            1 to numParticipants - 1. All of them run concurrently, so they must only
+            touch data that doesn't overlap.
+        */
+        virtual void runWorkerTask (int index, int numParticipants) = 0;
+    };
+
+    //==============================================================================
+    /** Chooses the CPU core that each worker should be pinned to.
+        Worker i (i.e. the participant with index i + 1) will run on core
+        coreIndexes[i]; workers beyond the end of the array, or with a negative core
+        index, are left unpinned. Core indexes must be less than 32, and pinning
+        isn't supported on OSX.
+    */
+    void setWorkerCores (const Array<int>& coreIndexes);
+
+    /** Sets the SCHED_FIFO priority that the workers will run with.
+        Use 0 to leave them with normal scheduling. The default is 0.
+        @see Thread::setCurrentThreadRealtimePriority
+    */
+    void setRealtimePriority (int priority) noexcept;
+
+    /** If true, start() will lock the process's memory into RAM.
+        @see Process::lockMemory
+    */
+    void setShouldLockMemory (bool shouldLock) noexcept;
+
+    /** Sets how long a waiting thread spins before going to sleep.
+        A longer spin lowers the wake-up latency when the callbacks come quickly,
+        at the expense of burning CPU on the workers' cores. The default is 100us.
+        Spinning is skipped when there are fewer cores than participants, since a
+        spinning thread would only be holding up the one it's waiting for.
+    */
+    void setSpinTime (int microseconds) noexcept;
+
+    //==============================================================================
+    /** Starts the worker threads.
+
+        Returns true if all of the requested real-time settings could be applied.
+        If they couldn't, the workers still run, but without those guarantees.
+    */
+    bool start();
+
+    /** Stops the worker threads.
+        This must not be called while perform() is running.
+    */
+    void stop();
+
+    /** Returns true if the workers have been started. */
+    bool isRunning() const noexcept                     { return running; }
+
+    /** Returns the number of worker threads. */
+    int getNumWorkers() const noexcept                  { return workers.size(); }
+
+    /** Returns the number of threads that take part in a perform() call. */
+    int getNumParticipants() const noexcept             { return workers.size() + 1; }
+
+    //==============================================================================
+    /** Runs a task on every worker and on the calling thread, and returns when all
+        of them have finished.
+
+        This is intended to be called from the audio callback, and doesn't allocate or
+        take any locks. Only one thread may call it at a time. If the group isn't
+        running, the calling thread just does all the work itself.
+    */
+    void perform (Task& task);
+
+private:
+    //==============================================================================
+    class Worker;
+    class WaitableCounter;
+    friend class Worker;
+    friend class OwnedArray<Worker>;
+    friend class ScopedPointer<WaitableCounter>;
+
+    const String groupName;
+    OwnedArray<Worker> workers;
+    ScopedPointer<WaitableCounter> numUnfinished;
+    Array<int> coreIndexes;
+    Task* volatile currentTask;
+    int generation, priority, spinTime;
+    bool shouldLockMemory, running;
+
+    int getEffectiveSpinTime() const noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RealtimeWorkerGroup)
+};
+
+
+#endif   // __JUCE_REALTIMEWORKERGROUP_JUCEHEADER__
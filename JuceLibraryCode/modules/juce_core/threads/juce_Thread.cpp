@@ -246,6 +246,8 @@ void Thread::notify() const
 //==============================================================================
 void SpinLock::enter() const noexcept
 {
+    JUCE_CHECK_REALTIME_SAFE_CALL (lockAcquisition);
+
     if (! tryEnter())
     {
         for (int i = 20; --i >= 0;)
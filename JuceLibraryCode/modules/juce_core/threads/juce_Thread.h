@@ -175,6 +175,20 @@ public:
     */
     static bool setCurrentThreadPriority (int priority);
 
+    /** Switches the caller thread to first-in-first-out real-time scheduling.
+
+        On POSIX systems this uses SCHED_FIFO, and the priority is clipped to the
+        range that the system allows (1 to 99 on Linux). A thread scheduled like
+        this will run until it blocks or yields, so it must never spin indefinitely.
+        On Windows, the priority is ignored and the thread is made time-critical.
+
+        Returns false if the scheduling couldn't be changed, which normally means
+        the process lacks the privilege to do so (e.g. a zero RLIMIT_RTPRIO).
+
+        @see setCurrentThreadPriority
+    */
+    static bool setCurrentThreadRealtimePriority (int priority);
+
     //==============================================================================
     /** Sets the affinity mask for the thread.
 
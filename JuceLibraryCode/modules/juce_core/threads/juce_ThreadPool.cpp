@@ -29,6 +29,7 @@
 ThreadPoolJob::ThreadPoolJob (const String& name)
     : jobName (name),
       pool (nullptr),
+      ticket (nullptr),
       shouldStop (false),
       isActive (false),
       shouldBeDeleted (false)
@@ -57,6 +58,113 @@ void ThreadPoolJob::signalJobShouldExit()
     shouldStop = true;
 }
 
+//==============================================================================
+/*  The entry that sits in a queue on behalf of a job.
+
+    Queued entries can't be taken out of the middle of the lock-free queues, so when
+    a job is removed before it starts, its entry is just marked as cancelled and left
+    for whichever thread pops it to delete. A thread that wants to run a job has to
+    claim its entry first, so exactly one of the two will win.
+*/
+class ThreadPoolJobTicket
+{
+public:
+    ThreadPoolJobTicket (ThreadPoolJob* job_) noexcept  : job (job_), indexInJobList (0), state (queued) {}
+
+    enum State
+    {
+        queued = 0,
+        claimed,
+        cancelled
+    };
+
+    bool claim() noexcept       { return state.compareAndSetBool (claimed, queued); }
+    bool cancel() noexcept      { return state.compareAndSetBool (cancelled, queued); }
+    bool isClaimed() const      { return state.get() == claimed; }
+    void requeue() noexcept     { state.set (queued); }
+
+    ThreadPoolJob* const job;
+    int indexInJobList;
+
+private:
+    Atomic<int> state;
+
+    JUCE_DECLARE_NON_COPYABLE (ThreadPoolJobTicket)
+};
+
+//==============================================================================
+/*  A fixed-size Chase-Lev work-stealing deque. Only the owning thread may push and pop,
+    at the bottom; any thread can steal from the top.
+*/
+class ThreadPoolWorkDeque
+{
+public:
+    ThreadPoolWorkDeque() noexcept {}
+
+    bool push (ThreadPoolJobTicket* t) noexcept
+    {
+        const int b = bottom.get();
+
+        if (b - top.get() >= capacity)
+            return false;
+
+        slots [b & (capacity - 1)] = t;
+        Atomic<int>::memoryBarrier();
+        bottom.set (b + 1);
+        return true;
+    }
+
+    ThreadPoolJobTicket* pop() noexcept
+    {
+        const int b = bottom.get() - 1;
+        bottom.set (b);
+        Atomic<int>::memoryBarrier();
+        const int t = top.get();
+
+        if (t > b)
+        {
+            bottom.set (b + 1);
+            return nullptr;
+        }
+
+        ThreadPoolJobTicket* result = slots [b & (capacity - 1)].get();
+
+        if (t == b)
+        {
+            // this is the last item, so race any thieves for it..
+            if (! top.compareAndSetBool (t + 1, t))
+                result = nullptr;
+
+            bottom.set (b + 1);
+        }
+
+        return result;
+    }
+
+    ThreadPoolJobTicket* steal() noexcept
+    {
+        const int t = top.get();
+        Atomic<int>::memoryBarrier();
+        const int b = bottom.get();
+
+        if (t >= b)
+            return nullptr;
+
+        ThreadPoolJobTicket* const result = slots [t & (capacity - 1)].get();
+        return top.compareAndSetBool (t + 1, t) ? result : nullptr;
+    }
+
+    int getNumQueued() const noexcept   { return jmax (0, bottom.get() - top.get()); }
+
+    enum { capacity = 1024 };
+
+private:
+    Atomic<int> top, bottom;
+    Atomic<ThreadPoolJobTicket*> slots [capacity];
+
+    JUCE_DECLARE_NON_COPYABLE (ThreadPoolWorkDeque)
+};
+
 //==============================================================================
 class ThreadPool::ThreadPoolThread  : public Thread
 {
@@ -71,11 +179,24 @@ public:
     {
         while (! threadShouldExit())
         {
-            if (! pool.runNextJob())
-                wait (500);
+            if (pool.runNextJob (this))
+                continue;
+
+            // Announce that we're going to sleep before checking the queues one last time,
+            // so that anything added after the check is guaranteed to wake us.
+            isSleeping = 1;
+            Atomic<int>::memoryBarrier();
+
+            if (! (pool.hasQueuedJobs() || threadShouldExit()))
+                wait (-1);
+
+            isSleeping = 0;
         }
     }
 
+    ThreadPoolWorkDeque deque;
+    Atomic<int> isSleeping;
+
 private:
     ThreadPool& pool;
 
@@ -84,6 +205,7 @@ private:
 
 //==============================================================================
 ThreadPool::ThreadPool (const int numThreads)
+    : sharedQueueStart (0)
 {
     jassert (numThreads > 0); // not much point having a pool without any threads!
 
@@ -91,6 +213,7 @@ ThreadPool::ThreadPool (const int numThreads)
 }
 
 ThreadPool::ThreadPool()
+    : sharedQueueStart (0)
 {
     createThreads (SystemStats::getNumCpus());
 }
@@ -99,6 +222,14 @@ ThreadPool::~ThreadPool()
 {
     removeAllJobs (true, 5000);
     stopThreads();
+
+    // delete any cancelled entries that are still sitting in the queues
+    for (int i = threads.size(); --i >= 0;)
+        while (ThreadPoolJobTicket* t = threads.getUnchecked(i)->deque.pop())
+            delete t;
+
+    for (int i = sharedQueueStart; i < sharedQueue.size(); ++i)
+        delete sharedQueue.getUnchecked (i);
 }
 
 void ThreadPool::createThreads (int numThreads)
@@ -113,12 +244,30 @@ void ThreadPool::createThreads (int numThreads)
 void ThreadPool::stopThreads()
 {
     for (int i = threads.size(); --i >= 0;)
+    {
         threads.getUnchecked(i)->signalThreadShouldExit();
+        threads.getUnchecked(i)->notify();
+    }
 
     for (int i = threads.size(); --i >= 0;)
         threads.getUnchecked(i)->stopThread (500);
 }
 
+int ThreadPool::getNumThreads() const noexcept
+{
+    return threads.size();
+}
+
+ThreadPoolJobTicket* ThreadPool::prepareJob (ThreadPoolJob* const job, const bool deleteJobWhenFinished)
+{
+    job->pool = this;
+    job->shouldStop = false;
+    job->isActive = false;
+    job->shouldBeDeleted = deleteJobWhenFinished;
+    job->ticket = new ThreadPoolJobTicket (job);
+    return job->ticket;
+}
+
 void ThreadPool::addJob (ThreadPoolJob* const job, const bool deleteJobWhenFinished)
 {
     jassert (job != nullptr);
@@ -126,19 +275,102 @@ void ThreadPool::addJob (ThreadPoolJob* const job, const bool deleteJobWhenFinis
 
     if (job->pool == nullptr)
     {
-        job->pool = this;
-        job->shouldStop = false;
-        job->isActive = false;
-        job->shouldBeDeleted = deleteJobWhenFinished;
+        ThreadPoolJobTicket* const t = prepareJob (job, deleteJobWhenFinished);
 
         {
             const ScopedLock sl (lock);
-            jobs.add (job);
+            addToJobList (job);
+        }
+
+        queueTickets (&t, 1);
+        wakeThreads (1);
+    }
+}
+
+void ThreadPool::addJobs (const Array<ThreadPoolJob*>& jobsToAdd, const bool deleteJobsWhenFinished)
+{
+    HeapBlock<ThreadPoolJobTicket*> tickets ((size_t) jobsToAdd.size());
+    int numTickets = 0;
+
+    {
+        const ScopedLock sl (lock);
+
+        for (int i = 0; i < jobsToAdd.size(); ++i)
+        {
+            ThreadPoolJob* const job = jobsToAdd.getUnchecked (i);
+            jassert (job != nullptr && job->pool == nullptr);
+
+            if (job != nullptr && job->pool == nullptr)
+            {
+                tickets [numTickets++] = prepareJob (job, deleteJobsWhenFinished);
+                addToJobList (job);
+            }
         }
+    }
+
+    queueTickets (tickets, numTickets);
+    wakeThreads (numTickets);
+}
+
+ThreadPool::ThreadPoolThread* ThreadPool::getCurrentPoolThread() const
+{
+    Thread* const current = Thread::getCurrentThread();
 
+    if (current != nullptr)
         for (int i = threads.size(); --i >= 0;)
-            threads.getUnchecked(i)->notify();
+            if (threads.getUnchecked(i) == current)
+                return threads.getUnchecked(i);
+
+    return nullptr;
+}
+
+void ThreadPool::queueTickets (ThreadPoolJobTicket* const* tickets, int numTickets)
+{
+    // jobs added from inside a job stay local to that thread, where they're
+    // likely to find their data still in the cache..
+    if (ThreadPoolThread* const current = getCurrentPoolThread())
+    {
+        while (numTickets > 0 && current->deque.push (*tickets))
+        {
+            ++tickets;
+            --numTickets;
+        }
     }
+
+    if (numTickets > 0)
+    {
+        const SpinLock::ScopedLockType sl (sharedQueueLock);
+        sharedQueue.addArray (tickets, numTickets);
+        numInSharedQueue += numTickets;
+    }
+}
+
+void ThreadPool::wakeThreads (int numToWake)
+{
+    Atomic<int>::memoryBarrier();
+
+    for (int i = 0; i < threads.size() && numToWake > 0; ++i)
+    {
+        ThreadPoolThread* const t = threads.getUnchecked(i);
+
+        if (t->isSleeping.compareAndSetBool (0, 1))
+        {
+            t->notify();
+            --numToWake;
+        }
+    }
+}
+
+bool ThreadPool::hasQueuedJobs() const noexcept
+{
+    if (numInSharedQueue.get() > 0)
+        return true;
+
+    for (int i = threads.size(); --i >= 0;)
+        if (threads.getUnchecked(i)->deque.getNumQueued() > 0)
+            return true;
+
+    return false;
 }
 
 int ThreadPool::getNumJobs() const
@@ -161,7 +393,8 @@ bool ThreadPool::contains (const ThreadPoolJob* const job) const
 bool ThreadPool::isJobRunning (const ThreadPoolJob* const job) const
 {
     const ScopedLock sl (lock);
-    return jobs.contains (const_cast <ThreadPoolJob*> (job)) && job->isActive;
+    return jobs.contains (const_cast <ThreadPoolJob*> (job))
+            && job->ticket != nullptr && job->ticket->isClaimed();
 }
 
 bool ThreadPool::waitForJobToFinish (const ThreadPoolJob* const job,
@@ -183,6 +416,65 @@ bool ThreadPool::waitForJobToFinish (const ThreadPoolJob* const job,
     return true;
 }
 
+bool ThreadPool::waitForJobsToFinish (const Array<ThreadPoolJob*>& jobsToWaitFor, const int timeOutMs)
+{
+    const uint32 start = Time::getMillisecondCounter();
+    ThreadPoolThread* const currentThread = getCurrentPoolThread();
+    int numDone = 0;
+
+    for (;;)
+    {
+        {
+            const ScopedLock sl (lock);
+
+            while (numDone < jobsToWaitFor.size() && jobsToWaitFor.getUnchecked (numDone)->pool != this)
+                ++numDone;
+        }
+
+        if (numDone >= jobsToWaitFor.size())
+            return true;
+
+        if (timeOutMs >= 0 && Time::getMillisecondCounter() >= start + (uint32) timeOutMs)
+            return false;
+
+        if (! runNextJob (currentThread))
+            jobFinishedSignal.wait (2);
+    }
+}
+
+void ThreadPool::addToJobList (ThreadPoolJob* const job)
+{
+    job->ticket->indexInJobList = jobs.size();
+    jobs.add (job);
+}
+
+void ThreadPool::removeFromJobList (ThreadPoolJob* const job)
+{
+    // swaps the last job into the gap, so that removal doesn't depend on the number of jobs
+    const int index = job->ticket->indexInJobList;
+    jassert (jobs [index] == job);
+
+    ThreadPoolJob* const last = jobs.getLast();
+    jobs.set (index, last);
+    last->ticket->indexInJobList = index;
+    jobs.removeLast();
+
+    job->ticket = nullptr;
+}
+
+bool ThreadPool::removeIfNotStarted (ThreadPoolJob* const job, OwnedArray<ThreadPoolJob>& deletionList)
+{
+    // (must be called with the lock held)
+    if (job->ticket != nullptr && job->ticket->cancel())
+    {
+        removeFromJobList (job);
+        addToDeleteList (deletionList, job);
+        return true;
+    }
+
+    return false;
+}
+
 bool ThreadPool::removeJob (ThreadPoolJob* const job,
                             const bool interruptIfRunning,
                             const int timeOutMs)
@@ -196,18 +488,13 @@ bool ThreadPool::removeJob (ThreadPoolJob* const job,
 
         if (jobs.contains (job))
         {
-            if (job->isActive)
+            if (! removeIfNotStarted (job, deletionList))
             {
                 if (interruptIfRunning)
                     job->signalJobShouldExit();
 
                 dontWait = false;
             }
-            else
-            {
-                jobs.removeFirstMatchingValue (job);
-                addToDeleteList (deletionList, job);
-            }
         }
     }
 
@@ -231,18 +518,13 @@ bool ThreadPool::removeAllJobs (const bool interruptRunningJobs, const int timeO
 
                 if (selectedJobsToRemove == nullptr || selectedJobsToRemove->isJobSuitable (job))
                 {
-                    if (job->isActive)
+                    if (! removeIfNotStarted (job, deletionList))
                     {
                         jobsToWaitFor.add (job);
 
                         if (interruptRunningJobs)
                             job->signalJobShouldExit();
                     }
-                    else
-                    {
-                        jobs.remove (i);
-                        addToDeleteList (deletionList, job);
-                    }
                 }
             }
         }
@@ -298,76 +580,148 @@ bool ThreadPool::setThreadPriorities (const int newPriority)
     return ok;
 }
 
-ThreadPoolJob* ThreadPool::pickNextJobToRun()
+//==============================================================================
+ThreadPoolJobTicket* ThreadPool::popSharedQueue (ThreadPoolThread* const currentThread)
 {
-    OwnedArray<ThreadPoolJob> deletionList;
+    if (numInSharedQueue.get() <= 0)
+        return nullptr;
+
+    const SpinLock::ScopedLockType sl (sharedQueueLock);
+    const int numQueued = sharedQueue.size() - sharedQueueStart;
+
+    if (numQueued <= 0)
+        return nullptr;
 
+    ThreadPoolJobTicket* const result = sharedQueue.getUnchecked (sharedQueueStart++);
+    int numTaken = 1;
+
+    // A pool thread takes a fair share of the backlog onto its own queue, so that the
+    // others can steal from it instead of all queueing up for this lock.
+    if (currentThread != nullptr)
     {
-        const ScopedLock sl (lock);
+        const int batchSize = jmin (32, (numQueued - 1) / threads.size());
 
-        for (int i = 0; i < jobs.size(); ++i)
+        for (int i = 0; i < batchSize && currentThread->deque.push (sharedQueue.getUnchecked (sharedQueueStart)); ++i)
         {
-            ThreadPoolJob* job = jobs[i];
+            ++sharedQueueStart;
+            ++numTaken;
+        }
+    }
 
-            if (job != nullptr && ! job->isActive)
-            {
-                if (job->shouldStop)
-                {
-                    jobs.remove (i);
-                    addToDeleteList (deletionList, job);
-                    --i;
-                    continue;
-                }
+    numInSharedQueue -= numTaken;
 
-                job->isActive = true;
-                return job;
-            }
-        }
+    if (sharedQueueStart >= sharedQueue.size())
+    {
+        sharedQueue.clearQuick();
+        sharedQueueStart = 0;
+    }
+    else if (sharedQueueStart > 1024 && sharedQueueStart > sharedQueue.size() / 2)
+    {
+        sharedQueue.removeRange (0, sharedQueueStart);
+        sharedQueueStart = 0;
+    }
+
+    return result;
+}
+
+ThreadPoolJobTicket* ThreadPool::stealJob (ThreadPoolThread* const currentThread)
+{
+    const int numThreads = threads.size();
+    const int startIndex = currentThread != nullptr ? threads.indexOf (currentThread) + 1 : 0;
+
+    for (int i = 0; i < numThreads; ++i)
+    {
+        ThreadPoolThread* const victim = threads.getUnchecked ((startIndex + i) % numThreads);
+
+        if (victim != currentThread)
+            if (ThreadPoolJobTicket* const t = victim->deque.steal())
+                return t;
     }
 
     return nullptr;
 }
 
-bool ThreadPool::runNextJob()
+bool ThreadPool::runNextJob (ThreadPoolThread* const currentThread)
 {
-    ThreadPoolJob* const job = pickNextJobToRun();
+    ThreadPoolJobTicket* t = currentThread != nullptr ? currentThread->deque.pop() : nullptr;
+
+    if (t == nullptr)
+        t = popSharedQueue (currentThread);
 
-    if (job == nullptr)
+    if (t == nullptr)
+        t = stealJob (currentThread);
+
+    if (t == nullptr)
         return false;
 
+    // if we took a batch from the shared queue, let any idle threads steal from it
+    if (currentThread != nullptr && currentThread->deque.getNumQueued() > 0)
+        wakeThreads (1);
+
+    runTicket (t);
+    return true;
+}
+
+void ThreadPool::runTicket (ThreadPoolJobTicket* const t)
+{
+    if (! t->claim())
+    {
+        // the job was removed while this was queued
+        delete t;
+        return;
+    }
+
+    ThreadPoolJob* const job = t->job;
+    job->isActive = true;
+
     ThreadPoolJob::JobStatus result = ThreadPoolJob::jobHasFinished;
 
-    JUCE_TRY
+    if (! job->shouldStop)
     {
-        result = job->runJob();
+        JUCE_TRY
+        {
+            JUCE_TRACE_SCOPE ("ThreadPoolJob::runJob");
+            result = job->runJob();
+        }
+        JUCE_CATCH_ALL_ASSERT
     }
-    JUCE_CATCH_ALL_ASSERT
 
-    OwnedArray<ThreadPoolJob> deletionList;
+    bool runAgain = false;
 
     {
-        const ScopedLock sl (lock);
+        OwnedArray<ThreadPoolJob> deletionList;
 
-        if (jobs.contains (job))
         {
+            const ScopedLock sl (lock);
             job->isActive = false;
 
-            if (result != ThreadPoolJob::jobNeedsRunningAgain || job->shouldStop)
+            if (result == ThreadPoolJob::jobNeedsRunningAgain && ! job->shouldStop)
             {
-                jobs.removeFirstMatchingValue (job);
-                addToDeleteList (deletionList, job);
-
-                jobFinishedSignal.signal();
+                t->requeue();
+                runAgain = true;
             }
             else
             {
-                // move the job to the end of the queue if it wants another go
-                jobs.move (jobs.indexOf (job), -1);
+                removeFromJobList (job);
+                delete t;
+                addToDeleteList (deletionList, job);
+
+                jobFinishedSignal.signal();
             }
         }
     }
 
-    return true;
+    if (runAgain)
+    {
+        // move the job to the end of the shared queue, so everything else gets a go first
+        {
+            const SpinLock::ScopedLockType sl (sharedQueueLock);
+            sharedQueue.add (t);
+            ++numInSharedQueue;
+        }
+
+        wakeThreads (1);
+    }
 }
 
 void ThreadPool::addToDeleteList (OwnedArray<ThreadPoolJob>& deletionList, ThreadPoolJob* const job) const
@@ -378,3 +732,90 @@ void ThreadPool::addToDeleteList (OwnedArray<ThreadPoolJob>& deletionList, Threa
     if (job->shouldBeDeleted)
         deletionList.add (job);
 }
+
+//==============================================================================
+class ThreadPool::ParallelForJob  : public ThreadPoolJob
+{
+public:
+    struct Range  : public ReferenceCountedObject
+    {
+        Range (ParallelForBody& b, int start, int end_, int grain_)
+            : body (b), next (start), end (end_), grain (grain_),
+              numChunksLeft ((end_ - start + grain_ - 1) / grain_)
+        {
+        }
+
+        /** Claims and processes the next chunk. Returns false if there are none left. */
+        bool processNextChunk()
+        {
+            const int chunkStart = (next += grain) - grain;
+
+            if (chunkStart >= end)
+                return false;
+
+            body.processRange (chunkStart, jmin (end, chunkStart + grain));
+
+            if (--numChunksLeft == 0)
+                finished.signal();
+
+            return true;
+        }
+
+        ParallelForBody& body;
+        Atomic<int> next;
+        const int end, grain;
+        Atomic<int> numChunksLeft;
+        WaitableEvent finished;
+    };
+
+    ParallelForJob (Range* r)  : ThreadPoolJob ("parallelFor"), range (r) {}
+
+    JobStatus runJob()
+    {
+        while (! shouldExit() && range->processNextChunk())
+        {}
+
+        return jobHasFinished;
+    }
+
+private:
+    const ReferenceCountedObjectPtr<Range> range;
+
+    JUCE_DECLARE_NON_COPYABLE (ParallelForJob)
+};
+
+void ThreadPool::parallelFor (const int startIndex, const int endIndex, ParallelForBody& body, int grainSize)
+{
+    const int numItems = endIndex - startIndex;
+
+    if (numItems <= 0)
+        return;
+
+    if (grainSize <= 0)
+        grainSize = jmax (1, numItems / (threads.size() * 8));
+
+    const int numChunks = (numItems + grainSize - 1) / grainSize;
+
+    if (numChunks <= 1)
+    {
+        body.processRange (startIndex, endIndex);
+        return;
+    }
+
+    const ReferenceCountedObjectPtr<ParallelForJob::Range> range (new ParallelForJob::Range (body, startIndex, endIndex, grainSize));
+
+    // The helper jobs share ownership of the range, so any that only get to start
+    // after all the work's been done can still safely find that out.
+    Array<ThreadPoolJob*> helpers;
+
+    for (int i = jmin (threads.size(), numChunks - 1); --i >= 0;)
+        helpers.add (new ParallelForJob (range));
+
+    addJobs (helpers, true);
+
+    while (range->processNextChunk())
+    {}
+
+    if (range->numChunksLeft.get() > 0)
+        range->finished.wait (-1);
+}
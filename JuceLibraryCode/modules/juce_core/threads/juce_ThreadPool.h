@@ -35,6 +35,7 @@
 #include "../containers/juce_OwnedArray.h"
 class ThreadPool;
 class ThreadPoolThread;
+class ThreadPoolJobTicket;
 
 
 //==============================================================================
@@ -129,6 +130,7 @@ private:
     friend class ThreadPoolThread;
     String jobName;
     ThreadPool* pool;
+    ThreadPoolJobTicket* ticket;
     bool shouldStop, isActive, shouldBeDeleted;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThreadPoolJob)
@@ -142,6 +144,12 @@ private:
     When a ThreadPoolJob object is added to the ThreadPool's list, its runJob() method
     will be called by the next pooled thread that becomes free.
 
+    Each thread has its own lock-free queue of jobs. Jobs added by code that's running on
+    one of the pool's threads go onto that thread's queue, and jobs added from elsewhere go
+    onto a shared queue, from which idle threads take them in small batches. A thread whose
+    own queue is empty steals from the others, and threads with nothing to do sleep until
+    they're woken by a new job, rather than polling.
+
     @see ThreadPoolJob, Thread
 */
 class JUCE_API  ThreadPool
@@ -208,6 +216,16 @@ public:
     void addJob (ThreadPoolJob* job,
                  bool deleteJobWhenFinished);
 
+    /** Adds a set of jobs to the queue in one go.
+
+        This behaves like calling addJob() for each of the jobs, but is more efficient
+        when there are a lot of them.
+
+        @see waitForJobsToFinish
+    */
+    void addJobs (const Array<ThreadPoolJob*>& jobsToAdd,
+                  bool deleteJobsWhenFinished);
+
     /** Tries to remove a job from the pool.
 
         If the job isn't yet running, this will simply remove it. If it is running, it
@@ -252,6 +270,7 @@ public:
 
         Note that this can be a very volatile list as jobs might be continuously getting shifted
         around in the list, and this method may return 0 if the index is currently out-of-range.
+        The order of the list doesn't reflect the order in which the jobs will be run.
     */
     ThreadPoolJob* getJob (int index) const;
 
@@ -276,6 +295,56 @@ public:
     bool waitForJobToFinish (const ThreadPoolJob* job,
                              int timeOutMilliseconds) const;
 
+    /** Waits until all of a set of jobs have finished running and been removed from the pool.
+
+        Rather than just blocking, the calling thread helps out by running any queued jobs
+        (not necessarily ones from this set) while it waits, so this can safely be called
+        from inside a job that's running on the same pool. Don't call it from a thread that
+        mustn't be held up by running other jobs, such as an audio callback.
+
+        The jobs must still exist when this is called, so it can't be used on jobs that
+        were added with deleteJobWhenFinished set to true.
+
+        If the timeout period expires before the jobs finish, this will return false;
+        it returns true if they all finished.
+    */
+    bool waitForJobsToFinish (const Array<ThreadPoolJob*>& jobsToWaitFor,
+                              int timeOutMilliseconds);
+
+    //==============================================================================
+    /** A callback used by parallelFor().
+        @see ThreadPool::parallelFor
+    */
+    class JUCE_API  ParallelForBody
+    {
+    public:
+        virtual ~ParallelForBody() {}
+
+        /** Should process the items from startIndex up to (but not including) endIndex.
+            This will be called on several threads at once, with different ranges.
+        */
+        virtual void processRange (int startIndex, int endIndex) = 0;
+    };
+
+    /** Splits a range of indexes into chunks and processes them on the pool's threads,
+        returning when they're all done.
+
+        The calling thread works through chunks too, so this can safely be used from
+        inside a job that's running on the same pool.
+
+        @param startIndex   the first index to process
+        @param endIndex     the index after the last one to process
+        @param body         the callback that does the work
+        @param grainSize    the number of indexes to pass to each call to
+                            ParallelForBody::processRange(), or 0 to pick a size that
+                            gives each thread several chunks
+    */
+    void parallelFor (int startIndex, int endIndex,
+                      ParallelForBody& body, int grainSize = 0);
+
+    /** Returns the number of threads that the pool is running. */
+    int getNumThreads() const noexcept;
+
     /** Returns a list of the names of all the jobs currently running or queued.
         If onlyReturnActiveJobs is true, only the ones currently running are returned.
     */
@@ -294,6 +363,7 @@ private:
     Array <ThreadPoolJob*> jobs;
 
     class ThreadPoolThread;
+    class ParallelForJob;
     friend class ThreadPoolThread;
     friend class OwnedArray <ThreadPoolThread>;
     OwnedArray <ThreadPoolThread> threads;
@@ -301,8 +371,23 @@ private:
     CriticalSection lock;
     WaitableEvent jobFinishedSignal;
 
-    bool runNextJob();
-    ThreadPoolJob* pickNextJobToRun();
+    Array <ThreadPoolJobTicket*> sharedQueue;
+    int sharedQueueStart;
+    Atomic<int> numInSharedQueue;
+    SpinLock sharedQueueLock;
+
+    bool runNextJob (ThreadPoolThread* currentThread);
+    void runTicket (ThreadPoolJobTicket*);
+    ThreadPoolJobTicket* popSharedQueue (ThreadPoolThread* currentThread);
+    ThreadPoolJobTicket* stealJob (ThreadPoolThread* currentThread);
+    void queueTickets (ThreadPoolJobTicket* const* tickets, int numTickets);
+    void wakeThreads (int numToWake);
+    bool hasQueuedJobs() const noexcept;
+    ThreadPoolThread* getCurrentPoolThread() const;
+    bool removeIfNotStarted (ThreadPoolJob*, OwnedArray<ThreadPoolJob>&);
+    void addToJobList (ThreadPoolJob*);
+    void removeFromJobList (ThreadPoolJob*);
+    ThreadPoolJobTicket* prepareJob (ThreadPoolJob*, bool deleteJobWhenFinished);
     void addToDeleteList (OwnedArray<ThreadPoolJob>&, ThreadPoolJob*) const;
     void createThreads (int numThreads);
     void stopThreads();
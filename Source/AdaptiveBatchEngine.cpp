@@ -0,0 +1,307 @@
+/*
+  ==============================================================================
+
+    AdaptiveBatchEngine.cpp
+
+    Processes the adaptive mode of every participating instance in one pass.
+
+  ==============================================================================
+*/
+
+#include "AdaptiveBatchEngine.h"
+
+
+//==============================================================================
+namespace AdaptiveBatchHelpers
+{
+    // The states of a member's pending frame
+    enum { frameIdle = 0, framePending, frameBusy };
+
+    static Atomic<int> engineClaimed;      // set while a pass is running, or the members are changing
+    static Atomic<int> numMembers, numPending;
+    static Array<AdaptiveBatchEngine::Member*> members;
+    static Array<AdaptiveBatchEngine::Member*> batch;          // (preallocated for every member)
+    static Array<AdaptiveCentreExtractor::BatchItem> items;    // (preallocated for every member)
+
+    static bool tryToClaimEngine() noexcept     { return engineClaimed.compareAndSetBool (1, 0); }
+    static void releaseEngine() noexcept        { engineClaimed.set (0); }
+
+    // (this spins, so it's only for joining and leaving, which don't happen on the audio thread)
+    struct ScopedEngineClaim
+    {
+        ScopedEngineClaim()     { while (! tryToClaimEngine()) Thread::yield(); }
+        ~ScopedEngineClaim()    { releaseEngine(); }
+    };
+}
+
+//==============================================================================
+void AdaptiveBatchEngine::runPass()
+{
+    using namespace AdaptiveBatchHelpers;
+
+    // (the caller must have claimed the engine)
+    jassert (engineClaimed.get() != 0);
+
+    items.clearQuick();
+    batch.clearQuick();
+
+    for (int i = 0; i < members.size(); ++i)
+    {
+        Member& m = *members.getUnchecked (i);
+
+        if (m.state.compareAndSetBool (frameBusy, framePending))
+        {
+            items.add (m.getBatchItem());
+            batch.add (&m);
+        }
+    }
+
+    AdaptiveCentreExtractor::processBatch (items.getRawDataPointer(), items.size());
+
+    for (int i = 0; i < batch.size(); ++i)
+        batch.getUnchecked (i)->finishFrame();
+
+    numPending -= batch.size();
+}
+
+//==============================================================================
+AdaptiveBatchEngine::Member::Member()
+    : extractor (nullptr), frameA (1, 1), frameB (1, 1), pending (&frameA), ready (&frameB),
+      numInputs (0), frameSize (0), fillPosition (0), hasCentreOutput (false)
+{
+}
+
+AdaptiveBatchEngine::Member::~Member()
+{
+    release();
+}
+
+void AdaptiveBatchEngine::Member::prepare (AdaptiveCentreExtractor& extractor_, const int numInputs_,
+                                           const bool hasCentreOutput_, const int frameSize_)
+{
+    using namespace AdaptiveBatchHelpers;
+    release();
+
+    const ScopedEngineClaim claim;
+
+    extractor = &extractor_;
+    numInputs = jmax (1, numInputs_);
+    hasCentreOutput = hasCentreOutput_;
+    frameSize = frameSize_;
+    fillPosition = 0;
+
+    frameA.setSize (hasCentreOutput ? numInputs * 2 : numInputs, frameSize);
+    frameB.setSize (frameA.getNumChannels(), frameSize);
+    frameA.clear();
+    frameB.clear();
+    state.set (frameIdle);
+
+    members.add (this);
+    items.ensureStorageAllocated (members.size());
+    batch.ensureStorageAllocated (members.size());
+    numMembers.set (members.size());
+}
+
+void AdaptiveBatchEngine::Member::release()
+{
+    using namespace AdaptiveBatchHelpers;
+    const ScopedEngineClaim claim;
+
+    if (extractor == nullptr)
+        return;
+
+    if (state.get() == framePending)
+        --numPending;
+
+    members.removeFirstMatchingValue (this);
+    numMembers.set (members.size());
+    extractor = nullptr;
+    state.set (frameIdle);
+    frameSize = fillPosition = 0;
+    frameA.setSize (1, 1);
+    frameB.setSize (1, 1);
+}
+
+void AdaptiveBatchEngine::Member::reset()
+{
+    using namespace AdaptiveBatchHelpers;
+
+    if (extractor == nullptr)
+        return;
+
+    for (;;)
+    {
+        if (state.compareAndSetBool (frameBusy, framePending))
+        {
+            --numPending;
+            break;
+        }
+
+        if (state.compareAndSetBool (frameBusy, frameIdle))
+            break;
+
+        Thread::yield();    // (the frame is part of a pass that's running on another thread)
+    }
+
+    extractor->reset();
+    frameA.clear();
+    frameB.clear();
+    fillPosition = 0;
+    state.set (frameIdle);
+}
+
+//==============================================================================
+AdaptiveCentreExtractor::BatchItem AdaptiveBatchEngine::Member::getBatchItem() const noexcept
+{
+    AdaptiveCentreExtractor::BatchItem item;
+    item.extractor = extractor;
+    item.channels = pending->getArrayOfChannels();
+    item.centreChannels = hasCentreOutput ? pending->getArrayOfChannels() + numInputs : nullptr;
+    item.numSamples = frameSize;
+    return item;
+}
+
+void AdaptiveBatchEngine::Member::finishFrame() noexcept
+{
+    std::swap (pending, ready);
+    state.set (AdaptiveBatchHelpers::frameIdle);
+}
+
+void AdaptiveBatchEngine::Member::waitForPendingFrame()
+{
+    using namespace AdaptiveBatchHelpers;
+
+    if (tryToClaimEngine())
+    {
+        runPass();
+        releaseEngine();
+    }
+    else if (state.compareAndSetBool (frameBusy, framePending))
+    {
+        // Somebody else is running a pass that this frame isn't part of, so rather than
+        // waiting for them, it's processed on its own
+        AdaptiveCentreExtractor::BatchItem item (getBatchItem());
+        AdaptiveCentreExtractor::processBatch (&item, 1);
+
+        --numPending;
+        finishFrame();
+    }
+
+    // (if neither of those happened, the frame is part of a pass that's already running)
+    while (state.get() != frameIdle)
+        Thread::yield();
+}
+
+//==============================================================================
+void AdaptiveBatchEngine::Member::process (AudioSampleBuffer& block)
+{
+    using namespace AdaptiveBatchHelpers;
+
+    // must call prepare() first!
+    jassert (extractor != nullptr);
+
+    const int numSamples = block.getNumSamples();
+    const int numChannels = jmin (block.getNumChannels(), pending->getNumChannels());
+
+    for (int pos = 0; pos < numSamples;)
+    {
+        // Another frame from the same member means that somebody isn't taking part in
+        // this cycle, so there's no point waiting for them
+        if (state.get() != frameIdle)
+            waitForPendingFrame();
+
+        const int num = jmin (numSamples - pos, frameSize - fillPosition);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* const data = block.getSampleData (ch, pos);
+            FloatVectorOperations::copy (pending->getSampleData (ch, fillPosition), data, num);
+            FloatVectorOperations::copy (data, ready->getSampleData (ch, fillPosition), num);
+        }
+
+        pos += num;
+        fillPosition += num;
+
+        if (fillPosition == frameSize)
+        {
+            fillPosition = 0;
+            state.set (framePending);
+
+            // The last member to hand in its frame runs the pass, unless another thread is
+            // already running one, in which case the frame waits for the next
+            if (++numPending >= numMembers.get() && tryToClaimEngine())
+            {
+                runPass();
+                releaseEngine();
+            }
+        }
+    }
+}
+
+//==============================================================================
+bool AdaptiveBatchEngine::runBlockSizeCheck (String& report)
+{
+    const int frameSize = 256, numFrames = 64, numSamples = frameSize * numFrames;
+    const double sampleRate = 44100.0;
+
+    ChannelPairEngine layout;
+    layout.setLayout (2, String::empty);
+
+    AudioSampleBuffer input (2, numSamples);
+    Random random (1234);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float centre = (float) std::sin (i * 0.031) * 0.5f;
+        *input.getSampleData (0, i) = centre + (random.nextFloat() - 0.5f) * 0.2f;
+        *input.getSampleData (1, i) = centre + (random.nextFloat() - 0.5f) * 0.2f;
+    }
+
+    // The reference runs the extractor directly, a frame at a time
+    AdaptiveCentreExtractor direct;
+    direct.prepare (layout, sampleRate);
+
+    AudioSampleBuffer expected (input);
+
+    for (int pos = 0; pos < numSamples; pos += frameSize)
+    {
+        AudioSampleBuffer frame (expected.getArrayOfChannels(), 2, pos, frameSize);
+        direct.process (frame);
+    }
+
+    // ..and the member is given blocks that are sometimes shorter than a frame,
+    // as a host can send fewer samples than it announced
+    AdaptiveCentreExtractor batched;
+    batched.prepare (layout, sampleRate);
+
+    Member member;
+    member.prepare (batched, 2, false, frameSize);
+
+    AudioSampleBuffer output (input);
+    static const int blockSizes[] = { 256, 256, 100, 256, 156, 1, 255, 512, 37 };
+    int numDiffering = 0;
+
+    for (int pos = 0, i = 0; pos < numSamples; ++i)
+    {
+        const int num = jmin (blockSizes [i % numElementsInArray (blockSizes)], numSamples - pos);
+        AudioSampleBuffer block (output.getArrayOfChannels(), 2, pos, num);
+        member.process (block);
+        pos += num;
+    }
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        const float* const actual = output.getSampleData (ch);
+        const float* const wanted = expected.getSampleData (ch);
+
+        for (int i = 0; i < numSamples; ++i)
+            if (actual[i] != (i < frameSize ? 0.0f : wanted [i - frameSize]))
+                ++numDiffering;
+    }
+
+    member.release();
+
+    report << "Batch engine with uneven blocks: " << numDiffering << " of " << numSamples * 2
+           << " samples differ from the direct output" << newLine;
+    return numDiffering == 0;
+}
@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    AdaptiveBatchEngine.h
+
+    Processes the adaptive mode of every participating instance in one pass.
+
+  ==============================================================================
+*/
+
+#ifndef __ADAPTIVEBATCHENGINE_H_58C0B3E1__
+#define __ADAPTIVEBATCHENGINE_H_58C0B3E1__
+
+#include "AdaptiveCentreExtractor.h"
+
+
+//==============================================================================
+/**
+    A process-wide engine that runs the AdaptiveCentreExtractors of many plugin
+    instances together, so that their pairs can share the SSE lanes.
+
+    Each instance that opts in owns a Member. Every frame, the member hands its
+    input to the engine and gets back the output of its previous frame. Once
+    every member has handed in a frame, whichever instance is the last to do so
+    runs AdaptiveCentreExtractor::processBatch() over all of them. If a member
+    hands in a second frame before that has happened (because the host isn't
+    calling some other instance, for example), the pass is run at that point for
+    whoever is waiting, so nobody is ever held up.
+
+    The output is bit-for-bit what each instance would have produced on its own,
+    delayed by one frame. Handing frames in doesn't take a lock: each member
+    publishes the state of its frame atomically, and a pass is only run by a thread
+    that manages to claim the engine. A member that needs its frame processed while
+    another thread holds the engine processes that frame on its own instead. The
+    only wait is when a member's previous frame is part of a pass that's already
+    running, and then only until that pass is done.
+
+    A member's frames don't have to line up with the blocks it's given: a host
+    that sends fewer samples than it announced just leaves the member part of the
+    way through a frame, and the delay stays at exactly one frame.
+*/
+class AdaptiveBatchEngine
+{
+public:
+    //==============================================================================
+    /** One instance's place in the engine. */
+    class Member
+    {
+    public:
+        //==============================================================================
+        Member();
+
+        /** Destructor, which leaves the engine. */
+        ~Member();
+
+        //==============================================================================
+        /** Joins the engine, and allocates space for two frames.
+
+            @param extractor        the instance's extractor, which must have been prepared.
+                                    While it's a member, the engine may run it on any
+                                    instance's audio thread, so use reset() here rather
+                                    than calling it directly.
+            @param numInputs        the number of channels in the extractor's layout
+            @param hasCentreOutput  if true, the frames have numInputs more channels, which
+                                    get the centre that was taken out of the first ones
+            @param frameSize        the number of samples in every frame
+        */
+        void prepare (AdaptiveCentreExtractor& extractor, int numInputs, bool hasCentreOutput, int frameSize);
+
+        /** Leaves the engine, and frees the frames. */
+        void release();
+
+        /** Clears the extractor and the frame that's in progress. */
+        void reset();
+
+        /** Returns true if prepare() has been called since the last release(). */
+        bool isActive() const noexcept                      { return extractor != nullptr; }
+
+        /** Returns the extra delay that the engine adds, which is one frame. */
+        int getLatencySamples() const noexcept              { return frameSize; }
+
+        //==============================================================================
+        /** Hands in a block of any length, and replaces it with the output from one
+            frame earlier. A frame is handed to the engine each time one fills up.
+        */
+        void process (AudioSampleBuffer& block);
+
+    private:
+        //==============================================================================
+        friend class AdaptiveBatchEngine;
+
+        AdaptiveCentreExtractor* extractor;
+        AudioSampleBuffer frameA, frameB;
+        AudioSampleBuffer* pending;         // the frame that's waiting for the next pass
+        AudioSampleBuffer* ready;           // the output of the last pass
+        Atomic<int> state;                  // frameIdle, framePending or frameBusy (see AdaptiveBatchHelpers)
+        int numInputs, frameSize;
+        int fillPosition;                   // how much of the pending frame has been filled
+        bool hasCentreOutput;
+
+        AdaptiveCentreExtractor::BatchItem getBatchItem() const noexcept;
+        void finishFrame() noexcept;
+        void waitForPendingFrame();
+
+        JUCE_DECLARE_NON_COPYABLE (Member)
+    };
+
+    //==============================================================================
+    /** Feeds a member blocks of uneven lengths, some shorter than a frame, and checks
+        that its output is the same as an extractor's that's run directly.
+        Returns true if it is, and appends a line about the result to the report.
+    */
+    static bool runBlockSizeCheck (String& report);
+
+private:
+    AdaptiveBatchEngine();
+    static void runPass();
+};
+
+
+#endif  // __ADAPTIVEBATCHENGINE_H_58C0B3E1__
@@ -0,0 +1,539 @@
+/*
+  ==============================================================================
+
+    AdaptiveCentreExtractor.cpp
+
+    Removes the correlated centre from each channel pair, band by band, without
+    adding any latency.
+
+  ==============================================================================
+*/
+
+#include "AdaptiveCentreExtractor.h"
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+#if JUCE_GCC && ! JUCE_CLANG
+ // When FMA is enabled, GCC would fuse the multiplies and adds differently in processPair()
+ // and processLanes(), and batches would no longer match instances processed on their own
+ #pragma GCC optimize ("fp-contract=off")
+#endif
+
+
+//==============================================================================
+namespace AdaptiveCentreHelpers
+{
+    // The edges between the bands, which put most of the voice in the middle two
+    static const double crossoverFrequencies[] = { 250.0, 1500.0, 6000.0 };
+
+    // The time constant of the covariance estimates
+    static const double smoothingTimeSeconds = 0.03;
+
+    // Keeps the estimate finite when a band is silent, or when L and R are identical
+    static const float relativeNoiseFloor = 1.0e-6f;
+    static const float absoluteNoiseFloor = 1.0e-15f;
+   #if JUCE_INTEL
+
+    //==============================================================================
+    /** The state of four pairs, one per lane, while a batch is being processed. */
+    struct LaneState
+    {
+        __m128 a1[3], a2[3], a3[3], alpha;
+        __m128 leftFilter1[3], leftFilter2[3], rightFilter1[3], rightFilter2[3];
+        __m128 leftPower[4], rightPower[4], crossPower[4];
+    };
+
+    static inline __m128 gatherLanes (const float* a, const float* b, const float* c, const float* d, const int index) noexcept
+    {
+        return _mm_set_ps (d[index], c[index], b[index], a[index]);
+    }
+
+    static inline void scatterLanes (const __m128 v, float* a, float* b, float* c, float* d, const int index) noexcept
+    {
+        float lanes[4];
+        _mm_storeu_ps (lanes, v);
+        a[index] = lanes[0];
+        b[index] = lanes[1];
+        c[index] = lanes[2];
+        d[index] = lanes[3];
+    }
+
+    /*  One sample of four pairs, returning the centre of each. This does exactly the
+        same arithmetic, in the same order, as AdaptiveCentreExtractor::processPair(),
+        so that the results are identical; only the lanes hold pairs instead of bands.
+    */
+    static inline __m128 processLaneSample (LaneState& s, const __m128 x, const __m128 y) noexcept
+    {
+        const __m128 two = _mm_set1_ps (2.0f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 relativeFloor = _mm_set1_ps (relativeNoiseFloor);
+        const __m128 absoluteFloor = _mm_set1_ps (absoluteNoiseFloor);
+
+        __m128 leftLow[4], rightLow[4];
+
+        for (int b = 0; b < 3; ++b)
+        {
+            __m128 v3 = _mm_sub_ps (x, s.leftFilter2[b]);
+            __m128 v1 = _mm_add_ps (_mm_mul_ps (s.a1[b], s.leftFilter1[b]), _mm_mul_ps (s.a2[b], v3));
+            __m128 v2 = _mm_add_ps (s.leftFilter2[b], _mm_add_ps (_mm_mul_ps (s.a2[b], s.leftFilter1[b]), _mm_mul_ps (s.a3[b], v3)));
+            s.leftFilter1[b] = _mm_sub_ps (_mm_mul_ps (two, v1), s.leftFilter1[b]);
+            s.leftFilter2[b] = _mm_sub_ps (_mm_mul_ps (two, v2), s.leftFilter2[b]);
+            leftLow[b] = v2;
+
+            v3 = _mm_sub_ps (y, s.rightFilter2[b]);
+            v1 = _mm_add_ps (_mm_mul_ps (s.a1[b], s.rightFilter1[b]), _mm_mul_ps (s.a2[b], v3));
+            v2 = _mm_add_ps (s.rightFilter2[b], _mm_add_ps (_mm_mul_ps (s.a2[b], s.rightFilter1[b]), _mm_mul_ps (s.a3[b], v3)));
+            s.rightFilter1[b] = _mm_sub_ps (_mm_mul_ps (two, v1), s.rightFilter1[b]);
+            s.rightFilter2[b] = _mm_sub_ps (_mm_mul_ps (two, v2), s.rightFilter2[b]);
+            rightLow[b] = v2;
+        }
+
+        leftLow[3] = x;
+        rightLow[3] = y;
+
+        __m128 centre[4];
+
+        for (int b = 0; b < 4; ++b)
+        {
+            const __m128 l = b > 0 ? _mm_sub_ps (leftLow[b],  leftLow [b - 1])  : leftLow[b];
+            const __m128 r = b > 0 ? _mm_sub_ps (rightLow[b], rightLow [b - 1]) : rightLow[b];
+
+            s.leftPower[b]  = _mm_add_ps (s.leftPower[b],  _mm_mul_ps (s.alpha, _mm_sub_ps (_mm_mul_ps (l, l), s.leftPower[b])));
+            s.rightPower[b] = _mm_add_ps (s.rightPower[b], _mm_mul_ps (s.alpha, _mm_sub_ps (_mm_mul_ps (r, r), s.rightPower[b])));
+            s.crossPower[b] = _mm_add_ps (s.crossPower[b], _mm_mul_ps (s.alpha, _mm_sub_ps (_mm_mul_ps (l, r), s.crossPower[b])));
+
+            const __m128 shared = _mm_max_ps (zero, _mm_min_ps (s.crossPower[b], _mm_min_ps (s.leftPower[b], s.rightPower[b])));
+            const __m128 noiseFloor = _mm_add_ps (absoluteFloor, _mm_mul_ps (relativeFloor, _mm_add_ps (s.leftPower[b], s.rightPower[b])));
+            const __m128 leftNoise  = _mm_add_ps (_mm_sub_ps (s.leftPower[b], shared), noiseFloor);
+            const __m128 rightNoise = _mm_add_ps (_mm_sub_ps (s.rightPower[b], shared), noiseFloor);
+
+            const __m128 scale = _mm_div_ps (shared, _mm_add_ps (_mm_mul_ps (shared, _mm_add_ps (leftNoise, rightNoise)),
+                                                                _mm_mul_ps (leftNoise, rightNoise)));
+            centre[b] = _mm_mul_ps (scale, _mm_add_ps (_mm_mul_ps (rightNoise, l), _mm_mul_ps (leftNoise, r)));
+        }
+
+        // (summed in the same order as the horizontal add in processPair())
+        return _mm_add_ps (_mm_add_ps (centre[0], centre[2]), _mm_add_ps (centre[1], centre[3]));
+    }
+   #endif
+}
+
+//==============================================================================
+AdaptiveCentreExtractor::AdaptiveCentreExtractor()
+    : numChannels (0), numPairs (0), centreChannel (-1), smoothing (0)
+{
+    zeromem (filterA1, sizeof (filterA1));
+    zeromem (filterA2, sizeof (filterA2));
+    zeromem (filterA3, sizeof (filterA3));
+    reset();
+}
+
+AdaptiveCentreExtractor::~AdaptiveCentreExtractor()
+{
+}
+
+//==============================================================================
+void AdaptiveCentreExtractor::prepare (const ChannelPairEngine& layout, const double sampleRate)
+{
+    numChannels = layout.getNumChannels();
+    numPairs = jmin ((int) maxPairs, layout.getNumPairs());
+    centreChannel = layout.getCentreChannel();
+
+    for (int i = 0; i < numPairs; ++i)
+    {
+        leftChannels[i] = layout.getLeftChannel (i);
+        rightChannels[i] = layout.getRightChannel (i);
+    }
+
+    // Butterworth lowpasses, as topology-preserving state-variable filters. The top band's
+    // coefficients stay at zero, which leaves its state at zero too.
+    for (int b = 0; b < numBands - 1; ++b)
+    {
+        const double frequency = jmin (AdaptiveCentreHelpers::crossoverFrequencies[b], sampleRate * 0.45);
+        const double g = std::tan (double_Pi * frequency / sampleRate);
+        const double a1 = 1.0 / (1.0 + g * (g + std::sqrt (2.0)));
+
+        filterA1[b] = (float) a1;
+        filterA2[b] = (float) (g * a1);
+        filterA3[b] = (float) (g * g * a1);
+    }
+
+    smoothing = (float) (1.0 - std::exp (-1.0 / (AdaptiveCentreHelpers::smoothingTimeSeconds * sampleRate)));
+
+    reset();
+}
+
+void AdaptiveCentreExtractor::reset() noexcept
+{
+    zeromem (states, sizeof (states));
+}
+
+bool AdaptiveCentreExtractor::isQuiescent() const noexcept
+{
+    const float* const values = reinterpret_cast<const float*> (states);
+
+    for (size_t i = 0; i < (size_t) numPairs * sizeof (PairState) / sizeof (float); ++i)
+        if (values[i] != 0)
+            return false;
+
+    return true;
+}
+
+//==============================================================================
+void AdaptiveCentreExtractor::process (AudioSampleBuffer& buffer) noexcept
+{
+    const int numSamples = buffer.getNumSamples();
+
+    for (int p = 0; p < numPairs; ++p)
+        if (leftChannels[p] < buffer.getNumChannels() && rightChannels[p] < buffer.getNumChannels())
+            processPair (states[p], buffer.getSampleData (leftChannels[p]), buffer.getSampleData (rightChannels[p]),
+                         nullptr, nullptr, numSamples);
+
+    if (isPositiveAndBelow (centreChannel, buffer.getNumChannels()))
+        buffer.clear (centreChannel, 0, numSamples);
+}
+
+void AdaptiveCentreExtractor::process (AudioSampleBuffer& buffer, AudioSampleBuffer& centreOutput) noexcept
+{
+    jassert (centreOutput.getNumChannels() >= jmin (numChannels, buffer.getNumChannels()));
+
+    const int numSamples = buffer.getNumSamples();
+    const int numBufferChannels = jmin (buffer.getNumChannels(), centreOutput.getNumChannels());
+
+    for (int ch = 0; ch < numBufferChannels; ++ch)
+        centreOutput.clear (ch, 0, numSamples);
+
+    for (int p = 0; p < numPairs; ++p)
+        if (leftChannels[p] < numBufferChannels && rightChannels[p] < numBufferChannels)
+            processPair (states[p], buffer.getSampleData (leftChannels[p]), buffer.getSampleData (rightChannels[p]),
+                         centreOutput.getSampleData (leftChannels[p]), centreOutput.getSampleData (rightChannels[p]),
+                         numSamples);
+
+    if (isPositiveAndBelow (centreChannel, numBufferChannels))
+    {
+        centreOutput.copyFrom (centreChannel, 0, buffer, centreChannel, 0, numSamples);
+        buffer.clear (centreChannel, 0, numSamples);
+    }
+}
+
+//==============================================================================
+struct AdaptiveCentreExtractor::LaneJob
+{
+    AdaptiveCentreExtractor* owner;
+    PairState* state;
+    float* left;
+    float* right;
+    float* centreLeft;
+    float* centreRight;
+};
+
+void AdaptiveCentreExtractor::processBatch (const BatchItem* const items, const int numItems) noexcept
+{
+    LaneJob jobs [4];
+    int numJobs = 0, jobSamples = 0;
+
+    for (int n = 0; n < numItems; ++n)
+    {
+        const BatchItem& item = items[n];
+        AdaptiveCentreExtractor& e = *item.extractor;
+
+        if (item.centreChannels != nullptr)
+        {
+            for (int ch = 0; ch < e.numChannels; ++ch)
+                FloatVectorOperations::clear (item.centreChannels[ch], item.numSamples);
+
+            if (e.centreChannel >= 0)
+                FloatVectorOperations::copy (item.centreChannels [e.centreChannel], item.channels [e.centreChannel], item.numSamples);
+        }
+
+        if (e.centreChannel >= 0)
+            FloatVectorOperations::clear (item.channels [e.centreChannel], item.numSamples);
+
+        for (int p = 0; p < e.numPairs; ++p)
+        {
+            if (numJobs > 0 && jobSamples != item.numSamples)
+            {
+                // (lanes can only be shared by blocks of the same length)
+                for (int i = 0; i < numJobs; ++i)
+                    jobs[i].owner->processPair (*jobs[i].state, jobs[i].left, jobs[i].right,
+                                                jobs[i].centreLeft, jobs[i].centreRight, jobSamples);
+                numJobs = 0;
+            }
+
+            LaneJob& job = jobs [numJobs++];
+            job.owner = &e;
+            job.state = e.states + p;
+            job.left  = item.channels [e.leftChannels[p]];
+            job.right = item.channels [e.rightChannels[p]];
+            job.centreLeft  = item.centreChannels != nullptr ? item.centreChannels [e.leftChannels[p]]  : nullptr;
+            job.centreRight = item.centreChannels != nullptr ? item.centreChannels [e.rightChannels[p]] : nullptr;
+            jobSamples = item.numSamples;
+
+            if (numJobs == 4)
+            {
+                processLanes (jobs, jobSamples);
+                numJobs = 0;
+            }
+        }
+    }
+
+    for (int i = 0; i < numJobs; ++i)
+        jobs[i].owner->processPair (*jobs[i].state, jobs[i].left, jobs[i].right,
+                                    jobs[i].centreLeft, jobs[i].centreRight, jobSamples);
+}
+
+void AdaptiveCentreExtractor::processLanes (const LaneJob* const jobs, const int numSamples) noexcept
+{
+   #if JUCE_INTEL
+    using namespace AdaptiveCentreHelpers;
+
+    PairState& s0 = *jobs[0].state;
+    PairState& s1 = *jobs[1].state;
+    PairState& s2 = *jobs[2].state;
+    PairState& s3 = *jobs[3].state;
+
+    LaneState s;
+
+    for (int b = 0; b < 3; ++b)
+    {
+        s.a1[b] = gatherLanes (jobs[0].owner->filterA1, jobs[1].owner->filterA1, jobs[2].owner->filterA1, jobs[3].owner->filterA1, b);
+        s.a2[b] = gatherLanes (jobs[0].owner->filterA2, jobs[1].owner->filterA2, jobs[2].owner->filterA2, jobs[3].owner->filterA2, b);
+        s.a3[b] = gatherLanes (jobs[0].owner->filterA3, jobs[1].owner->filterA3, jobs[2].owner->filterA3, jobs[3].owner->filterA3, b);
+
+        s.leftFilter1[b]  = gatherLanes (s0.leftFilter1,  s1.leftFilter1,  s2.leftFilter1,  s3.leftFilter1,  b);
+        s.leftFilter2[b]  = gatherLanes (s0.leftFilter2,  s1.leftFilter2,  s2.leftFilter2,  s3.leftFilter2,  b);
+        s.rightFilter1[b] = gatherLanes (s0.rightFilter1, s1.rightFilter1, s2.rightFilter1, s3.rightFilter1, b);
+        s.rightFilter2[b] = gatherLanes (s0.rightFilter2, s1.rightFilter2, s2.rightFilter2, s3.rightFilter2, b);
+    }
+
+    for (int b = 0; b < numBands; ++b)
+    {
+        s.leftPower[b]  = gatherLanes (s0.leftPower,  s1.leftPower,  s2.leftPower,  s3.leftPower,  b);
+        s.rightPower[b] = gatherLanes (s0.rightPower, s1.rightPower, s2.rightPower, s3.rightPower, b);
+        s.crossPower[b] = gatherLanes (s0.crossPower, s1.crossPower, s2.crossPower, s3.crossPower, b);
+    }
+
+    s.alpha = _mm_set_ps (jobs[3].owner->smoothing, jobs[2].owner->smoothing,
+                          jobs[1].owner->smoothing, jobs[0].owner->smoothing);
+
+    int i = 0;
+
+    // Four samples of each pair at a time, transposed so that each vector holds one
+    // sample of all four pairs
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        __m128 x0 = _mm_loadu_ps (jobs[0].left + i),  x1 = _mm_loadu_ps (jobs[1].left + i);
+        __m128 x2 = _mm_loadu_ps (jobs[2].left + i),  x3 = _mm_loadu_ps (jobs[3].left + i);
+        __m128 y0 = _mm_loadu_ps (jobs[0].right + i), y1 = _mm_loadu_ps (jobs[1].right + i);
+        __m128 y2 = _mm_loadu_ps (jobs[2].right + i), y3 = _mm_loadu_ps (jobs[3].right + i);
+        _MM_TRANSPOSE4_PS (x0, x1, x2, x3);
+        _MM_TRANSPOSE4_PS (y0, y1, y2, y3);
+
+        __m128 c0 = processLaneSample (s, x0, y0);
+        __m128 c1 = processLaneSample (s, x1, y1);
+        __m128 c2 = processLaneSample (s, x2, y2);
+        __m128 c3 = processLaneSample (s, x3, y3);
+
+        x0 = _mm_sub_ps (x0, c0);  x1 = _mm_sub_ps (x1, c1);  x2 = _mm_sub_ps (x2, c2);  x3 = _mm_sub_ps (x3, c3);
+        y0 = _mm_sub_ps (y0, c0);  y1 = _mm_sub_ps (y1, c1);  y2 = _mm_sub_ps (y2, c2);  y3 = _mm_sub_ps (y3, c3);
+        _MM_TRANSPOSE4_PS (x0, x1, x2, x3);
+        _MM_TRANSPOSE4_PS (y0, y1, y2, y3);
+        _MM_TRANSPOSE4_PS (c0, c1, c2, c3);
+
+        _mm_storeu_ps (jobs[0].left + i, x0);   _mm_storeu_ps (jobs[0].right + i, y0);
+        _mm_storeu_ps (jobs[1].left + i, x1);   _mm_storeu_ps (jobs[1].right + i, y1);
+        _mm_storeu_ps (jobs[2].left + i, x2);   _mm_storeu_ps (jobs[2].right + i, y2);
+        _mm_storeu_ps (jobs[3].left + i, x3);   _mm_storeu_ps (jobs[3].right + i, y3);
+
+        const __m128 centres[] = { c0, c1, c2, c3 };
+
+        for (int j = 0; j < 4; ++j)
+        {
+            if (jobs[j].centreLeft != nullptr)
+            {
+                _mm_storeu_ps (jobs[j].centreLeft + i, centres[j]);
+                _mm_storeu_ps (jobs[j].centreRight + i, centres[j]);
+            }
+        }
+    }
+
+    for (; i < numSamples; ++i)
+    {
+        const __m128 x = gatherLanes (jobs[0].left,  jobs[1].left,  jobs[2].left,  jobs[3].left,  i);
+        const __m128 y = gatherLanes (jobs[0].right, jobs[1].right, jobs[2].right, jobs[3].right, i);
+        const __m128 c = processLaneSample (s, x, y);
+
+        scatterLanes (_mm_sub_ps (x, c), jobs[0].left,  jobs[1].left,  jobs[2].left,  jobs[3].left,  i);
+        scatterLanes (_mm_sub_ps (y, c), jobs[0].right, jobs[1].right, jobs[2].right, jobs[3].right, i);
+
+        float centres[4];
+        _mm_storeu_ps (centres, c);
+
+        for (int j = 0; j < 4; ++j)
+        {
+            if (jobs[j].centreLeft != nullptr)
+            {
+                jobs[j].centreLeft[i] = centres[j];
+                jobs[j].centreRight[i] = centres[j];
+            }
+        }
+    }
+
+    for (int b = 0; b < 3; ++b)
+    {
+        scatterLanes (s.leftFilter1[b],  s0.leftFilter1,  s1.leftFilter1,  s2.leftFilter1,  s3.leftFilter1,  b);
+        scatterLanes (s.leftFilter2[b],  s0.leftFilter2,  s1.leftFilter2,  s2.leftFilter2,  s3.leftFilter2,  b);
+        scatterLanes (s.rightFilter1[b], s0.rightFilter1, s1.rightFilter1, s2.rightFilter1, s3.rightFilter1, b);
+        scatterLanes (s.rightFilter2[b], s0.rightFilter2, s1.rightFilter2, s2.rightFilter2, s3.rightFilter2, b);
+    }
+
+    for (int b = 0; b < numBands; ++b)
+    {
+        scatterLanes (s.leftPower[b],  s0.leftPower,  s1.leftPower,  s2.leftPower,  s3.leftPower,  b);
+        scatterLanes (s.rightPower[b], s0.rightPower, s1.rightPower, s2.rightPower, s3.rightPower, b);
+        scatterLanes (s.crossPower[b], s0.crossPower, s1.crossPower, s2.crossPower, s3.crossPower, b);
+    }
+
+   #else
+    for (int i = 0; i < 4; ++i)
+        jobs[i].owner->processPair (*jobs[i].state, jobs[i].left, jobs[i].right,
+                                    jobs[i].centreLeft, jobs[i].centreRight, numSamples);
+   #endif
+}
+
+//==============================================================================
+void AdaptiveCentreExtractor::processPair (PairState& s, float* const left, float* const right,
+                                          float* const centreLeft, float* const centreRight,
+                                          const int numSamples) noexcept
+{
+   #if JUCE_INTEL
+    const __m128 a1 = _mm_loadu_ps (filterA1), a2 = _mm_loadu_ps (filterA2), a3 = _mm_loadu_ps (filterA3);
+    const __m128 two = _mm_set1_ps (2.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 alpha = _mm_set1_ps (smoothing);
+    const __m128 relativeFloor = _mm_set1_ps (AdaptiveCentreHelpers::relativeNoiseFloor);
+    const __m128 absoluteFloor = _mm_set1_ps (AdaptiveCentreHelpers::absoluteNoiseFloor);
+    const __m128 topBand = _mm_castsi128_ps (_mm_set_epi32 (-1, 0, 0, 0));
+
+    __m128 l1 = _mm_loadu_ps (s.leftFilter1),  l2 = _mm_loadu_ps (s.leftFilter2);
+    __m128 r1 = _mm_loadu_ps (s.rightFilter1), r2 = _mm_loadu_ps (s.rightFilter2);
+    __m128 leftPower = _mm_loadu_ps (s.leftPower), rightPower = _mm_loadu_ps (s.rightPower);
+    __m128 crossPower = _mm_loadu_ps (s.crossPower);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const __m128 x = _mm_set1_ps (left[i]);
+        const __m128 y = _mm_set1_ps (right[i]);
+
+        // One step of all the lowpasses, with the top lane replaced by the input
+        __m128 v3 = _mm_sub_ps (x, l2);
+        __m128 v1 = _mm_add_ps (_mm_mul_ps (a1, l1), _mm_mul_ps (a2, v3));
+        __m128 v2 = _mm_add_ps (l2, _mm_add_ps (_mm_mul_ps (a2, l1), _mm_mul_ps (a3, v3)));
+        l1 = _mm_sub_ps (_mm_mul_ps (two, v1), l1);
+        l2 = _mm_sub_ps (_mm_mul_ps (two, v2), l2);
+        const __m128 leftLow = _mm_or_ps (_mm_and_ps (topBand, x), _mm_andnot_ps (topBand, v2));
+
+        v3 = _mm_sub_ps (y, r2);
+        v1 = _mm_add_ps (_mm_mul_ps (a1, r1), _mm_mul_ps (a2, v3));
+        v2 = _mm_add_ps (r2, _mm_add_ps (_mm_mul_ps (a2, r1), _mm_mul_ps (a3, v3)));
+        r1 = _mm_sub_ps (_mm_mul_ps (two, v1), r1);
+        r2 = _mm_sub_ps (_mm_mul_ps (two, v2), r2);
+        const __m128 rightLow = _mm_or_ps (_mm_and_ps (topBand, y), _mm_andnot_ps (topBand, v2));
+
+        // Each band is its lowpass minus the one below it
+        const __m128 l = _mm_sub_ps (leftLow,  _mm_castsi128_ps (_mm_slli_si128 (_mm_castps_si128 (leftLow), 4)));
+        const __m128 r = _mm_sub_ps (rightLow, _mm_castsi128_ps (_mm_slli_si128 (_mm_castps_si128 (rightLow), 4)));
+
+        leftPower  = _mm_add_ps (leftPower,  _mm_mul_ps (alpha, _mm_sub_ps (_mm_mul_ps (l, l), leftPower)));
+        rightPower = _mm_add_ps (rightPower, _mm_mul_ps (alpha, _mm_sub_ps (_mm_mul_ps (r, r), rightPower)));
+        crossPower = _mm_add_ps (crossPower, _mm_mul_ps (alpha, _mm_sub_ps (_mm_mul_ps (l, r), crossPower)));
+
+        const __m128 shared = _mm_max_ps (zero, _mm_min_ps (crossPower, _mm_min_ps (leftPower, rightPower)));
+        const __m128 noiseFloor = _mm_add_ps (absoluteFloor, _mm_mul_ps (relativeFloor, _mm_add_ps (leftPower, rightPower)));
+        const __m128 leftNoise  = _mm_add_ps (_mm_sub_ps (leftPower, shared), noiseFloor);
+        const __m128 rightNoise = _mm_add_ps (_mm_sub_ps (rightPower, shared), noiseFloor);
+
+        const __m128 scale = _mm_div_ps (shared, _mm_add_ps (_mm_mul_ps (shared, _mm_add_ps (leftNoise, rightNoise)),
+                                                            _mm_mul_ps (leftNoise, rightNoise)));
+        const __m128 centre = _mm_mul_ps (scale, _mm_add_ps (_mm_mul_ps (rightNoise, l), _mm_mul_ps (leftNoise, r)));
+
+        __m128 sum = _mm_add_ps (centre, _mm_movehl_ps (centre, centre));
+        sum = _mm_add_ss (sum, _mm_shuffle_ps (sum, sum, 1));
+        const float c = _mm_cvtss_f32 (sum);
+
+        left[i] -= c;
+        right[i] -= c;
+
+        if (centreLeft != nullptr)
+        {
+            centreLeft[i] = c;
+            centreRight[i] = c;
+        }
+    }
+
+    _mm_storeu_ps (s.leftFilter1, l1);   _mm_storeu_ps (s.leftFilter2, l2);
+    _mm_storeu_ps (s.rightFilter1, r1);  _mm_storeu_ps (s.rightFilter2, r2);
+    _mm_storeu_ps (s.leftPower, leftPower);
+    _mm_storeu_ps (s.rightPower, rightPower);
+    _mm_storeu_ps (s.crossPower, crossPower);
+
+   #else
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float x = left[i], y = right[i];
+        float leftLow [numBands], rightLow [numBands];
+
+        for (int b = 0; b < numBands - 1; ++b)
+        {
+            float v3 = x - s.leftFilter2[b];
+            float v1 = filterA1[b] * s.leftFilter1[b] + filterA2[b] * v3;
+            float v2 = s.leftFilter2[b] + filterA2[b] * s.leftFilter1[b] + filterA3[b] * v3;
+            s.leftFilter1[b] = 2.0f * v1 - s.leftFilter1[b];
+            s.leftFilter2[b] = 2.0f * v2 - s.leftFilter2[b];
+            leftLow[b] = v2;
+
+            v3 = y - s.rightFilter2[b];
+            v1 = filterA1[b] * s.rightFilter1[b] + filterA2[b] * v3;
+            v2 = s.rightFilter2[b] + filterA2[b] * s.rightFilter1[b] + filterA3[b] * v3;
+            s.rightFilter1[b] = 2.0f * v1 - s.rightFilter1[b];
+            s.rightFilter2[b] = 2.0f * v2 - s.rightFilter2[b];
+            rightLow[b] = v2;
+        }
+
+        leftLow [numBands - 1] = x;
+        rightLow [numBands - 1] = y;
+
+        float c = 0;
+
+        for (int b = 0; b < numBands; ++b)
+        {
+            const float l = leftLow[b]  - (b > 0 ? leftLow [b - 1] : 0.0f);
+            const float r = rightLow[b] - (b > 0 ? rightLow [b - 1] : 0.0f);
+
+            s.leftPower[b]  += smoothing * (l * l - s.leftPower[b]);
+            s.rightPower[b] += smoothing * (r * r - s.rightPower[b]);
+            s.crossPower[b] += smoothing * (l * r - s.crossPower[b]);
+
+            const float shared = jmax (0.0f, jmin (s.crossPower[b], s.leftPower[b], s.rightPower[b]));
+            const float noiseFloor = AdaptiveCentreHelpers::absoluteNoiseFloor
+                                       + AdaptiveCentreHelpers::relativeNoiseFloor * (s.leftPower[b] + s.rightPower[b]);
+            const float leftNoise  = s.leftPower[b]  - shared + noiseFloor;
+            const float rightNoise = s.rightPower[b] - shared + noiseFloor;
+
+            c += shared * (rightNoise * l + leftNoise * r)
+                   / (shared * (leftNoise + rightNoise) + leftNoise * rightNoise);
+        }
+
+        left[i] -= c;
+        right[i] -= c;
+
+        if (centreLeft != nullptr)
+        {
+            centreLeft[i] = c;
+            centreRight[i] = c;
+        }
+    }
+   #endif
+}
@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+    AdaptiveCentreExtractor.h
+
+    Removes the correlated centre from each channel pair, band by band, without
+    adding any latency.
+
+  ==============================================================================
+*/
+
+#ifndef __ADAPTIVECENTREEXTRACTOR_H_7D3E9A25__
+#define __ADAPTIVECENTREEXTRACTOR_H_7D3E9A25__
+
+#include "ChannelPairEngine.h"
+
+
+//==============================================================================
+/**
+    A zero-latency centre remover that keeps the stereo image.
+
+    Each channel of a pair is split into four bands by a bank of lowpass filters,
+    where each band is the difference between two neighbouring lowpasses, so the
+    bands always add back up to exactly the input. In each band, the running
+    covariance of L and R gives the power of the component they share (the centre)
+    and of what's left in each side. From those, a Wiener estimate of the centre is
+    made from L and R, and subtracted from both. Sources that are only in one
+    channel, or that are out of phase, are left where they were.
+
+    The four bands' filter and covariance state is held as structure-of-arrays, so
+    that with SSE on Intel, every step of the per-sample update is a single
+    instruction covering all the bands. The cost per sample is fixed, and nothing
+    is allocated.
+
+    Like ChannelPairEngine, it can also write the extracted centre to a separate
+    set of channels, and a discrete centre channel is moved there or silenced.
+*/
+class AdaptiveCentreExtractor
+{
+public:
+    //==============================================================================
+    AdaptiveCentreExtractor();
+    ~AdaptiveCentreExtractor();
+
+    //==============================================================================
+    /** Takes a copy of the layout's pairs, and sets up the filters for a sample rate.
+        This also resets the adaptive state.
+    */
+    void prepare (const ChannelPairEngine& layout, double sampleRate);
+
+    /** Clears the filters and the covariance estimates. */
+    void reset() noexcept;
+
+    /** Returns true if the filters and estimates are all zero, in which case silent
+        input leaves them that way and produces silent output.
+    */
+    bool isQuiescent() const noexcept;
+
+    //==============================================================================
+    /** Processes a block in place. */
+    void process (AudioSampleBuffer& buffer) noexcept;
+
+    /** Processes a block in place, and also writes the removed centre to another buffer,
+        which must have at least as many channels as the layout.
+    */
+    void process (AudioSampleBuffer& buffer, AudioSampleBuffer& centreOutput) noexcept;
+
+    //==============================================================================
+    /** One extractor's block, for processBatch(). */
+    struct BatchItem
+    {
+        AdaptiveCentreExtractor* extractor;
+        float* const* channels;         /**< the layout's channels, processed in place */
+        float* const* centreChannels;   /**< where the centre goes, or nullptr if it's not wanted */
+        int numSamples;
+    };
+
+    /** Processes a block for each of a number of extractors in one pass.
+
+        The pairs of all the extractors are interleaved across the SSE lanes, four
+        at a time, so the per-sample filter and covariance updates of four pairs
+        are done by each instruction. The results are bit-for-bit the same as
+        calling process() on each extractor in turn. Each item's channel arrays
+        must have at least as many channels as its extractor's layout.
+    */
+    static void processBatch (const BatchItem* items, int numItems) noexcept;
+
+private:
+    //==============================================================================
+    enum { numBands = 4, maxPairs = 8 };
+
+    /** The state for one pair, with one element of each array per band. Only the first
+        three lowpass filters are real; the top "lowpass" is the input itself.
+    */
+    struct PairState
+    {
+        float leftFilter1 [numBands], leftFilter2 [numBands];
+        float rightFilter1 [numBands], rightFilter2 [numBands];
+        float leftPower [numBands], rightPower [numBands], crossPower [numBands];
+    };
+
+    int numChannels, numPairs, centreChannel;
+    int leftChannels [maxPairs];
+    int rightChannels [maxPairs];
+    PairState states [maxPairs];
+
+    float filterA1 [numBands], filterA2 [numBands], filterA3 [numBands];
+    float smoothing;
+
+    void processPair (PairState& state, float* left, float* right,
+                      float* centreLeft, float* centreRight, int numSamples) noexcept;
+
+    struct LaneJob;
+    static void processLanes (const LaneJob* jobs, int numSamples) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE (AdaptiveCentreExtractor)
+};
+
+
+#endif  // __ADAPTIVECENTREEXTRACTOR_H_7D3E9A25__
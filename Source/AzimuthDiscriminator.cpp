@@ -0,0 +1,278 @@
+/*
+  ==============================================================================
+
+    AzimuthDiscriminator.cpp
+
+    Separates sources by their pan position, in the frequency domain.
+
+  ==============================================================================
+*/
+
+#include "AzimuthDiscriminator.h"
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+
+//==============================================================================
+namespace AzimuthHelpers
+{
+    /*  Finds the grid step of each bin's pan position.
+
+        If L is the louder channel, the null is at g = Re (L.conj (R)) / |L|^2, and the
+        bin is at -(1 - g) on the left; otherwise it's the mirror image on the right.
+        The steps run from 0 (hard left) through gridResolution (centre) to
+        2 * gridResolution (hard right).
+    */
+    static void findGridSteps (const float* lr, const float* li, const float* rr, const float* ri,
+                               int* steps, const int numBins) noexcept
+    {
+        const float resolution = (float) AzimuthDiscriminator::gridResolution;
+        int i = 0;
+
+       #if JUCE_INTEL
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps (1.0f);
+        const __m128 tiny = _mm_set1_ps (1.0e-30f);
+        const __m128 scale = _mm_set1_ps (resolution);
+        const __m128 offset = _mm_set1_ps (resolution + 0.5f);
+        const __m128 signBit = _mm_set1_ps (-0.0f);
+
+        for (; i + 4 <= numBins; i += 4)
+        {
+            const __m128 lRe = _mm_loadu_ps (lr + i), lIm = _mm_loadu_ps (li + i);
+            const __m128 rRe = _mm_loadu_ps (rr + i), rIm = _mm_loadu_ps (ri + i);
+
+            const __m128 leftPower  = _mm_add_ps (_mm_mul_ps (lRe, lRe), _mm_mul_ps (lIm, lIm));
+            const __m128 rightPower = _mm_add_ps (_mm_mul_ps (rRe, rRe), _mm_mul_ps (rIm, rIm));
+            const __m128 dot        = _mm_add_ps (_mm_mul_ps (lRe, rRe), _mm_mul_ps (lIm, rIm));
+
+            __m128 g = _mm_div_ps (dot, _mm_add_ps (_mm_max_ps (leftPower, rightPower), tiny));
+            g = _mm_min_ps (_mm_max_ps (g, zero), one);
+
+            const __m128 distance = _mm_mul_ps (_mm_sub_ps (one, g), scale);
+            const __m128 isLeft = _mm_cmpge_ps (leftPower, rightPower);
+            const __m128 signedDistance = _mm_xor_ps (distance, _mm_and_ps (isLeft, signBit));
+
+            _mm_storeu_si128 ((__m128i*) (steps + i), _mm_cvttps_epi32 (_mm_add_ps (offset, signedDistance)));
+        }
+       #endif
+
+        for (; i < numBins; ++i)
+        {
+            const float leftPower  = lr[i] * lr[i] + li[i] * li[i];
+            const float rightPower = rr[i] * rr[i] + ri[i] * ri[i];
+            const float dot        = lr[i] * rr[i] + li[i] * ri[i];
+
+            float g = dot / (jmax (leftPower, rightPower) + 1.0e-30f);
+            g = g > 0.0f ? jmin (g, 1.0f) : 0.0f;   // (written this way so that a NaN comes out as 0)
+            const float distance = (1.0f - g) * resolution;
+
+            steps[i] = (int) (resolution + 0.5f + (leftPower >= rightPower ? -distance : distance));
+        }
+    }
+
+    /*  Adds up the power of both channels in each bin. */
+    static void findPowers (const float* lr, const float* li, const float* rr, const float* ri,
+                            float* powers, const int numBins) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_INTEL
+        for (; i + 4 <= numBins; i += 4)
+        {
+            const __m128 lRe = _mm_loadu_ps (lr + i), lIm = _mm_loadu_ps (li + i);
+            const __m128 rRe = _mm_loadu_ps (rr + i), rIm = _mm_loadu_ps (ri + i);
+
+            _mm_storeu_ps (powers + i, _mm_add_ps (_mm_add_ps (_mm_mul_ps (lRe, lRe), _mm_mul_ps (lIm, lIm)),
+                                                   _mm_add_ps (_mm_mul_ps (rRe, rRe), _mm_mul_ps (rIm, rIm))));
+        }
+       #endif
+
+        for (; i < numBins; ++i)
+            powers[i] = lr[i] * lr[i] + li[i] * li[i] + rr[i] * rr[i] + ri[i] * ri[i];
+    }
+
+    static void lookUp (const float* table, const int* steps, float* results, const int num) noexcept
+    {
+        for (int i = 0; i < num; ++i)
+            results[i] = table [steps[i]];
+    }
+}
+
+//==============================================================================
+AzimuthDiscriminator::AzimuthDiscriminator()
+    : numChannels (0), numPairs (0), centreChannel (-1), hasCentreOutput (false),
+      targetPosition (0), targetWidth (0.1f), tablePosition (-10.0f), tableWidth (-10.0f)
+{
+}
+
+AzimuthDiscriminator::~AzimuthDiscriminator()
+{
+}
+
+//==============================================================================
+void AzimuthDiscriminator::prepare (const ChannelPairEngine& layout, const bool hasCentreOutput_,
+                                    const int numBins, const double sampleRate)
+{
+    numChannels = layout.getNumChannels();
+    numPairs = jmin ((int) maxPairs, layout.getNumPairs());
+    centreChannel = layout.getCentreChannel();
+    hasCentreOutput = hasCentreOutput_;
+
+    for (int i = 0; i < numPairs; ++i)
+    {
+        leftChannels[i] = layout.getLeftChannel (i);
+        rightChannels[i] = layout.getRightChannel (i);
+    }
+
+    gridIndices.malloc ((size_t) numBins);
+    extractGains.malloc ((size_t) numBins);
+    keepGains.malloc ((size_t) numBins);
+    maskProcessor.prepare (jmax (1, numPairs), numBins, sampleRate);
+
+    tablePosition = tableWidth = -10.0f;
+}
+
+void AzimuthDiscriminator::release()
+{
+    gridIndices.free();
+    extractGains.free();
+    keepGains.free();
+    maskProcessor.release();
+}
+
+void AzimuthDiscriminator::reset() noexcept
+{
+    maskProcessor.reset();
+}
+
+void AzimuthDiscriminator::setTarget (const float position, const float width) noexcept
+{
+    targetPosition = jlimit (-1.0f, 1.0f, position);
+    targetWidth = jlimit (0.0f, 2.0f, width);
+}
+
+void AzimuthDiscriminator::setMaskSmoothing (const float timeConstantSeconds, const float bandwidthInERBs,
+                                             const float floor) noexcept
+{
+    maskProcessor.setSmoothing (timeConstantSeconds, bandwidthInERBs, floor);
+}
+
+void AzimuthDiscriminator::setHopSize (const int hopSize) noexcept
+{
+    maskProcessor.setHopSize (hopSize);
+}
+
+bool AzimuthDiscriminator::isQuiescent() const noexcept
+{
+    return maskProcessor.isQuiescent();
+}
+
+void AzimuthDiscriminator::updateTables() noexcept
+{
+    const float position = targetPosition;
+    const float width = targetWidth;
+
+    if (position == tablePosition && width == tableWidth)
+        return;
+
+    tablePosition = position;
+    tableWidth = width;
+
+    // (the extra half step makes a zero width still catch the nearest step)
+    const float halfWidth = width * 0.5f + 0.5f / gridResolution;
+
+    for (int i = 0; i < numGridSteps; ++i)
+    {
+        const float stepPosition = (i - gridResolution) / (float) gridResolution;
+        extractTable[i] = std::abs (stepPosition - position) <= halfWidth ? 1.0f : 0.0f;
+        keepTable[i] = 1.0f - extractTable[i];
+    }
+}
+
+bool AzimuthDiscriminator::isPaired (const int channel) const noexcept
+{
+    for (int i = 0; i < numPairs; ++i)
+        if (leftChannels[i] == channel || rightChannels[i] == channel)
+            return true;
+
+    return false;
+}
+
+//==============================================================================
+void AzimuthDiscriminator::processSpectra (float* const* inputReal, float* const* inputImag,
+                                          float* const* outputReal, float* const* outputImag,
+                                          const int numBins)
+{
+    updateTables();
+
+    const bool smoothMasks = maskProcessor.isActive();
+
+    for (int p = 0; p < numPairs; ++p)
+    {
+        const int l = leftChannels[p], r = rightChannels[p];
+
+        AzimuthHelpers::findGridSteps (inputReal[l], inputImag[l], inputReal[r], inputImag[r], gridIndices, numBins);
+
+        if (smoothMasks)
+        {
+            // (whatever the smoothed mask doesn't extract stays in the residual)
+            AzimuthHelpers::lookUp (extractTable, gridIndices, extractGains, numBins);
+            AzimuthHelpers::findPowers (inputReal[l], inputImag[l], inputReal[r], inputImag[r], keepGains, numBins);
+            maskProcessor.process (p, extractGains, keepGains, numBins);
+            FloatVectorOperations::copyWithMultiply (keepGains, extractGains, -1.0f, numBins);
+            FloatVectorOperations::add (keepGains, 1.0f, numBins);
+        }
+        else
+        {
+            AzimuthHelpers::lookUp (keepTable, gridIndices, keepGains, numBins);
+
+            if (hasCentreOutput)
+                AzimuthHelpers::lookUp (extractTable, gridIndices, extractGains, numBins);
+        }
+
+        if (hasCentreOutput)
+        {
+            for (int i = 0; i < 2; ++i)
+            {
+                const int ch = i == 0 ? l : r;
+
+                FloatVectorOperations::copy (outputReal [numChannels + ch], inputReal[ch], numBins);
+                FloatVectorOperations::copy (outputImag [numChannels + ch], inputImag[ch], numBins);
+                FloatVectorOperations::multiply (outputReal [numChannels + ch], extractGains, numBins);
+                FloatVectorOperations::multiply (outputImag [numChannels + ch], extractGains, numBins);
+            }
+        }
+
+        for (int i = 0; i < 2; ++i)
+        {
+            const int ch = i == 0 ? l : r;
+
+            FloatVectorOperations::copy (outputReal[ch], inputReal[ch], numBins);
+            FloatVectorOperations::copy (outputImag[ch], inputImag[ch], numBins);
+            FloatVectorOperations::multiply (outputReal[ch], keepGains, numBins);
+            FloatVectorOperations::multiply (outputImag[ch], keepGains, numBins);
+        }
+    }
+
+    const float centreExtract = extractTable [gridResolution] * (1.0f - maskProcessor.getFloor());
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        if (isPaired (ch))
+            continue;
+
+        const float extract = (ch == centreChannel) ? centreExtract : 0.0f;
+
+        FloatVectorOperations::copyWithMultiply (outputReal[ch], inputReal[ch], 1.0f - extract, numBins);
+        FloatVectorOperations::copyWithMultiply (outputImag[ch], inputImag[ch], 1.0f - extract, numBins);
+
+        if (hasCentreOutput)
+        {
+            FloatVectorOperations::copyWithMultiply (outputReal [numChannels + ch], inputReal[ch], extract, numBins);
+            FloatVectorOperations::copyWithMultiply (outputImag [numChannels + ch], inputImag[ch], extract, numBins);
+        }
+    }
+}
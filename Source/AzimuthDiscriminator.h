@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    AzimuthDiscriminator.h
+
+    Separates sources by their pan position, in the frequency domain.
+
+  ==============================================================================
+*/
+
+#ifndef __AZIMUTHDISCRIMINATOR_H_2A9F61B8__
+#define __AZIMUTHDISCRIMINATOR_H_2A9F61B8__
+
+#include "ShortTimeFourierTransform.h"
+#include "ChannelPairEngine.h"
+#include "SpectralMaskProcessor.h"
+
+
+//==============================================================================
+/**
+    Removes or extracts the sources at any pan position, ADRess-style.
+
+    For each pair of channels and each bin, the gain g (0 to 1) that best cancels one
+    channel against the other, i.e. that minimises |L - g.R| or |R - g.L|, gives
+    the pan position of whatever dominates that bin: a null at g = 1 is dead centre,
+    and g = 0 is hard left or right. This is the null in the ADRess frequency-azimuth
+    plane, but because the distance is a convex function of g, it can be found
+    directly instead of by scanning every gain step. The result is snapped to an
+    azimuth grid, and a precomputed table for the grid says how much of the bin
+    belongs to the target region, which is then taken out of the residual and, if
+    there's a centre output, put into it.
+
+    The bins are processed four at a time with SSE on Intel. A discrete centre
+    channel is treated as a source at position 0, and other unpaired channels stay
+    with the residual.
+
+    The table's gains jump straight from 0 to 1, so a source near the edge of the
+    region leaves bins flickering in and out. setMaskSmoothing() turns on a
+    SpectralMaskProcessor for each pair's gains, weighted by the pair's power in
+    each bin, which trades some separation for fewer artefacts, and a floor that
+    limits how deep the removal goes.
+
+    The spectra it gets are laid out like the processor's channels: the inputs are
+    the layout's channels, and the outputs are the residuals, followed by the
+    extracted sources if there's a centre output.
+*/
+class AzimuthDiscriminator  : public ShortTimeFourierTransform::Client
+{
+public:
+    //==============================================================================
+    AzimuthDiscriminator();
+    ~AzimuthDiscriminator();
+
+    /** The number of grid steps between dead centre and hard left or right. */
+    enum { gridResolution = 100 };
+
+    //==============================================================================
+    /** Takes a copy of the layout's channel pairs, and allocates the scratch space.
+
+        @param layout               the layout, whose setLayout() must have been called
+        @param hasCentreOutput      if true, there are twice as many outputs as inputs
+        @param numBins              the most bins that each spectrum will have
+        @param sampleRate           the sample rate, which the mask smoothing depends on
+    */
+    void prepare (const ChannelPairEngine& layout, bool hasCentreOutput, int numBins, double sampleRate);
+
+    /** Frees the scratch space. */
+    void release();
+
+    /** Clears what the mask smoothing remembers of earlier frames. */
+    void reset() noexcept;
+
+    /** Sets the region to remove. This can be called while processing.
+
+        @param position     the pan position, from -1 (hard left) through 0 (centre) to 1 (hard right)
+        @param width        the width of the region, from 0 (just the one grid step)
+                            to 2 (everything)
+    */
+    void setTarget (float position, float width) noexcept;
+
+    /** Sets up the smoothing of the gains, as for SpectralMaskProcessor::setSmoothing().
+        With everything at 0, which is the default, the gains are used exactly as they
+        come out of the table. This can be called while processing.
+    */
+    void setMaskSmoothing (float timeConstantSeconds, float bandwidthInERBs, float floor) noexcept;
+
+    /** Sets the number of samples between frames, which the mask smoothing depends on. */
+    void setHopSize (int hopSize) noexcept;
+
+    /** Returns true if the mask smoothing has nothing left over from earlier frames. */
+    bool isQuiescent() const noexcept;
+
+    //==============================================================================
+    void processSpectra (float* const* inputReal, float* const* inputImag,
+                         float* const* outputReal, float* const* outputImag,
+                         int numBins);
+
+private:
+    //==============================================================================
+    enum { numGridSteps = gridResolution * 2 + 1, maxPairs = 8 };
+
+    int numChannels, numPairs, centreChannel;
+    int leftChannels [maxPairs];
+    int rightChannels [maxPairs];
+    bool hasCentreOutput;
+
+    float targetPosition, targetWidth, tablePosition, tableWidth;
+    float extractTable [numGridSteps];
+    float keepTable [numGridSteps];
+
+    HeapBlock<int> gridIndices;
+    HeapBlock<float> extractGains, keepGains;
+    SpectralMaskProcessor maskProcessor;
+
+    void updateTables() noexcept;
+    bool isPaired (int channel) const noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE (AzimuthDiscriminator)
+};
+
+
+#endif  // __AZIMUTHDISCRIMINATOR_H_2A9F61B8__
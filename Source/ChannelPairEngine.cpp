@@ -0,0 +1,247 @@
+/*
+  ==============================================================================
+
+    ChannelPairEngine.cpp
+
+    Removes the centre image from every left/right pair of a stereo or
+    surround layout.
+
+  ==============================================================================
+*/
+
+#include "ChannelPairEngine.h"
+
+#if JUCE_INTEL
+ #include <xmmintrin.h>
+#endif
+
+
+//==============================================================================
+namespace ChannelPairHelpers
+{
+    static const char* const pairNames[][2] =
+    {
+        { "L",   "R"   },
+        { "Ls",  "Rs"  },
+        { "Lc",  "Rc"  },
+        { "Sl",  "Sr"  },
+        { "Lss", "Rss" },
+        { "Lsr", "Rsr" },
+        { "Tfl", "Tfr" },
+        { "Trl", "Trr" }
+    };
+
+    static String getDefaultArrangement (const int numChannels)
+    {
+        switch (numChannels)
+        {
+            case 6:     return "L R C Lfe Ls Rs";
+            case 8:     return "L R C Lfe Ls Rs Sl Sr";
+            default:    break;
+        }
+
+        return String::empty;
+    }
+}
+
+//==============================================================================
+ChannelPairEngine::ChannelPairEngine()
+    : numChannels (0), numPairs (0), centreChannel (-1)
+{
+}
+
+ChannelPairEngine::~ChannelPairEngine()
+{
+}
+
+//==============================================================================
+void ChannelPairEngine::addPair (const int left, const int right) noexcept
+{
+    if (numPairs < maxPairs)
+    {
+        leftChannels [numPairs] = left;
+        rightChannels [numPairs] = right;
+        ++numPairs;
+    }
+}
+
+void ChannelPairEngine::setLayout (const int numChannels_, const String& speakerArrangement)
+{
+    numChannels = jlimit (0, (int) maxChannels, numChannels_);
+    numPairs = 0;
+    centreChannel = -1;
+
+    channelNames.clear();
+    channelNames.addTokens (speakerArrangement.isNotEmpty() ? speakerArrangement
+                                                            : ChannelPairHelpers::getDefaultArrangement (numChannels),
+                            " ", String::empty);
+    channelNames.removeEmptyStrings();
+
+    if (channelNames.size() != numChannels)
+    {
+        // An unknown layout: just pair up the channels in order
+        channelNames.clear();
+
+        for (int i = 0; i < numChannels; ++i)
+            channelNames.add (String (i + 1));
+
+        for (int i = 0; i + 1 < numChannels; i += 2)
+            addPair (i, i + 1);
+
+        return;
+    }
+
+    for (int i = 0; i < numElementsInArray (ChannelPairHelpers::pairNames); ++i)
+    {
+        const int left  = channelNames.indexOf (ChannelPairHelpers::pairNames[i][0]);
+        const int right = channelNames.indexOf (ChannelPairHelpers::pairNames[i][1]);
+
+        if (left >= 0 && right >= 0)
+            addPair (left, right);
+    }
+
+    centreChannel = channelNames.indexOf ("C");
+}
+
+bool ChannelPairEngine::isPairedChannel (const int channel) const noexcept
+{
+    for (int i = 0; i < numPairs; ++i)
+        if (leftChannels[i] == channel || rightChannels[i] == channel)
+            return true;
+
+    return false;
+}
+
+String ChannelPairEngine::getChannelName (const int channel) const
+{
+    return isPositiveAndBelow (channel, channelNames.size()) ? channelNames [channel]
+                                                            : String (channel + 1);
+}
+
+//==============================================================================
+void ChannelPairEngine::process (AudioSampleBuffer& buffer) noexcept
+{
+    processPairs (buffer, nullptr);
+
+    if (isPositiveAndBelow (centreChannel, buffer.getNumChannels()))
+        buffer.clear (centreChannel, 0, buffer.getNumSamples());
+}
+
+void ChannelPairEngine::process (AudioSampleBuffer& buffer, AudioSampleBuffer& centreOutput) noexcept
+{
+    jassert (centreOutput.getNumChannels() >= jmin (numChannels, buffer.getNumChannels()));
+    jassert (centreOutput.getNumSamples() >= buffer.getNumSamples());
+
+    const int numSamples = buffer.getNumSamples();
+    const int numBufferChannels = jmin (buffer.getNumChannels(), centreOutput.getNumChannels());
+
+    for (int ch = 0; ch < numBufferChannels; ++ch)
+    {
+        if (ch == centreChannel)
+        {
+            centreOutput.copyFrom (ch, 0, buffer, ch, 0, numSamples);
+            buffer.clear (ch, 0, numSamples);
+        }
+        else if (! isPairedChannel (ch))
+        {
+            centreOutput.clear (ch, 0, numSamples);
+        }
+    }
+
+    processPairs (buffer, &centreOutput);
+}
+
+void ChannelPairEngine::processPairs (AudioSampleBuffer& buffer, AudioSampleBuffer* const centreOutput) noexcept
+{
+    const int numSamples = buffer.getNumSamples();
+    const int numBufferChannels = buffer.getNumChannels();
+
+    float* left [maxPairs];
+    float* right [maxPairs];
+    float* centreLeft [maxPairs];
+    float* centreRight [maxPairs];
+    int num = 0;
+
+    for (int i = 0; i < numPairs; ++i)
+    {
+        const int l = leftChannels[i], r = rightChannels[i];
+
+        if (l < numBufferChannels && r < numBufferChannels
+             && (centreOutput == nullptr || (l < centreOutput->getNumChannels() && r < centreOutput->getNumChannels())))
+        {
+            left[num]  = buffer.getSampleData (l);
+            right[num] = buffer.getSampleData (r);
+
+            if (centreOutput != nullptr)
+            {
+                centreLeft[num]  = centreOutput->getSampleData (l);
+                centreRight[num] = centreOutput->getSampleData (r);
+            }
+
+            ++num;
+        }
+    }
+
+    int i = 0;
+
+    if (centreOutput == nullptr)
+    {
+       #if JUCE_INTEL
+        // Each step does four samples of every pair, so all the pairs' data streams through the
+        // cache together and the loop overhead is shared between them.
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            for (int p = 0; p < num; ++p)
+            {
+                const __m128 side = _mm_sub_ps (_mm_loadu_ps (left[p] + i), _mm_loadu_ps (right[p] + i));
+                _mm_storeu_ps (left[p] + i, side);
+                _mm_storeu_ps (right[p] + i, side);
+            }
+        }
+       #endif
+
+        for (; i < numSamples; ++i)
+        {
+            for (int p = 0; p < num; ++p)
+            {
+                const float side = left[p][i] - right[p][i];
+                left[p][i] = side;
+                right[p][i] = side;
+            }
+        }
+    }
+    else
+    {
+       #if JUCE_INTEL
+        const __m128 half = _mm_set1_ps (0.5f);
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            for (int p = 0; p < num; ++p)
+            {
+                const __m128 l = _mm_loadu_ps (left[p] + i);
+                const __m128 side = _mm_sub_ps (l, _mm_loadu_ps (right[p] + i));
+                const __m128 mid = _mm_sub_ps (l, _mm_mul_ps (side, half));
+                _mm_storeu_ps (left[p] + i, side);
+                _mm_storeu_ps (right[p] + i, side);
+                _mm_storeu_ps (centreLeft[p] + i, mid);
+                _mm_storeu_ps (centreRight[p] + i, mid);
+            }
+        }
+       #endif
+
+        for (; i < numSamples; ++i)
+        {
+            for (int p = 0; p < num; ++p)
+            {
+                const float l = left[p][i];
+                const float side = l - right[p][i];
+                const float mid = l - side * 0.5f;
+                left[p][i] = side;
+                right[p][i] = side;
+                centreLeft[p][i] = mid;
+                centreRight[p][i] = mid;
+            }
+        }
+    }
+}
@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    ChannelPairEngine.h
+
+    Removes the centre image from every left/right pair of a stereo or
+    surround layout.
+
+  ==============================================================================
+*/
+
+#ifndef __CHANNELPAIRENGINE_H_6E0B4D17__
+#define __CHANNELPAIRENGINE_H_6E0B4D17__
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+
+//==============================================================================
+/**
+    Does the centre removal for a whole channel layout.
+
+    The layout is split into left/right pairs (L/R, Ls/Rs, Lc/Rc, Sl/Sr...), and in
+    each pair, the phantom centre is cancelled by replacing both channels with their
+    difference. A discrete centre channel is silenced, and anything else, like the
+    LFE, is passed through untouched.
+
+    All the pairs are processed together in a single pass through the block, four
+    samples of every pair at a time, so that a 7.1 block costs little more than
+    three stereo ones.
+
+    The same pass can also produce the centre that was removed, as a separate set of
+    channels. For each pair, that's the mid signal, (L + R) / 2, which is just the
+    left input minus half of the residual: one more multiply-add per sample. The
+    discrete centre channel is moved to it, and the other unpaired channels stay
+    with the residual.
+*/
+class ChannelPairEngine
+{
+public:
+    //==============================================================================
+    ChannelPairEngine();
+    ~ChannelPairEngine();
+
+    //==============================================================================
+    /** Works out the pairs for a layout.
+
+        @param numChannels          the number of channels that will be processed
+        @param speakerArrangement   the host's speaker names, like "L R C Lfe Ls Rs",
+                                    as returned by AudioProcessor::getInputSpeakerArrangement().
+                                    If this is empty, the standard film order is assumed
+                                    for 5.1 and 7.1 (L R C Lfe Ls Rs [Sl Sr]), and other
+                                    channel counts are paired up in order.
+    */
+    void setLayout (int numChannels, const String& speakerArrangement);
+
+    /** Returns the number of left/right pairs in the layout. */
+    int getNumPairs() const noexcept                    { return numPairs; }
+
+    /** Returns the number of channels in the layout. */
+    int getNumChannels() const noexcept                 { return numChannels; }
+
+    /** Returns the left channel of one of the pairs. */
+    int getLeftChannel (int pairIndex) const noexcept   { return leftChannels [pairIndex]; }
+
+    /** Returns the right channel of one of the pairs. */
+    int getRightChannel (int pairIndex) const noexcept  { return rightChannels [pairIndex]; }
+
+    /** Returns the discrete centre channel, or -1 if there isn't one. */
+    int getCentreChannel() const noexcept               { return centreChannel; }
+
+    /** Returns true if the channel is one half of a pair. */
+    bool isPairedChannel (int channel) const noexcept;
+
+    /** Returns the name of a channel in the layout. */
+    String getChannelName (int channel) const;
+
+    //==============================================================================
+    /** Processes a block in place. */
+    void process (AudioSampleBuffer& buffer) noexcept;
+
+    /** Processes a block in place, and also writes the removed centre to another buffer,
+        which must have at least as many channels as the layout.
+    */
+    void process (AudioSampleBuffer& buffer, AudioSampleBuffer& centreOutput) noexcept;
+
+private:
+    //==============================================================================
+    enum { maxChannels = 16, maxPairs = maxChannels / 2 };
+
+    int numChannels, numPairs, centreChannel;
+    int leftChannels [maxPairs];
+    int rightChannels [maxPairs];
+    StringArray channelNames;
+
+    void addPair (int left, int right) noexcept;
+    void processPairs (AudioSampleBuffer& buffer, AudioSampleBuffer* centreOutput) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE (ChannelPairEngine)
+};
+
+
+#endif  // __CHANNELPAIRENGINE_H_6E0B4D17__
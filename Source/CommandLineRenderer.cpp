@@ -0,0 +1,1062 @@
+/*
+  ==============================================================================
+
+    CommandLineRenderer.cpp
+
+    Runs the plugin's processor over files or streams, outside of a host.
+
+  ==============================================================================
+*/
+
+#include "CommandLineRenderer.h"
+
+#if JUCE_WINDOWS
+ #include <io.h>
+ #include <fcntl.h>
+#endif
+
+#include <cstdio>
+
+
+//==============================================================================
+namespace PipeHelpers
+{
+    template <class SampleType>
+    static void deinterleave (const void* source, AudioSampleBuffer& dest, int numChannels, int numFrames)
+    {
+        typedef AudioData::Pointer <SampleType, AudioData::LittleEndian, AudioData::Interleaved, AudioData::Const> SourceType;
+        typedef AudioData::Pointer <AudioData::Float32, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::NonConst> DestType;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            SourceType s (static_cast <const char*> (source) + ch * SourceType::getBytesPerSample(), numChannels);
+            DestType d (dest.getSampleData (ch));
+            d.convertSamples (s, numFrames);
+        }
+    }
+
+    template <class SampleType>
+    static void interleave (const AudioSampleBuffer& source, int startSample, void* dest, int numChannels, int numFrames)
+    {
+        typedef AudioData::Pointer <AudioData::Float32, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::Const> SourceType;
+        typedef AudioData::Pointer <SampleType, AudioData::LittleEndian, AudioData::Interleaved, AudioData::NonConst> DestType;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            SourceType s (source.getSampleData (ch, startSample));
+            DestType d (static_cast <char*> (dest) + ch * DestType::getBytesPerSample(), numChannels);
+
+            // (convertSamples() goes via a 32-bit int, which can be out by one lsb for
+            // 16-bit data, so this converts directly to keep a round trip bit-exact)
+            for (int i = numFrames; --i >= 0;)
+            {
+                d.setAsFloat (s.getAsFloat());
+                ++d;
+                ++s;
+            }
+        }
+    }
+
+    static void convertToFloat (CommandLineRenderer::SampleFormat format, const void* source,
+                                AudioSampleBuffer& dest, int numChannels, int numFrames)
+    {
+        switch (format)
+        {
+            case CommandLineRenderer::int16:    deinterleave <AudioData::Int16>   (source, dest, numChannels, numFrames); break;
+            case CommandLineRenderer::int24:    deinterleave <AudioData::Int24>   (source, dest, numChannels, numFrames); break;
+            case CommandLineRenderer::int32:    deinterleave <AudioData::Int32>   (source, dest, numChannels, numFrames); break;
+            default:                            deinterleave <AudioData::Float32> (source, dest, numChannels, numFrames); break;
+        }
+    }
+
+    static void convertFromFloat (CommandLineRenderer::SampleFormat format, const AudioSampleBuffer& source,
+                                  int startSample, void* dest, int numChannels, int numFrames)
+    {
+        switch (format)
+        {
+            case CommandLineRenderer::int16:    interleave <AudioData::Int16>   (source, startSample, dest, numChannels, numFrames); break;
+            case CommandLineRenderer::int24:    interleave <AudioData::Int24>   (source, startSample, dest, numChannels, numFrames); break;
+            case CommandLineRenderer::int32:    interleave <AudioData::Int32>   (source, startSample, dest, numChannels, numFrames); break;
+            default:                            interleave <AudioData::Float32> (source, startSample, dest, numChannels, numFrames); break;
+        }
+    }
+
+    static int getBitsPerSample (CommandLineRenderer::SampleFormat format) noexcept
+    {
+        switch (format)
+        {
+            case CommandLineRenderer::int16:    return 16;
+            case CommandLineRenderer::int24:    return 24;
+            default:                            return 32;
+        }
+    }
+
+    //==============================================================================
+    /** Reads the header of a WAV stream up to the start of its data chunk.
+        The sizes in the header are ignored, because a stream that's being written
+        on-the-fly won't know its final length.
+    */
+    static bool readWavHeader (InputStream& input, CommandLineRenderer::StreamFormat& format, String& errorMessage)
+    {
+        const int riff = input.readInt();
+
+        if (riff != (int) ByteOrder::littleEndianInt ("RIFF")
+             && riff != (int) ByteOrder::littleEndianInt ("RF64"))
+        {
+            errorMessage = "The input isn't a WAV stream";
+            return false;
+        }
+
+        input.readInt();
+
+        if (input.readInt() != (int) ByteOrder::littleEndianInt ("WAVE"))
+        {
+            errorMessage = "The input isn't a WAV stream";
+            return false;
+        }
+
+        bool foundFormat = false;
+        int bitsPerSample = 0;
+        bool isFloat = false;
+
+        while (! input.isExhausted())
+        {
+            const int chunkType = input.readInt();
+            const uint32 length = (uint32) input.readInt();
+
+            if (chunkType == (int) ByteOrder::littleEndianInt ("data"))
+            {
+                if (! foundFormat)
+                    break;
+
+                if (isFloat && bitsPerSample == 32)         format.sampleFormat = CommandLineRenderer::float32;
+                else if (! isFloat && bitsPerSample == 16)  format.sampleFormat = CommandLineRenderer::int16;
+                else if (! isFloat && bitsPerSample == 24)  format.sampleFormat = CommandLineRenderer::int24;
+                else if (! isFloat && bitsPerSample == 32)  format.sampleFormat = CommandLineRenderer::int32;
+                else
+                {
+                    errorMessage = "Unsupported WAV sample format: " + String (bitsPerSample) + (isFloat ? "-bit float" : "-bit");
+                    return false;
+                }
+
+                return true;
+            }
+
+            if (chunkType == (int) ByteOrder::littleEndianInt ("fmt "))
+            {
+                int formatTag = (unsigned short) input.readShort();
+                format.numChannels = (unsigned short) input.readShort();
+                format.sampleRate = input.readInt();
+                input.readInt();   // bytes per second
+                input.readShort(); // block align
+                bitsPerSample = (unsigned short) input.readShort();
+                int bytesUsed = 16;
+
+                if (formatTag == 0xfffe && length >= 26)
+                {
+                    input.readShort(); // cbSize
+                    input.readShort(); // valid bits per sample
+                    input.readInt();   // channel mask
+                    formatTag = (unsigned short) input.readShort(); // first two bytes of the sub-format GUID
+                    bytesUsed = 26;
+                }
+
+                if (formatTag != 1 && formatTag != 3)
+                {
+                    errorMessage = "Unsupported WAV encoding";
+                    return false;
+                }
+
+                isFloat = (formatTag == 3);
+                foundFormat = format.numChannels > 0 && format.sampleRate > 0;
+                input.skipNextBytes ((int64) length - bytesUsed + (length & 1));
+            }
+            else
+            {
+                input.skipNextBytes ((int64) length + (length & 1));
+            }
+        }
+
+        errorMessage = "The WAV stream has no readable format or data chunk";
+        return false;
+    }
+
+    /** Writes a WAV header with the sizes set to 0xffffffff, as is the convention for
+        streams whose length isn't known when they start.
+    */
+    static void writeWavHeader (OutputStream& output, const CommandLineRenderer::StreamFormat& format)
+    {
+        const bool isFloat = (format.sampleFormat == CommandLineRenderer::float32);
+        const int bytesPerFrame = format.getBytesPerFrame();
+
+        output.writeInt ((int) ByteOrder::littleEndianInt ("RIFF"));
+        output.writeInt (-1);
+        output.writeInt ((int) ByteOrder::littleEndianInt ("WAVE"));
+        output.writeInt ((int) ByteOrder::littleEndianInt ("fmt "));
+        output.writeInt (isFloat ? 18 : 16);
+        output.writeShort ((short) (isFloat ? 3 : 1));
+        output.writeShort ((short) format.numChannels);
+        output.writeInt (roundToInt (format.sampleRate));
+        output.writeInt (roundToInt (format.sampleRate) * bytesPerFrame);
+        output.writeShort ((short) bytesPerFrame);
+        output.writeShort ((short) getBitsPerSample (format.sampleFormat));
+
+        if (isFloat)
+            output.writeShort (0);
+
+        output.writeInt ((int) ByteOrder::littleEndianInt ("data"));
+        output.writeInt (-1);
+    }
+
+    //==============================================================================
+    class StandardInputStream  : public InputStream
+    {
+    public:
+        StandardInputStream() : position (0), exhausted (false)
+        {
+           #if JUCE_WINDOWS
+            _setmode (_fileno (stdin), _O_BINARY);
+           #endif
+        }
+
+        int64 getTotalLength()                  { return -1; }
+        bool isExhausted()                      { return exhausted; }
+        int64 getPosition()                     { return position; }
+        bool setPosition (int64 newPos)         { return newPos == position; }
+
+        int read (void* destBuffer, int maxBytesToRead)
+        {
+            const int numRead = (int) fread (destBuffer, 1, (size_t) maxBytesToRead, stdin);
+
+            if (numRead < maxBytesToRead)
+                exhausted = true;
+
+            position += numRead;
+            return numRead;
+        }
+
+    private:
+        int64 position;
+        bool exhausted;
+
+        JUCE_DECLARE_NON_COPYABLE (StandardInputStream)
+    };
+
+    class StandardOutputStream  : public OutputStream
+    {
+    public:
+        StandardOutputStream() : position (0)
+        {
+           #if JUCE_WINDOWS
+            _setmode (_fileno (stdout), _O_BINARY);
+           #endif
+        }
+
+        ~StandardOutputStream()                 { flush(); }
+
+        void flush()                            { fflush (stdout); }
+        int64 getPosition()                     { return position; }
+        bool setPosition (int64 newPos)         { return newPos == position; }
+
+        bool write (const void* data, size_t numBytes)
+        {
+            const size_t numWritten = fwrite (data, 1, numBytes, stdout);
+            position += (int64) numWritten;
+            return numWritten == numBytes;
+        }
+
+    private:
+        int64 position;
+
+        JUCE_DECLARE_NON_COPYABLE (StandardOutputStream)
+    };
+}
+
+//==============================================================================
+CommandLineRenderer::StreamFormat::StreamFormat() noexcept
+    : isWav (false), sampleFormat (float32), numChannels (2), sampleRate (44100.0)
+{
+}
+
+int CommandLineRenderer::StreamFormat::getBytesPerFrame() const noexcept
+{
+    return numChannels * PipeHelpers::getBitsPerSample (sampleFormat) / 8;
+}
+
+bool CommandLineRenderer::parseSampleFormat (const String& name, SampleFormat& result)
+{
+    const String n (name.trim().toLowerCase());
+
+    if (n == "f32" || n == "float")     { result = float32; return true; }
+    if (n == "s16" || n == "16")        { result = int16;   return true; }
+    if (n == "s24" || n == "24")        { result = int24;   return true; }
+    if (n == "s32" || n == "32")        { result = int32;   return true; }
+
+    return false;
+}
+
+InputStream* CommandLineRenderer::createStandardInputStream()    { return new PipeHelpers::StandardInputStream(); }
+OutputStream* CommandLineRenderer::createStandardOutputStream()  { return new PipeHelpers::StandardOutputStream(); }
+
+//==============================================================================
+/*  The FIFO that connects two of the pipeline's threads. The data goes through an
+    AudioRingBuffer, so neither side takes a lock; this just adds the blocking and the
+    end-of-stream and abort flags.
+*/
+class CommandLineRenderer::PipeFifo
+{
+public:
+    PipeFifo (int numChannels, int capacity)
+        : ring (numChannels, capacity)
+    {
+    }
+
+    /** Called by the producer. Blocks while the FIFO is full. */
+    bool write (const AudioSampleBuffer& source, int startSample, int numSamples, Thread& caller)
+    {
+        while (numSamples > 0)
+        {
+            if (isAborted())
+                return false;
+
+            const int numDone = ring.write (source, startSample, numSamples);
+
+            if (numDone == 0)
+            {
+                if (caller.threadShouldExit())
+                    return false;
+
+                ring.waitForSpace (1, 100);
+                continue;
+            }
+
+            startSample += numDone;
+            numSamples -= numDone;
+        }
+
+        return true;
+    }
+
+    /** Called by the consumer. Blocks until at least minSamples are ready, or until the
+        producer has finished, and then reads up to maxSamples. Returns the number read,
+        which is 0 only when the producer has finished and the FIFO is empty.
+    */
+    int read (AudioSampleBuffer& dest, int minSamples, int maxSamples, Thread& caller)
+    {
+        for (;;)
+        {
+            if (isAborted() || caller.threadShouldExit())
+                return 0;
+
+            const bool producerFinished = isFinished();
+            const int numReady = ring.getNumReady();
+
+            if (numReady >= minSamples || (producerFinished && numReady > 0))
+                return ring.read (dest, 0, jmin (numReady, maxSamples));
+
+            if (producerFinished)
+                return 0;
+
+            ring.waitForData (minSamples, 100);
+        }
+    }
+
+    void setFinished()              { finished = 1; ring.releaseWaitingThreads(); }
+    bool isFinished() const         { return finished.get() != 0; }
+
+    void abort()                    { aborted = 1; ring.releaseWaitingThreads(); }
+    bool isAborted() const          { return aborted.get() != 0; }
+
+private:
+    AudioRingBuffer ring;
+    Atomic<int> finished, aborted;
+
+    JUCE_DECLARE_NON_COPYABLE (PipeFifo)
+};
+
+//==============================================================================
+class CommandLineRenderer::ReaderThread  : public Thread
+{
+public:
+    ReaderThread (InputStream& in, const StreamFormat& f, PipeFifo& dest, int framesPerChunk,
+                  PolyphaseResampler* resampler_)
+        : Thread ("Pipe reader"), input (in), format (f), output (dest),
+          bytesPerFrame (f.getBytesPerFrame()),
+          chunk (f.numChannels, framesPerChunk),
+          resampledChunk (f.numChannels, framesPerChunk),
+          rawData ((size_t) (framesPerChunk * bytesPerFrame)),
+          resampler (resampler_),
+          numFramesIn (0), numFramesOut (0)
+    {
+    }
+
+    void run()
+    {
+        const int chunkBytes = chunk.getNumSamples() * bytesPerFrame;
+        int bytesInBuffer = 0;
+
+        while (! threadShouldExit())
+        {
+            int numRead;
+
+            {
+                JUCE_TRACE_SCOPE ("CommandLineRenderer read");
+                numRead = input.read (rawData + bytesInBuffer, chunkBytes - bytesInBuffer);
+            }
+
+            if (numRead <= 0)
+                break;
+
+            bytesInBuffer += numRead;
+            const int numFrames = bytesInBuffer / bytesPerFrame;
+
+            if (numFrames > 0)
+            {
+                PipeHelpers::convertToFloat (format.sampleFormat, rawData, chunk, format.numChannels, numFrames);
+
+                if (! writeToFifo (numFrames))
+                    break;
+
+                // keep hold of any trailing partial frame until the rest of it arrives
+                const int bytesUsed = numFrames * bytesPerFrame;
+                bytesInBuffer -= bytesUsed;
+                memmove (rawData, rawData + bytesUsed, (size_t) bytesInBuffer);
+            }
+        }
+
+        if (resampler != nullptr)
+            flushResampler();
+
+        output.setFinished();
+    }
+
+private:
+    InputStream& input;
+    const StreamFormat format;
+    PipeFifo& output;
+    const int bytesPerFrame;
+    AudioSampleBuffer chunk, resampledChunk;
+    HeapBlock<char> rawData;
+    PolyphaseResampler* const resampler;
+    int64 numFramesIn, numFramesOut;
+
+    bool writeToFifo (const int numFrames)
+    {
+        numFramesIn += numFrames;
+
+        if (resampler == nullptr)
+            return output.write (chunk, 0, numFrames, *this);
+
+        resampler->pushSamples (chunk.getArrayOfChannels(), numFrames);
+        return writeResampled (std::numeric_limits<int64>::max());
+    }
+
+    bool writeResampled (const int64 maxFramesOut)
+    {
+        for (;;)
+        {
+            const int numToPull = (int) jmin ((int64) resampledChunk.getNumSamples(), maxFramesOut - numFramesOut);
+            const int numDone = resampler->pullSamples (resampledChunk.getArrayOfChannels(), numToPull);
+
+            if (numDone == 0)
+                return true;
+
+            numFramesOut += numDone;
+
+            if (! output.write (resampledChunk, 0, numDone, *this))
+                return false;
+        }
+    }
+
+    void flushResampler()
+    {
+        // the filter's look-ahead means the last few outputs need some silence after the input
+        const int64 expectedFramesOut = resampler->getNumOutputSamplesFor (numFramesIn);
+
+        while (numFramesOut < expectedFramesOut && ! threadShouldExit())
+        {
+            resampler->pushSilence (resampler->getNumInputSamplesNeeded ((int) jmin ((int64) resampledChunk.getNumSamples(),
+                                                                                      expectedFramesOut - numFramesOut)));
+            if (! writeResampled (expectedFramesOut))
+                break;
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (ReaderThread)
+};
+
+//==============================================================================
+class CommandLineRenderer::ProcessorThread  : public Thread
+{
+public:
+    ProcessorThread (AudioProcessor& p, PipeFifo& in, PipeFifo& out, int numChannels, int blockSize)
+        : Thread ("Pipe processor"), processor (p), input (in), output (out),
+          block (numChannels, blockSize)
+    {
+    }
+
+    void run()
+    {
+        const int blockSize = block.getNumSamples();
+
+        // The processor's latency is trimmed from the start of the output, and made up
+        // for by feeding it that much silence once the input runs out.
+        int numToSkip = processor.getLatencySamples();
+        int numTailSamples = numToSkip;
+
+        for (;;)
+        {
+            int numValid = input.read (block, blockSize, blockSize, *this);
+
+            if (numValid == 0)
+            {
+                if (numTailSamples <= 0 || input.isAborted() || threadShouldExit())
+                    break;
+
+                numValid = jmin (blockSize, numTailSamples);
+                numTailSamples -= numValid;
+                block.clear();
+            }
+            else if (numValid < blockSize)
+            {
+                // the silence that pads out the last block also counts towards the tail
+                const int numPadded = blockSize - numValid;
+                block.clear (numValid, numPadded);
+
+                const int numTailInBlock = jmin (numPadded, numTailSamples);
+                numTailSamples -= numTailInBlock;
+                numValid += numTailInBlock;
+            }
+
+            {
+                const AudioProcessorTimingStats::ScopedBlockTimer blockTimer (processor.getTimingStats(), blockSize,
+                                                                              processor.getSampleRate());
+                const AudioProcessorTimingStats::ScopedDenormalGuard denormalGuard (processor.getTimingStats(), block);
+                JUCE_TRACE_SCOPE ("processBlock");
+                JUCE_REALTIME_THREAD_SCOPE;
+                processor.processBlock (block, midi);
+            }
+
+            midi.clear();
+
+            const int skipped = jmin (numToSkip, numValid);
+            numToSkip -= skipped;
+
+            if (! output.write (block, skipped, numValid - skipped, *this))
+                break;
+        }
+
+        output.setFinished();
+    }
+
+private:
+    AudioProcessor& processor;
+    PipeFifo& input;
+    PipeFifo& output;
+    AudioSampleBuffer block;
+    MidiBuffer midi;
+
+    JUCE_DECLARE_NON_COPYABLE (ProcessorThread)
+};
+
+//==============================================================================
+class CommandLineRenderer::WriterThread  : public Thread
+{
+public:
+    WriterThread (OutputStream& out, const StreamFormat& f, PipeFifo& source, int framesPerChunk)
+        : Thread ("Pipe writer"), output (out), format (f), input (source),
+          bytesPerFrame (f.getBytesPerFrame()),
+          chunk (f.numChannels, framesPerChunk),
+          rawData ((size_t) (framesPerChunk * bytesPerFrame)),
+          failed (false)
+    {
+    }
+
+    void run()
+    {
+        for (;;)
+        {
+            // take whatever's ready, rather than waiting for a full chunk, to keep the latency down
+            const int numFrames = input.read (chunk, 1, chunk.getNumSamples(), *this);
+
+            if (numFrames == 0)
+                break;
+
+            PipeHelpers::convertFromFloat (format.sampleFormat, chunk, 0, rawData, format.numChannels, numFrames);
+            JUCE_TRACE_SCOPE ("CommandLineRenderer write");
+
+            if (! output.write (rawData, (size_t) (numFrames * bytesPerFrame)))
+            {
+                failed = true;
+                input.abort();
+                break;
+            }
+
+            output.flush();
+        }
+    }
+
+    bool hasFailed() const noexcept     { return failed; }
+
+private:
+    OutputStream& output;
+    const StreamFormat format;
+    PipeFifo& input;
+    const int bytesPerFrame;
+    AudioSampleBuffer chunk;
+    HeapBlock<char> rawData;
+    bool failed;
+
+    JUCE_DECLARE_NON_COPYABLE (WriterThread)
+};
+
+//==============================================================================
+CommandLineRenderer::CommandLineRenderer (AudioProcessor& p, int blockSize_)
+    : processor (p), blockSize (jmax (1, blockSize_)),
+      targetSampleRate (0), resamplingQuality (PolyphaseResampler::highQuality),
+      renderCache (nullptr), fastPathsEnabled (true),
+      numSamplesSkipped (0), numSamplesProcessed (0)
+{
+}
+
+CommandLineRenderer::~CommandLineRenderer()
+{
+}
+
+void CommandLineRenderer::setProcessingSampleRate (const double newRate, const PolyphaseResampler::Quality quality)
+{
+    targetSampleRate = newRate;
+    resamplingQuality = quality;
+}
+
+void CommandLineRenderer::setRenderCache (RenderCache* const newCache) noexcept
+{
+    renderCache = newCache;
+}
+
+void CommandLineRenderer::setFastPathsEnabled (const bool shouldBeEnabled) noexcept
+{
+    fastPathsEnabled = shouldBeEnabled;
+}
+
+PolyphaseResampler* CommandLineRenderer::createResampler (const int numChannels, const double sourceRate) const
+{
+    if (targetSampleRate <= 0 || targetSampleRate == sourceRate)
+        return nullptr;
+
+    PolyphaseResampler* const r = new PolyphaseResampler (numChannels, resamplingQuality);
+    r->setRates (sourceRate, targetSampleRate);
+    return r;
+}
+
+static void readBlockFromReader (AudioFormatReader& reader, AudioSampleBuffer& block, const int64 startSample)
+{
+    const int numChannels = block.getNumChannels();
+    const int numSamples = block.getNumSamples();
+
+    // reading past the end of the source just gives silence, which flushes any latency tail
+    reader.read (reinterpret_cast<int* const*> (block.getArrayOfChannels()), numChannels, startSample, numSamples, false);
+
+    if (! reader.usesFloatingPointData)
+        for (int ch = 0; ch < numChannels; ++ch)
+            FloatVectorOperations::convertFixedToFloat (block.getSampleData (ch),
+                                                        reinterpret_cast<const int*> (block.getSampleData (ch)),
+                                                        1.0f / 0x7fffffff, numSamples);
+}
+
+void CommandLineRenderer::prepareProcessor (int numInputs, int numOutputs, double sampleRate)
+{
+    processor.setNonRealtime (true);
+    processor.setPlayConfigDetails (numInputs, numOutputs, sampleRate, blockSize);
+    processor.prepareToPlay (sampleRate, blockSize);
+}
+
+//==============================================================================
+String CommandLineRenderer::getCacheKey (const File& inputFile, const File& outputFile, const bool isCentreOutput)
+{
+    MemoryBlock state;
+    processor.getStateInformation (state);
+
+    // Everything apart from the input and the processor's state that can change the output
+    String settings;
+    settings << processor.getName() << ' ' << JucePlugin_VersionString
+             << "\nblock " << blockSize
+             << "\nrate " << targetSampleRate << ' ' << (int) resamplingQuality
+             << "\nformat " << outputFile.getFileExtension().toLowerCase();
+
+    if (isCentreOutput)
+        settings << "\ncentre output";
+
+    return RenderCache::createKey (inputFile, state, settings);
+}
+
+bool CommandLineRenderer::renderFile (const File& inputFile, const File& outputFile, String& errorMessage)
+{
+    return renderFile (inputFile, outputFile, File::nonexistent, errorMessage);
+}
+
+bool CommandLineRenderer::renderFile (const File& inputFile, const File& outputFile,
+                                      const File& centreOutputFile, String& errorMessage)
+{
+    const bool wantsCentre = centreOutputFile != File::nonexistent;
+
+    if (renderCache == nullptr)
+        return renderFileUncached (inputFile, outputFile, centreOutputFile, errorMessage);
+
+    const String key (getCacheKey (inputFile, outputFile, false));
+    const String centreKey (wantsCentre ? getCacheKey (inputFile, centreOutputFile, true) : String::empty);
+
+    if (renderCache->fetch (key, outputFile)
+         && ((! wantsCentre) || renderCache->fetch (centreKey, centreOutputFile)))
+        return true;
+
+    if (! renderFileUncached (inputFile, outputFile, centreOutputFile, errorMessage))
+        return false;
+
+    // (a cache that can't be written to shouldn't stop the render from succeeding)
+    renderCache->store (key, outputFile);
+
+    if (wantsCentre)
+        renderCache->store (centreKey, centreOutputFile);
+
+    return true;
+}
+
+static AudioFormatWriter* createWriterFor (AudioFormatManager& formatManager, const File& file,
+                                           const AudioFormatReader& reader, const double sampleRate,
+                                           const int numChannels, String& errorMessage)
+{
+    AudioFormat* const format = formatManager.findFormatForFileExtension (file.getFileExtension());
+
+    if (format == nullptr)
+    {
+        errorMessage = "Unknown output file type: " + file.getFileExtension();
+        return nullptr;
+    }
+
+    const Array<int> bitDepths (format->getPossibleBitDepths());
+    const int bitDepth = bitDepths.contains ((int) reader.bitsPerSample) ? (int) reader.bitsPerSample
+                                                                          : bitDepths.getLast();
+
+    file.deleteFile();
+    ScopedPointer<FileOutputStream> outStream (file.createOutputStream());
+
+    if (outStream == nullptr)
+    {
+        errorMessage = "Couldn't create the output file: " + file.getFullPathName();
+        return nullptr;
+    }
+
+    AudioFormatWriter* const writer = format->createWriterFor (outStream, sampleRate, (unsigned int) numChannels,
+                                                               bitDepth, StringPairArray(), 0);
+    if (writer == nullptr)
+    {
+        errorMessage = "The output format doesn't support this channel layout or bit depth";
+        return nullptr;
+    }
+
+    outStream.release();
+    return writer;
+}
+
+bool CommandLineRenderer::renderFileUncached (const File& inputFile, const File& outputFile,
+                                              const File& centreOutputFile, String& errorMessage)
+{
+    AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    ScopedPointer<AudioFormatReader> reader (formatManager.createReaderFor (inputFile));
+
+    if (reader == nullptr)
+    {
+        errorMessage = "Couldn't open the input file: " + inputFile.getFullPathName();
+        return false;
+    }
+
+    const int numChannels = (int) reader->numChannels;
+    ScopedPointer<PolyphaseResampler> resampler (createResampler (numChannels, reader->sampleRate));
+    const double processingRate = resampler != nullptr ? targetSampleRate : reader->sampleRate;
+
+    // With a centre output, the processor is given twice as many outputs as inputs, and
+    // writes the extracted centre into the second half of them.
+    const int numOutputs = centreOutputFile != File::nonexistent ? numChannels * 2 : numChannels;
+    prepareProcessor (numChannels, numOutputs, processingRate);
+
+    InputClassifier::FastPath fastPath;
+
+    if (findFastPath (*reader, fastPath))
+    {
+        const bool ok = renderFastPath (formatManager, *reader, resampler, processingRate, fastPath,
+                                        inputFile, outputFile, centreOutputFile, errorMessage);
+        processor.releaseResources();
+        return ok;
+    }
+
+    ScopedPointer<AudioFormatWriter> writer (createWriterFor (formatManager, outputFile, *reader,
+                                                              processingRate, numChannels, errorMessage));
+    if (writer == nullptr)
+        return false;
+
+    ScopedPointer<AudioFormatWriter> centreWriter;
+
+    if (centreOutputFile != File::nonexistent)
+    {
+        centreWriter = createWriterFor (formatManager, centreOutputFile, *reader,
+                                        processingRate, numChannels, errorMessage);
+        if (centreWriter == nullptr)
+            return false;
+    }
+
+    AudioSampleBuffer block (numOutputs, blockSize);
+    AudioSampleBuffer inputBlock (block.getArrayOfChannels(), numChannels, blockSize);
+    AudioSampleBuffer centreBlock (block.getArrayOfChannels() + (numOutputs - numChannels), numChannels, blockSize);
+    AudioSampleBuffer sourceBlock (numChannels, blockSize);
+    MidiBuffer midi;
+    const int64 totalLength = resampler != nullptr ? resampler->getNumOutputSamplesFor (reader->lengthInSamples)
+                                                   : reader->lengthInSamples;
+    int64 sourcePos = 0;
+    int numToSkip = processor.getLatencySamples();
+    bool ok = true;
+
+    for (int64 pos = 0; ok && pos < totalLength + processor.getLatencySamples(); pos += blockSize)
+    {
+        const int numValid = (int) jmin ((int64) blockSize, totalLength + processor.getLatencySamples() - pos);
+
+        if (resampler != nullptr)
+        {
+            while (resampler->getNumOutputSamplesAvailable() < blockSize)
+            {
+                readBlockFromReader (*reader, sourceBlock, sourcePos);
+                sourcePos += blockSize;
+                resampler->pushSamples (sourceBlock.getArrayOfChannels(), blockSize);
+            }
+
+            resampler->pullSamples (inputBlock.getArrayOfChannels(), blockSize);
+        }
+        else
+        {
+            readBlockFromReader (*reader, inputBlock, pos);
+        }
+
+        {
+            const AudioProcessorTimingStats::ScopedBlockTimer blockTimer (processor.getTimingStats(), blockSize,
+                                                                          processor.getSampleRate());
+            const AudioProcessorTimingStats::ScopedDenormalGuard denormalGuard (processor.getTimingStats(), block);
+            JUCE_TRACE_SCOPE ("processBlock");
+            JUCE_REALTIME_THREAD_SCOPE;
+            processor.processBlock (block, midi);
+        }
+
+        midi.clear();
+
+        const int skipped = jmin (numToSkip, numValid);
+        numToSkip -= skipped;
+
+        if (numValid > skipped)
+        {
+            ok = writer->writeFromAudioSampleBuffer (inputBlock, skipped, numValid - skipped);
+
+            if (ok && centreWriter != nullptr)
+                ok = centreWriter->writeFromAudioSampleBuffer (centreBlock, skipped, numValid - skipped);
+        }
+    }
+
+    processor.releaseResources();
+    numSamplesProcessed += totalLength;
+
+    if (! ok)
+        errorMessage = "Failed to write to the output file";
+
+    return ok;
+}
+
+bool CommandLineRenderer::findFastPath (AudioFormatReader& reader, InputClassifier::FastPath& result)
+{
+    InputClassifier::Client* const client = dynamic_cast <InputClassifier::Client*> (&processor);
+
+    if (client == nullptr || ! fastPathsEnabled)
+        return false;
+
+    // (this is only a read and a few compares per sample, and it stops as soon as
+    // anything turns up that needs processing)
+    InputClassifier classifier;
+    classifier.setLayout (client->getClassifierLayout());
+
+    const int numChannels = (int) reader.numChannels;
+    AudioSampleBuffer block (numChannels, blockSize);
+
+    for (int64 pos = 0; pos < reader.lengthInSamples; pos += blockSize)
+    {
+        readBlockFromReader (reader, block, pos);
+        const int numValid = (int) jmin ((int64) blockSize, reader.lengthInSamples - pos);
+
+        if (! classifier.addBlock (block.getArrayOfChannels(), numChannels, numValid))
+            break;
+    }
+
+    lastInputDescription = classifier.getDescription();
+
+    return classifier.isSpecialCase()
+            && client->getFastPath (classifier, result, true);
+}
+
+bool CommandLineRenderer::renderFastPath (AudioFormatManager& formatManager, AudioFormatReader& reader,
+                                          PolyphaseResampler* const resampler, const double processingRate,
+                                          const InputClassifier::FastPath& path, const File& inputFile,
+                                          const File& outputFile, const File& centreOutputFile,
+                                          String& errorMessage)
+{
+    const int numChannels = (int) reader.numChannels;
+    const bool wantsCentre = centreOutputFile != File::nonexistent;
+    const int64 totalLength = resampler != nullptr ? resampler->getNumOutputSamplesFor (reader.lengthInSamples)
+                                                   : reader.lengthInSamples;
+
+    // An output that's an exact copy of the input, in the same format, doesn't need
+    // decoding or encoding at all
+    bool needsOutput = true;
+    bool needsCentreOutput = wantsCentre;
+
+    if (resampler == nullptr && path.isCopyOfInput (0, numChannels)
+         && inputFile.hasFileExtension (outputFile.getFileExtension()))
+    {
+        if (! inputFile.copyFileTo (outputFile))
+        {
+            errorMessage = "Couldn't create the output file: " + outputFile.getFullPathName();
+            return false;
+        }
+
+        needsOutput = false;
+    }
+
+    if (wantsCentre && resampler == nullptr && path.isCopyOfInput (numChannels, numChannels)
+         && inputFile.hasFileExtension (centreOutputFile.getFileExtension()))
+    {
+        if (! inputFile.copyFileTo (centreOutputFile))
+        {
+            errorMessage = "Couldn't create the output file: " + centreOutputFile.getFullPathName();
+            return false;
+        }
+
+        needsCentreOutput = false;
+    }
+
+    ScopedPointer<AudioFormatWriter> writer, centreWriter;
+
+    if (needsOutput && (writer = createWriterFor (formatManager, outputFile, reader, processingRate,
+                                                  numChannels, errorMessage)) == nullptr)
+        return false;
+
+    if (needsCentreOutput && (centreWriter = createWriterFor (formatManager, centreOutputFile, reader, processingRate,
+                                                              numChannels, errorMessage)) == nullptr)
+        return false;
+
+    // Silent outputs don't need the input to be read either
+    const bool needsInput = (needsOutput && ! path.isSilent (0, numChannels))
+                             || (needsCentreOutput && ! path.isSilent (numChannels, numChannels));
+
+    AudioSampleBuffer block (wantsCentre ? numChannels * 2 : numChannels, blockSize);
+    AudioSampleBuffer outputBlock (block.getArrayOfChannels(), numChannels, blockSize);
+    AudioSampleBuffer centreBlock (block.getArrayOfChannels() + (wantsCentre ? numChannels : 0), numChannels, blockSize);
+    AudioSampleBuffer inputBlock (numChannels, blockSize);
+    AudioSampleBuffer sourceBlock (numChannels, blockSize);
+    inputBlock.clear();
+
+    int64 sourcePos = 0;
+    bool ok = true;
+
+    for (int64 pos = 0; ok && (writer != nullptr || centreWriter != nullptr) && pos < totalLength; pos += blockSize)
+    {
+        const int numValid = (int) jmin ((int64) blockSize, totalLength - pos);
+
+        if (needsInput && resampler != nullptr)
+        {
+            while (resampler->getNumOutputSamplesAvailable() < blockSize)
+            {
+                readBlockFromReader (reader, sourceBlock, sourcePos);
+                sourcePos += blockSize;
+                resampler->pushSamples (sourceBlock.getArrayOfChannels(), blockSize);
+            }
+
+            resampler->pullSamples (inputBlock.getArrayOfChannels(), blockSize);
+        }
+        else if (needsInput)
+        {
+            readBlockFromReader (reader, inputBlock, pos);
+        }
+
+        path.apply (inputBlock.getArrayOfChannels(), block.getArrayOfChannels(), blockSize);
+
+        if (writer != nullptr)
+            ok = writer->writeFromAudioSampleBuffer (outputBlock, 0, numValid);
+
+        if (ok && centreWriter != nullptr)
+            ok = centreWriter->writeFromAudioSampleBuffer (centreBlock, 0, numValid);
+    }
+
+    numSamplesSkipped += totalLength;
+
+    if (! ok)
+        errorMessage = "Failed to write to the output file";
+
+    return ok;
+}
+
+//==============================================================================
+bool CommandLineRenderer::renderPipe (InputStream& input, OutputStream& output,
+                                      const StreamFormat& requestedInputFormat,
+                                      const StreamFormat& requestedOutputFormat,
+                                      String& errorMessage)
+{
+    StreamFormat inputFormat (requestedInputFormat);
+
+    if (inputFormat.isWav && ! PipeHelpers::readWavHeader (input, inputFormat, errorMessage))
+        return false;
+
+    if (inputFormat.numChannels <= 0 || inputFormat.sampleRate <= 0)
+    {
+        errorMessage = "Invalid input channel count or sample rate";
+        return false;
+    }
+
+    ScopedPointer<PolyphaseResampler> resampler (createResampler (inputFormat.numChannels, inputFormat.sampleRate));
+
+    StreamFormat outputFormat (requestedOutputFormat);
+    outputFormat.numChannels = inputFormat.numChannels;
+    outputFormat.sampleRate = resampler != nullptr ? targetSampleRate : inputFormat.sampleRate;
+
+    if (outputFormat.isWav)
+        PipeHelpers::writeWavHeader (output, outputFormat);
+
+    prepareProcessor (outputFormat.numChannels, outputFormat.numChannels, outputFormat.sampleRate);
+
+    // Each FIFO holds a few blocks, so the stages can run ahead of each other a little
+    // without the overall latency growing unbounded.
+    const int fifoSize = blockSize * 4;
+    PipeFifo rawFifo (inputFormat.numChannels, fifoSize);
+    PipeFifo processedFifo (inputFormat.numChannels, fifoSize);
+
+    ReaderThread readerThread (input, inputFormat, rawFifo, blockSize, resampler);
+    ProcessorThread processorThread (processor, rawFifo, processedFifo, inputFormat.numChannels, blockSize);
+    WriterThread writerThread (output, outputFormat, processedFifo, blockSize);
+
+    writerThread.startThread();
+    processorThread.startThread();
+    readerThread.startThread();
+
+    writerThread.waitForThreadToExit (-1);
+
+    if (writerThread.hasFailed())
+    {
+        rawFifo.abort();
+        errorMessage = "Failed to write to the output stream";
+    }
+
+    // if the writer gave up, the reader may be stuck waiting for input that will never be used
+    processorThread.stopThread (2000);
+    readerThread.stopThread (2000);
+
+    processor.releaseResources();
+    output.flush();
+
+    return ! writerThread.hasFailed();
+}
@@ -0,0 +1,181 @@
+/*
+  ==============================================================================
+
+    CommandLineRenderer.h
+
+    Runs the plugin's processor over files or streams, outside of a host.
+
+  ==============================================================================
+*/
+
+#ifndef __COMMANDLINERENDERER_H_5B1E7C2A__
+#define __COMMANDLINERENDERER_H_5B1E7C2A__
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "RenderCache.h"
+#include "InputClassifier.h"
+
+
+//==============================================================================
+/**
+    Renders audio through an AudioProcessor without a host.
+
+    renderFile() processes one audio file into another. renderPipe() processes a
+    stream of raw interleaved PCM, or a WAV stream of unknown length, from one
+    unseekable stream to another (e.g. stdin to stdout). In pipe mode the reading,
+    processing and writing each run on their own thread, connected by lock-free
+    FIFOs, so that the stages overlap and the latency stays bounded by the FIFO size.
+
+    The processor is always called with blocks of exactly the block size given to
+    the constructor; a short final block is padded with silence, and the padding
+    is dropped again from the output.
+
+    If the processor is an InputClassifier::Client, renderFile() first scans the
+    input, and if it's a special case whose result the processor can describe (a
+    silent or dual-mono file, for example), the output is produced directly from
+    the input without running the processor. When the output would be identical to
+    the input, and in the same format, the file is simply copied.
+*/
+class CommandLineRenderer
+{
+public:
+    //==============================================================================
+    /** The sample encodings that can be used for raw PCM streams. */
+    enum SampleFormat
+    {
+        float32 = 0,
+        int16,
+        int24,
+        int32
+    };
+
+    /** Describes the layout of a stream that's passed to renderPipe(). */
+    struct StreamFormat
+    {
+        StreamFormat() noexcept;
+
+        /** Returns the number of bytes used by one sample frame. */
+        int getBytesPerFrame() const noexcept;
+
+        /** If true, the stream starts with a WAV header. When reading, the header's
+            format overrides the other fields.
+        */
+        bool isWav;
+        SampleFormat sampleFormat;
+        int numChannels;
+        double sampleRate;
+    };
+
+    /** Parses a name like "f32", "s16", "s24" or "s32". Returns false if it isn't recognised. */
+    static bool parseSampleFormat (const String& name, SampleFormat& result);
+
+    //==============================================================================
+    /** Creates a renderer that will drive the given processor. */
+    CommandLineRenderer (AudioProcessor& processor, int blockSize = 1024);
+
+    /** Destructor. */
+    ~CommandLineRenderer();
+
+    //==============================================================================
+    /** Makes the renderer convert its input to the given sample rate before passing
+        it to the processor. The output is then written at this rate too.
+
+        @param newRate  the rate to process at, or 0 to use the input's own rate
+        @param quality  the quality of the resampling filter to use
+    */
+    void setProcessingSampleRate (double newRate,
+                                  PolyphaseResampler::Quality quality = PolyphaseResampler::highQuality);
+
+    /** Makes renderFile() look up its results in a cache before rendering them, and add
+        any new renders to it. The cache isn't owned by the renderer, and can be null.
+    */
+    void setRenderCache (RenderCache* newCache) noexcept;
+
+    /** Chooses whether renderFile() looks for inputs that don't need processing. This
+        is on by default; the output is the same either way.
+    */
+    void setFastPathsEnabled (bool shouldBeEnabled) noexcept;
+
+    /** Returns the number of output samples that renderFile() has produced without
+        running the processor, because the input was a special case.
+    */
+    int64 getNumSamplesSkipped() const noexcept             { return numSamplesSkipped; }
+
+    /** Returns the number of output samples that renderFile() has run the processor for. */
+    int64 getNumSamplesProcessed() const noexcept           { return numSamplesProcessed; }
+
+    /** Returns a description of the last input that was scanned, like "dual-mono". */
+    const String& getLastInputDescription() const noexcept  { return lastInputDescription; }
+
+    //==============================================================================
+    /** Processes an audio file into a new file. The output format is chosen from the
+        output file's extension, and uses the same bit depth as the input where possible.
+
+        If a render cache has been set and already holds this render, the output is just
+        linked or copied from the cache, and the input isn't decoded at all.
+    */
+    bool renderFile (const File& inputFile, const File& outputFile, String& errorMessage);
+
+    /** Processes an audio file into two new files: the processor's normal output, and
+        the extracted centre.
+
+        The processor is run with twice as many outputs as inputs, and is expected to
+        write the centre into the second half of its outputs, which go to centreOutputFile.
+        Both outputs come from the same pass through the processor.
+    */
+    bool renderFile (const File& inputFile, const File& outputFile,
+                     const File& centreOutputFile, String& errorMessage);
+
+    /** Processes a stream of audio until the input runs out.
+
+        @param input            the stream to read from. It doesn't need to be seekable.
+        @param output           the stream to write to. It doesn't need to be seekable.
+        @param inputFormat      the layout of the input data. If isWav is true, the actual
+                                format is read from the stream's header.
+        @param outputFormat     the encoding to write. Its channel count and sample rate are
+                                ignored: the output has the input's channels, at the rate
+                                set by setProcessingSampleRate() or else the input's rate.
+    */
+    bool renderPipe (InputStream& input, OutputStream& output,
+                     const StreamFormat& inputFormat, const StreamFormat& outputFormat,
+                     String& errorMessage);
+
+    //==============================================================================
+    /** Creates a stream that reads from the process's standard input. */
+    static InputStream* createStandardInputStream();
+
+    /** Creates a stream that writes to the process's standard output. */
+    static OutputStream* createStandardOutputStream();
+
+private:
+    //==============================================================================
+    AudioProcessor& processor;
+    const int blockSize;
+    double targetSampleRate;
+    PolyphaseResampler::Quality resamplingQuality;
+    RenderCache* renderCache;
+    bool fastPathsEnabled;
+    int64 numSamplesSkipped, numSamplesProcessed;
+    String lastInputDescription;
+
+    class PipeFifo;
+    class ReaderThread;
+    class ProcessorThread;
+    class WriterThread;
+
+    void prepareProcessor (int numInputs, int numOutputs, double sampleRate);
+    bool renderFileUncached (const File& inputFile, const File& outputFile,
+                             const File& centreOutputFile, String& errorMessage);
+    bool findFastPath (AudioFormatReader& reader, InputClassifier::FastPath& result);
+    bool renderFastPath (AudioFormatManager& formatManager, AudioFormatReader& reader,
+                         PolyphaseResampler* resampler, double processingRate,
+                         const InputClassifier::FastPath& path, const File& inputFile,
+                         const File& outputFile, const File& centreOutputFile, String& errorMessage);
+    String getCacheKey (const File& inputFile, const File& outputFile, bool isCentreOutput);
+    PolyphaseResampler* createResampler (int numChannels, double sourceRate) const;
+
+    JUCE_DECLARE_NON_COPYABLE (CommandLineRenderer)
+};
+
+
+#endif  // __COMMANDLINERENDERER_H_5B1E7C2A__
@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    FixedBlockAdapter.cpp
+
+    Turns the host's variable-sized blocks into fixed-sized ones.
+
+  ==============================================================================
+*/
+
+#include "FixedBlockAdapter.h"
+
+
+//==============================================================================
+namespace FixedBlockHelpers
+{
+    enum { alignment = 32 };
+
+    static bool isAligned (const float* data) noexcept
+    {
+        return (((pointer_sized_int) data) & (alignment - 1)) == 0;
+    }
+}
+
+//==============================================================================
+FixedBlockAdapter::FixedBlockAdapter()
+    : numChannels (0), blockSize (0), fifoPosition (0), usingFifo (false),
+      inputFrame (nullptr), outputFrame (nullptr), hostChannels (nullptr)
+{
+}
+
+FixedBlockAdapter::~FixedBlockAdapter()
+{
+}
+
+//==============================================================================
+void FixedBlockAdapter::prepare (const int numChannels_, const int blockSize_, const int expectedHostBlockSize)
+{
+    // The frames have to be a power of two, which also keeps every channel aligned
+    jassert (isPowerOfTwo (blockSize_) && blockSize_ >= FixedBlockHelpers::alignment / (int) sizeof (float));
+
+    numChannels = jmax (1, numChannels_);
+    blockSize = blockSize_;
+    usingFifo = expectedHostBlockSize <= 0 || (expectedHostBlockSize % blockSize) != 0;
+
+    const size_t frameSize = (size_t) numChannels * (size_t) blockSize;
+    storage.calloc (2 * frameSize * sizeof (float) + FixedBlockHelpers::alignment);
+    channelPointers.malloc ((size_t) numChannels * 3);
+
+    float* data = reinterpret_cast <float*> (storage.getData());
+
+    while (! FixedBlockHelpers::isAligned (data))
+        data = addBytesToPointer (data, 4);
+
+    inputFrame = channelPointers;
+    outputFrame = channelPointers + numChannels;
+    hostChannels = channelPointers + numChannels * 2;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        inputFrame[ch] = data + ch * blockSize;
+        outputFrame[ch] = data + frameSize + (size_t) (ch * blockSize);
+    }
+
+    fifoPosition = 0;
+}
+
+void FixedBlockAdapter::release()
+{
+    storage.free();
+    channelPointers.free();
+    inputFrame = outputFrame = hostChannels = nullptr;
+    numChannels = 0;
+}
+
+void FixedBlockAdapter::reset() noexcept
+{
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        FloatVectorOperations::clear (inputFrame[ch], blockSize);
+        FloatVectorOperations::clear (outputFrame[ch], blockSize);
+    }
+
+    fifoPosition = 0;
+}
+
+//==============================================================================
+void FixedBlockAdapter::process (AudioSampleBuffer& hostBuffer, Client& client)
+{
+    // must call prepare() first!
+    jassert (blockSize > 0 && inputFrame != nullptr);
+
+    const int numChans = jmin (numChannels, hostBuffer.getNumChannels());
+
+    if (numChans > 0)
+    {
+        if (usingFifo)
+            processThroughFifo (hostBuffer, numChans, client);
+        else
+            processInPlace (hostBuffer, numChans, client);
+    }
+}
+
+void FixedBlockAdapter::processInPlace (AudioSampleBuffer& hostBuffer, const int numChans, Client& client)
+{
+    const int numSamples = hostBuffer.getNumSamples();
+
+    for (int pos = 0; pos < numSamples; pos += blockSize)
+    {
+        const int num = jmin (blockSize, numSamples - pos);
+        bool aligned = true;
+
+        for (int ch = 0; ch < numChans; ++ch)
+        {
+            hostChannels[ch] = hostBuffer.getSampleData (ch, pos);
+            aligned = aligned && FixedBlockHelpers::isAligned (hostChannels[ch]);
+        }
+
+        if (aligned)
+        {
+            AudioSampleBuffer frame (hostChannels, numChans, num);
+            client.processFixedBlock (frame);
+        }
+        else
+        {
+            for (int ch = 0; ch < numChans; ++ch)
+                FloatVectorOperations::copy (inputFrame[ch], hostChannels[ch], num);
+
+            AudioSampleBuffer frame (inputFrame, numChans, num);
+            client.processFixedBlock (frame);
+
+            for (int ch = 0; ch < numChans; ++ch)
+                FloatVectorOperations::copy (hostChannels[ch], inputFrame[ch], num);
+        }
+    }
+}
+
+void FixedBlockAdapter::processThroughFifo (AudioSampleBuffer& hostBuffer, const int numChans, Client& client)
+{
+    const int numSamples = hostBuffer.getNumSamples();
+
+    for (int pos = 0; pos < numSamples;)
+    {
+        const int num = jmin (numSamples - pos, blockSize - fifoPosition);
+
+        for (int ch = 0; ch < numChans; ++ch)
+        {
+            float* const host = hostBuffer.getSampleData (ch, pos);
+            FloatVectorOperations::copy (inputFrame[ch] + fifoPosition, host, num);
+            FloatVectorOperations::copy (host, outputFrame[ch] + fifoPosition, num);
+        }
+
+        pos += num;
+        fifoPosition += num;
+
+        if (fifoPosition == blockSize)
+        {
+            AudioSampleBuffer frame (inputFrame, numChans, blockSize);
+            client.processFixedBlock (frame);
+
+            // the frame that's just been processed is played out while the next one fills up
+            std::swap (inputFrame, outputFrame);
+            fifoPosition = 0;
+        }
+    }
+}
@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    FixedBlockAdapter.h
+
+    Turns the host's variable-sized blocks into fixed-sized ones.
+
+  ==============================================================================
+*/
+
+#ifndef __FIXEDBLOCKADAPTER_H_3D8A61F4__
+#define __FIXEDBLOCKADAPTER_H_3D8A61F4__
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+
+//==============================================================================
+/**
+    Re-blocks whatever the host passes to processBlock() into frames of a fixed,
+    power-of-two size, with each channel 32-byte aligned.
+
+    If the host's expected block size is a multiple of the frame size, the host's
+    buffer is processed in place, a frame at a time, and no latency is added. (If
+    its channels aren't aligned, each frame goes via an aligned copy.) Otherwise,
+    the audio is passed through a pair of preallocated frame buffers: one collects
+    the incoming samples while the other, which holds the previous frame's output,
+    is played out. This delays the signal by exactly one frame, and the frames are
+    processed at the same rate however the host chops up its calls.
+
+    Nothing is allocated after prepare(), so process() is real-time safe.
+*/
+class FixedBlockAdapter
+{
+public:
+    //==============================================================================
+    /** The processing that gets done on each frame. */
+    class Client
+    {
+    public:
+        virtual ~Client() {}
+
+        /** Processes one frame in place.
+
+            The frame always holds the adapter's block size, except in the in-place
+            mode when a host doesn't keep to the block size it gave to prepareToPlay():
+            the samples left over after the last whole frame are then passed on in a
+            shorter frame, because they can't be held back without adding latency.
+        */
+        virtual void processFixedBlock (AudioSampleBuffer& frame) = 0;
+    };
+
+    //==============================================================================
+    FixedBlockAdapter();
+    ~FixedBlockAdapter();
+
+    //==============================================================================
+    /** Allocates the frame buffers, and chooses between the in-place and FIFO modes.
+
+        @param numChannels              the number of channels to process
+        @param blockSize                the frame size, which must be a power of two
+        @param expectedHostBlockSize    the block size the host gave to prepareToPlay()
+    */
+    void prepare (int numChannels, int blockSize, int expectedHostBlockSize);
+
+    /** Frees the frame buffers. */
+    void release();
+
+    /** Clears the FIFOs, so that any audio they're holding is discarded. */
+    void reset() noexcept;
+
+    /** Returns the frame size that was given to prepare(). */
+    int getBlockSize() const noexcept                   { return blockSize; }
+
+    /** Returns true if the adapter is re-blocking through its FIFOs. */
+    bool isUsingFifo() const noexcept                   { return usingFifo; }
+
+    /** Returns the latency that the adapter adds: one frame in FIFO mode, or zero. */
+    int getLatencySamples() const noexcept              { return usingFifo ? blockSize : 0; }
+
+    //==============================================================================
+    /** Runs the host's buffer through the client, in fixed-sized frames. */
+    void process (AudioSampleBuffer& hostBuffer, Client& client);
+
+private:
+    //==============================================================================
+    int numChannels, blockSize, fifoPosition;
+    bool usingFifo;
+
+    HeapBlock<char> storage;
+    HeapBlock<float*> channelPointers;
+    float** inputFrame;
+    float** outputFrame;
+    float** hostChannels;
+
+    void processInPlace (AudioSampleBuffer& hostBuffer, int numChans, Client& client);
+    void processThroughFifo (AudioSampleBuffer& hostBuffer, int numChans, Client& client);
+
+    JUCE_DECLARE_NON_COPYABLE (FixedBlockAdapter)
+};
+
+
+#endif  // __FIXEDBLOCKADAPTER_H_3D8A61F4__
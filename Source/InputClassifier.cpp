@@ -0,0 +1,278 @@
+/*
+  ==============================================================================
+
+    InputClassifier.cpp
+
+    Spots input for which centre removal is trivial, so it can be skipped.
+
+  ==============================================================================
+*/
+
+#include "InputClassifier.h"
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+
+//==============================================================================
+namespace InputClassifierHelpers
+{
+    /*  Works out which of the pair flags still hold for a block. The flags that are
+        already known to be false aren't checked again.
+    */
+    static int scanPair (const float* const left, const float* const right, const int numSamples, int flags) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_INTEL
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 signBit = _mm_set1_ps (-0.0f);
+        __m128 same = _mm_cmpeq_ps (zero, zero);
+        __m128 inverted = same, leftSilent = same, rightSilent = same;
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const __m128 l = _mm_loadu_ps (left + i);
+            const __m128 r = _mm_loadu_ps (right + i);
+
+            same        = _mm_and_ps (same,        _mm_cmpeq_ps (l, r));
+            inverted    = _mm_and_ps (inverted,    _mm_cmpeq_ps (l, _mm_xor_ps (r, signBit)));
+            leftSilent  = _mm_and_ps (leftSilent,  _mm_cmpeq_ps (l, zero));
+            rightSilent = _mm_and_ps (rightSilent, _mm_cmpeq_ps (r, zero));
+        }
+
+        if (_mm_movemask_ps (same) != 15)          flags &= ~1;
+        if (_mm_movemask_ps (inverted) != 15)      flags &= ~2;
+        if (_mm_movemask_ps (leftSilent) != 15)    flags &= ~4;
+        if (_mm_movemask_ps (rightSilent) != 15)   flags &= ~8;
+       #endif
+
+        for (; i < numSamples; ++i)
+        {
+            const float l = left[i], r = right[i];
+
+            if (! (l == r))     flags &= ~1;
+            if (! (l == -r))    flags &= ~2;
+            if (! (l == 0))     flags &= ~4;
+            if (! (r == 0))     flags &= ~8;
+        }
+
+        return flags;
+    }
+
+    static bool isSilent (const float* const samples, const int numSamples) noexcept
+    {
+        return scanPair (samples, samples, numSamples, 4) != 0;
+    }
+}
+
+//==============================================================================
+void InputClassifier::FastPath::setNumOutputs (const int newNumOutputs) noexcept
+{
+    jassert (newNumOutputs <= maxChannels);
+    numOutputs = jmin ((int) maxChannels, newNumOutputs);
+
+    for (int i = 0; i < numOutputs; ++i)
+    {
+        sources[i] = -1;
+        gains[i] = 0;
+    }
+}
+
+void InputClassifier::FastPath::setOutput (const int output, const int sourceInput, const float gain) noexcept
+{
+    if (isPositiveAndBelow (output, numOutputs))
+    {
+        sources[output] = gain != 0 ? sourceInput : -1;
+        gains[output] = gain;
+    }
+}
+
+bool InputClassifier::FastPath::isSilent (const int firstOutput, const int numOutputsToCheck) const noexcept
+{
+    for (int i = firstOutput; i < firstOutput + numOutputsToCheck; ++i)
+        if (i < numOutputs && sources[i] >= 0)
+            return false;
+
+    return true;
+}
+
+bool InputClassifier::FastPath::isCopyOfInput (const int firstOutput, const int numOutputsToCheck) const noexcept
+{
+    for (int i = 0; i < numOutputsToCheck; ++i)
+        if (firstOutput + i >= numOutputs || sources [firstOutput + i] != i || gains [firstOutput + i] != 1.0f)
+            return false;
+
+    return true;
+}
+
+void InputClassifier::FastPath::apply (const float* const* inputs, float* const* outputs, const int numSamples) const noexcept
+{
+    for (int i = 0; i < numOutputs; ++i)
+    {
+        if (sources[i] < 0)
+            FloatVectorOperations::clear (outputs[i], numSamples);
+        else if (gains[i] == 1.0f)
+            FloatVectorOperations::copy (outputs[i], inputs [sources[i]], numSamples);
+        else
+            FloatVectorOperations::copyWithMultiply (outputs[i], inputs [sources[i]], gains[i], numSamples);
+    }
+}
+
+//==============================================================================
+InputClassifier::InputClassifier()
+    : numChannels (0), numPairs (0)
+{
+    reset();
+}
+
+InputClassifier::~InputClassifier()
+{
+}
+
+void InputClassifier::setLayout (const ChannelPairEngine& layout)
+{
+    numChannels = jmin ((int) maxChannels, layout.getNumChannels());
+    numPairs = 0;
+
+    for (int i = 0; i < layout.getNumPairs() && numPairs < maxChannels / 2; ++i)
+    {
+        if (layout.getLeftChannel (i) < numChannels && layout.getRightChannel (i) < numChannels)
+        {
+            leftChannels [numPairs] = layout.getLeftChannel (i);
+            rightChannels [numPairs] = layout.getRightChannel (i);
+            ++numPairs;
+        }
+    }
+
+    reset();
+}
+
+void InputClassifier::reset() noexcept
+{
+    for (int i = 0; i < maxChannels / 2; ++i)
+        pairFlags[i] = allPairFlags;
+
+    for (int i = 0; i < maxChannels; ++i)
+        channelSilent[i] = true;
+}
+
+bool InputClassifier::addBlock (const float* const* channels, const int numChannelsToScan, const int numSamples) noexcept
+{
+    jassert (numChannelsToScan >= numChannels);
+
+    for (int p = 0; p < numPairs; ++p)
+    {
+        const int l = leftChannels[p], r = rightChannels[p];
+
+        if (pairFlags[p] != 0 && r < numChannelsToScan && l < numChannelsToScan)
+        {
+            pairFlags[p] = InputClassifierHelpers::scanPair (channels[l], channels[r], numSamples, pairFlags[p]);
+            channelSilent[l] = (pairFlags[p] & leftIsSilent) != 0;
+            channelSilent[r] = (pairFlags[p] & rightIsSilent) != 0;
+        }
+        else
+        {
+            pairFlags[p] = 0;
+            channelSilent[l] = channelSilent[r] = false;
+        }
+    }
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        if (channelSilent[ch])
+        {
+            bool isPaired = false;
+
+            for (int p = 0; p < numPairs; ++p)
+                isPaired = isPaired || leftChannels[p] == ch || rightChannels[p] == ch;
+
+            if (! isPaired)
+                channelSilent[ch] = ch < numChannelsToScan && InputClassifierHelpers::isSilent (channels[ch], numSamples);
+        }
+    }
+
+    return isSpecialCase();
+}
+
+//==============================================================================
+bool InputClassifier::isSilent() const noexcept
+{
+    for (int ch = 0; ch < numChannels; ++ch)
+        if (! channelSilent[ch])
+            return false;
+
+    return true;
+}
+
+bool InputClassifier::isSpecialCase() const noexcept
+{
+    if (isSilent())
+        return true;
+
+    if (numPairs == 0)
+        return false;
+
+    for (int p = 0; p < numPairs; ++p)
+        if (pairFlags[p] == 0)
+            return false;
+
+    return true;
+}
+
+InputClassifier::Type InputClassifier::getPairType (const int pairIndex) const noexcept
+{
+    if (! isPositiveAndBelow (pairIndex, numPairs))
+        return general;
+
+    const int flags = pairFlags [pairIndex];
+
+    if ((flags & (leftIsSilent | rightIsSilent)) == (leftIsSilent | rightIsSilent))
+        return silent;
+
+    if ((flags & canBeDualMono) != 0)   return dualMono;
+    if ((flags & canBeInverted) != 0)   return polarityInverted;
+    if ((flags & rightIsSilent) != 0)   return leftOnly;
+    if ((flags & leftIsSilent) != 0)    return rightOnly;
+
+    return general;
+}
+
+bool InputClassifier::isChannelSilent (const int channel) const noexcept
+{
+    return isPositiveAndBelow (channel, numChannels) && channelSilent [channel];
+}
+
+String InputClassifier::getDescription() const
+{
+    if (isSilent())
+        return "silent";
+
+    if (! isSpecialCase())
+        return "general";
+
+    Type type = general;
+
+    for (int p = 0; p < numPairs; ++p)
+    {
+        const Type pairType = getPairType (p);
+
+        if (pairType != silent)
+        {
+            if (type != general && type != pairType)
+                return "a mixture of special cases";
+
+            type = pairType;
+        }
+    }
+
+    switch (type)
+    {
+        case dualMono:          return "dual-mono";
+        case polarityInverted:  return "polarity-inverted";
+        case leftOnly:          return "mono, with the right side silent";
+        case rightOnly:         return "mono, with the left side silent";
+        default:                return "silent";
+    }
+}
@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+    InputClassifier.h
+
+    Spots input for which centre removal is trivial, so it can be skipped.
+
+  ==============================================================================
+*/
+
+#ifndef __INPUTCLASSIFIER_H_A41F7C06__
+#define __INPUTCLASSIFIER_H_A41F7C06__
+
+#include "ChannelPairEngine.h"
+
+
+//==============================================================================
+/**
+    Scans audio to find out whether each left/right pair is one of the special
+    cases that the processor doesn't need to run for: silence, dual-mono (L == R),
+    polarity-inverted (L == -R), or mono with one dead side.
+
+    Blocks are added one at a time, and the result covers everything added since the
+    last reset(), so it can classify a single block or a whole file. The comparisons
+    are exact, and are done four samples at a time with SSE on Intel. A pair stays in
+    a class only while every sample so far fits it, so once addBlock() returns false,
+    nothing more can be gained by scanning further.
+
+    What a processor would output for a classified input is described by a FastPath,
+    which routes each output channel from one input channel with a gain. Processors
+    that can provide one implement InputClassifier::Client.
+*/
+class InputClassifier
+{
+public:
+    //==============================================================================
+    /** The classes of a pair, from the most specific to the least. */
+    enum Type
+    {
+        general = 0,        /**< anything else, which needs the full processing */
+        silent,             /**< both channels are digital silence */
+        dualMono,           /**< the two channels are identical */
+        polarityInverted,   /**< the right channel is the left one inverted */
+        leftOnly,           /**< the right channel is silent */
+        rightOnly           /**< the left channel is silent */
+    };
+
+    enum { maxChannels = 16 };
+
+    //==============================================================================
+    /** Says how to make each output channel from the inputs, without processing. */
+    struct FastPath
+    {
+        /** Sets the number of outputs, all of which start off silent. */
+        void setNumOutputs (int numOutputs) noexcept;
+
+        /** Makes an output a copy of an input, multiplied by a gain. */
+        void setOutput (int output, int sourceInput, float gain) noexcept;
+
+        /** Returns true if the given outputs are all silent. */
+        bool isSilent (int firstOutput, int numOutputsToCheck) const noexcept;
+
+        /** Returns true if the given outputs are exact copies of the inputs from 0 onwards. */
+        bool isCopyOfInput (int firstOutput, int numOutputsToCheck) const noexcept;
+
+        /** Writes the outputs. The input and output channels mustn't overlap. */
+        void apply (const float* const* inputs, float* const* outputs, int numSamples) const noexcept;
+
+        int numOutputs;
+        int sources [maxChannels];      /**< the input for each output, or -1 for silence */
+        float gains [maxChannels];
+    };
+
+    //==============================================================================
+    /** Implemented by processors that can say what they'd output for special cases. */
+    class Client
+    {
+    public:
+        virtual ~Client() {}
+
+        /** Returns the layout whose pairs the processor would work on. */
+        virtual const ChannelPairEngine& getClassifierLayout() const = 0;
+
+        /** Fills in the output that the processor would produce for a classified input,
+            in its current state, or returns false if it would have to do the processing.
+
+            @param input            the classification
+            @param result           the path to fill in, with an output for each of the
+                                    processor's output channels
+            @param isWholeStream    if true, the classification covers everything that will
+                                    ever be processed, so the processor's state afterwards
+                                    doesn't matter. Otherwise it's just the next block, and
+                                    a fast path mustn't leave the state any different from
+                                    what the processing would.
+        */
+        virtual bool getFastPath (const InputClassifier& input, FastPath& result, bool isWholeStream) = 0;
+    };
+
+    //==============================================================================
+    InputClassifier();
+    ~InputClassifier();
+
+    //==============================================================================
+    /** Takes a copy of a layout's pairs, and resets the classification. */
+    void setLayout (const ChannelPairEngine& layout);
+
+    /** Starts a new classification, in which everything is still possible. */
+    void reset() noexcept;
+
+    /** Scans some more samples of the layout's channels.
+
+        @returns true if the input still fits one of the special cases, i.e. if
+                 isSpecialCase() is still true
+    */
+    bool addBlock (const float* const* channels, int numChannels, int numSamples) noexcept;
+
+    //==============================================================================
+    /** Returns true if every pair is in a class other than general, or the whole
+        input is silent.
+    */
+    bool isSpecialCase() const noexcept;
+
+    /** Returns true if every channel is silent. */
+    bool isSilent() const noexcept;
+
+    /** Returns the class of one of the layout's pairs. */
+    Type getPairType (int pairIndex) const noexcept;
+
+    /** Returns true if a channel has been silent. */
+    bool isChannelSilent (int channel) const noexcept;
+
+    /** Returns a short description of the input, like "dual-mono". */
+    String getDescription() const;
+
+private:
+    //==============================================================================
+    enum
+    {
+        canBeDualMono   = 1,
+        canBeInverted   = 2,
+        leftIsSilent    = 4,
+        rightIsSilent   = 8,
+        allPairFlags    = 15
+    };
+
+    int numChannels, numPairs;
+    int leftChannels [maxChannels / 2];
+    int rightChannels [maxChannels / 2];
+    int pairFlags [maxChannels / 2];
+    bool channelSilent [maxChannels];
+
+    JUCE_DECLARE_NON_COPYABLE (InputClassifier)
+};
+
+
+#endif  // __INPUTCLASSIFIER_H_A41F7C06__
@@ -0,0 +1,246 @@
+/*
+  ==============================================================================
+
+    MultiResolutionSTFT.cpp
+
+    Runs a spectral process with long frames in the bass and short ones above.
+
+  ==============================================================================
+*/
+
+#include "MultiResolutionSTFT.h"
+
+
+//==============================================================================
+namespace MultiResolutionHelpers
+{
+    // The frame size of each band, as a power of two, from the bottom band up
+    static const int bandOrders[] = { 12, 10, 8 };
+
+    // The edges between the bands. Below 500Hz, the 4096-sample frames resolve the
+    // harmonics of bass notes, and above 4kHz, the 256-sample frames keep transients sharp.
+    static const double crossoverFrequencies[] = { 500.0, 4000.0 };
+
+    // The latency of the shortest setting, as a power of two
+    static const int minLatencyOrder = 8;
+
+    // A band only gets its own frames if they're at least four times the latency. Below
+    // that, the stretched analysis window smears the gains by more than the longer frame
+    // gains in resolution, and the band is better off merged into the one above it.
+    static int getFrameOrder (const int band, const int setting) noexcept
+    {
+        const int latencyOrder = minLatencyOrder + setting;
+        return bandOrders [band] >= latencyOrder + 2 ? bandOrders [band] : latencyOrder;
+    }
+
+    /*  Splits the bottom off a channel with a Butterworth lowpass, as a topology-preserving
+        state-variable filter, leaving what's above it behind.
+    */
+    static void splitOffBand (float* const remainder, float* const band, float* const state,
+                              const float a1, const float a2, const float a3, const int numSamples) noexcept
+    {
+        float s1 = state[0], s2 = state[1];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float x = remainder[i];
+            const float v3 = x - s2;
+            const float v1 = a1 * s1 + a2 * v3;
+            const float v2 = s2 + a2 * s1 + a3 * v3;
+
+            s1 = 2.0f * v1 - s1;
+            s2 = 2.0f * v2 - s2;
+
+            band[i] = v2;
+            remainder[i] = x - v2;
+        }
+
+        state[0] = s1;
+        state[1] = s2;
+    }
+}
+
+//==============================================================================
+MultiResolutionSTFT::MultiResolutionSTFT()
+    : bandBuffers (1, 1), numInputs (0), numOutputs (0), numChannels (0), maxBlockSize (0),
+      currentSetting (numLatencySettings - 1), requestedSetting (numLatencySettings - 1), numActiveBands (1)
+{
+    zeromem (filterA1, sizeof (filterA1));
+    zeromem (filterA2, sizeof (filterA2));
+    zeromem (filterA3, sizeof (filterA3));
+}
+
+MultiResolutionSTFT::~MultiResolutionSTFT()
+{
+}
+
+//==============================================================================
+void MultiResolutionSTFT::prepare (const int numInputs_, const int numOutputs_,
+                                   const double sampleRate, const int maxBlockSize_)
+{
+    using namespace MultiResolutionHelpers;
+
+    numInputs = jmax (1, numInputs_);
+    numOutputs = jmax (1, numOutputs_);
+    numChannels = jmax (numInputs, numOutputs);
+    maxBlockSize = jmax (1, maxBlockSize_);
+
+    // Every band gets a shape for each setting, so that switching doesn't allocate
+    for (int b = 0; b < numBands; ++b)
+    {
+        ShortTimeFourierTransform::Windows::Shape shapes [numLatencySettings];
+
+        for (int s = 0; s < numLatencySettings; ++s)
+        {
+            shapes[s].frameSize = 1 << getFrameOrder (b, s);
+            shapes[s].latency = getLatencyForSetting (s);
+            shapes[s].hopSize = shapes[s].latency / 4;
+        }
+
+        bands[b].prepare (numInputs, numOutputs, shapes, numLatencySettings);
+    }
+
+    for (int b = 0; b < numBands - 1; ++b)
+    {
+        const double frequency = jmin (crossoverFrequencies[b], sampleRate * 0.45);
+        const double g = std::tan (double_Pi * frequency / sampleRate);
+        const double a1 = 1.0 / (1.0 + g * (g + std::sqrt (2.0)));
+
+        filterA1[b] = (float) a1;
+        filterA2[b] = (float) (g * a1);
+        filterA3[b] = (float) (g * g * a1);
+    }
+
+    bandBuffers.setSize ((numBands - 1) * numChannels, maxBlockSize);
+    filterStates.calloc ((size_t) ((numBands - 1) * numInputs * 2));
+
+    applySetting (requestedSetting);
+}
+
+void MultiResolutionSTFT::release()
+{
+    for (int b = 0; b < numBands; ++b)
+        bands[b].release();
+
+    bandBuffers.setSize (1, 1);
+    filterStates.free();
+}
+
+void MultiResolutionSTFT::reset() noexcept
+{
+    for (int b = 0; b < numBands; ++b)
+        bands[b].reset();
+
+    if (filterStates != nullptr)
+        zeromem (filterStates, sizeof (float) * (size_t) ((numBands - 1) * numInputs * 2));
+}
+
+//==============================================================================
+void MultiResolutionSTFT::setLatencySetting (const int newSetting) noexcept
+{
+    requestedSetting = jlimit (0, numLatencySettings - 1, newSetting);
+}
+
+int MultiResolutionSTFT::getLatencyForSetting (const int setting) noexcept
+{
+    return 1 << (MultiResolutionHelpers::minLatencyOrder + jlimit (0, numLatencySettings - 1, setting));
+}
+
+int MultiResolutionSTFT::getMaxNumBins() const noexcept
+{
+    int maxNumBins = 0;
+
+    for (int b = 0; b < numBands; ++b)
+        maxNumBins = jmax (maxNumBins, bands[b].getMaxNumBins());
+
+    return maxNumBins;
+}
+
+void MultiResolutionSTFT::applySetting (const int setting) noexcept
+{
+    using namespace MultiResolutionHelpers;
+
+    currentSetting = setting;
+
+    // The bands that would all get frames of the latency are merged into one
+    numActiveBands = 1;
+
+    while (numActiveBands < numBands && getFrameOrder (numActiveBands - 1, setting) > minLatencyOrder + setting)
+        ++numActiveBands;
+
+    for (int b = 0; b < numBands; ++b)
+        bands[b].setShape (setting);
+
+    reset();
+}
+
+//==============================================================================
+void MultiResolutionSTFT::process (AudioSampleBuffer& buffer, ShortTimeFourierTransform::Client& client)
+{
+    // must call prepare() first!
+    jassert (maxBlockSize > 0);
+
+    if (requestedSetting != currentSetting)
+        applySetting (requestedSetting);
+
+    if (numActiveBands == 1)
+    {
+        bands[0].process (buffer, client);
+        return;
+    }
+
+    const int numSamples = buffer.getNumSamples();
+    const int numIns = jmin (numInputs, buffer.getNumChannels());
+    const int numOuts = jmin (numOutputs, buffer.getNumChannels());
+    const int topBand = numActiveBands - 1;
+
+    for (int pos = 0; pos < numSamples; pos += maxBlockSize)
+    {
+        const int num = jmin (maxBlockSize, numSamples - pos);
+        AudioSampleBuffer block (buffer.getArrayOfChannels(), buffer.getNumChannels(), pos, num);
+
+        for (int b = 0; b < topBand; ++b)
+            for (int ch = 0; ch < numIns; ++ch)
+                MultiResolutionHelpers::splitOffBand (block.getSampleData (ch),
+                                                      bandBuffers.getSampleData (b * numChannels + ch),
+                                                      filterStates + (b * numInputs + ch) * 2,
+                                                      filterA1[b], filterA2[b], filterA3[b], num);
+
+        // (what's left in the block is the top band)
+        bands [topBand].process (block, client);
+
+        for (int b = 0; b < topBand; ++b)
+        {
+            AudioSampleBuffer band (bandBuffers.getArrayOfChannels() + b * numChannels, numChannels, num);
+            bands[b].process (band, client);
+
+            for (int ch = 0; ch < numOuts; ++ch)
+                block.addFrom (ch, 0, band, ch, 0, num);
+        }
+    }
+}
+
+bool MultiResolutionSTFT::isQuiescent() const noexcept
+{
+    // (a change of setting has to be made by process(), so this waits for that)
+    if (requestedSetting != currentSetting)
+        return false;
+
+    for (int i = 0; i < (numBands - 1) * numInputs * 2; ++i)
+        if (filterStates[i] != 0)
+            return false;
+
+    for (int b = 0; b < numActiveBands; ++b)
+        if (! bands[b].isQuiescent())
+            return false;
+
+    return true;
+}
+
+void MultiResolutionSTFT::skipSilence (const int numSamples) noexcept
+{
+    jassert (requestedSetting == currentSetting);
+
+    for (int b = 0; b < numActiveBands; ++b)
+        bands[b].skipSilence (numSamples);
+}
@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    MultiResolutionSTFT.h
+
+    Runs a spectral process with long frames in the bass and short ones above.
+
+  ==============================================================================
+*/
+
+#ifndef __MULTIRESOLUTIONSTFT_H_C7D24A95__
+#define __MULTIRESOLUTIONSTFT_H_C7D24A95__
+
+#include "ShortTimeFourierTransform.h"
+
+
+//==============================================================================
+/**
+    Splits the audio into frequency bands, and runs each one through its own
+    ShortTimeFourierTransform, with frames that get shorter as the bands get higher.
+
+    The bands are split off one at a time by Butterworth lowpasses, each taking the
+    bottom of whatever is left, so they always add back up to exactly the input. Every
+    band uses the same latency, with a longer frame than that where the band needs the
+    frequency resolution, so a pass-through client gets back the input delayed by the
+    latency, however the bands are set up. The latency therefore follows the shortest
+    frame, rather than the 4096 samples that the bass needs.
+
+    There's a choice of latencies, from 256 samples up to 4096. At 2048 and 4096,
+    there's just one band, which is the same as a plain STFT with frames of the latency.
+    Below that, the bass below 500Hz keeps its 4096-sample frames, and at 256 samples,
+    the band up to 4kHz also gets 1024-sample frames. A band only gets frames longer
+    than the latency when they're at least four times as long, because otherwise the
+    stretched windows lose more than the extra resolution gains. Shorter latencies cost
+    more CPU, because every band's hop is a quarter of the latency.
+
+    The client is called once per hop for each band, with that band's spectra, so its
+    scratch space needs to be big enough for getMaxNumBins() bins.
+
+    Everything is allocated in prepare(), so the latency can be changed while
+    processing.
+*/
+class MultiResolutionSTFT
+{
+public:
+    //==============================================================================
+    MultiResolutionSTFT();
+    ~MultiResolutionSTFT();
+
+    enum
+    {
+        numBands = 3,
+        numLatencySettings = 5      /**< 256, 512, 1024, 2048 and 4096 samples */
+    };
+
+    //==============================================================================
+    /** Allocates the buffers and builds the filters.
+
+        @param numInputs        the number of channels that are analysed
+        @param numOutputs       the number of channels that are resynthesised
+        @param sampleRate       the sample rate, which sets the crossover filters
+        @param maxBlockSize     the most samples that process() will usually be given at
+                                once. Bigger blocks still work, but get split up.
+    */
+    void prepare (int numInputs, int numOutputs, double sampleRate, int maxBlockSize);
+
+    /** Frees the buffers. */
+    void release();
+
+    /** Clears the frames and filters that are in progress. */
+    void reset() noexcept;
+
+    //==============================================================================
+    /** Chooses a latency, from 0 (the shortest) to numLatencySettings - 1 (the longest,
+        which is the default). This can be called while processing, and takes effect at
+        the start of the next process() call, which also clears anything in progress.
+    */
+    void setLatencySetting (int newSetting) noexcept;
+
+    /** Returns the latency setting that was last chosen. */
+    int getLatencySetting() const noexcept              { return requestedSetting; }
+
+    /** Returns the latency, in samples, for one of the settings. */
+    static int getLatencyForSetting (int setting) noexcept;
+
+    /** Returns the delay between the input and output, for the latency setting that
+        was last chosen.
+    */
+    int getLatencySamples() const noexcept              { return getLatencyForSetting (requestedSetting); }
+
+    /** Returns the number of samples between frames, which is the same for every band. */
+    int getHopSize() const noexcept                     { return getLatencySamples() / 4; }
+
+    /** Returns the largest number of bins that the client will be given. */
+    int getMaxNumBins() const noexcept;
+
+    //==============================================================================
+    /** Processes a block. As with ShortTimeFourierTransform::process(), the inputs are
+        read from the buffer's first numInputs channels, and the outputs replace its
+        first numOutputs channels.
+    */
+    void process (AudioSampleBuffer& buffer, ShortTimeFourierTransform::Client& client);
+
+    /** Returns true if nothing is left in the frames and filters that are in progress. */
+    bool isQuiescent() const noexcept;
+
+    /** Does the equivalent of processing a silent block while isQuiescent() is true. */
+    void skipSilence (int numSamples) noexcept;
+
+private:
+    //==============================================================================
+    ShortTimeFourierTransform bands [numBands];
+    AudioSampleBuffer bandBuffers;      // the channels of each band below the top one
+    HeapBlock<float> filterStates;      // the two states of each crossover, for each input
+    float filterA1 [numBands - 1], filterA2 [numBands - 1], filterA3 [numBands - 1];
+    int numInputs, numOutputs, numChannels, maxBlockSize;
+    int currentSetting, requestedSetting, numActiveBands;
+
+    void applySetting (int setting) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE (MultiResolutionSTFT)
+};
+
+
+#endif  // __MULTIRESOLUTIONSTFT_H_C7D24A95__
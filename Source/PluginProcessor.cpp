@@ -14,7 +14,18 @@
 
 //==============================================================================
 AudioPluginAudioProcessor::AudioPluginAudioProcessor()
+    : fastPathInput (1, 1), fadeBuffer (1, 1), lastMode (centreCancelMode), fadingMode (centreCancelMode),
+      lastLatencySetting (MultiResolutionSTFT::numLatencySettings - 1), activeAzimuth (0), fadingAzimuth (1),
+      fadeLength (1), fadeSamplesLeft (0), internalBlockSize (256),
+      numFastPathSamples (0), numProcessedSamples (0), hasCentreOutput (false),
+      useBatchEngine (SystemStats::getEnvironmentVariable ("CENTREREMOVER_BATCH", String::empty).getIntValue() == 1),
+      useFastPaths (false),
+      mode (0.0f), position (0.5f), width (0.05f), latency (1.0f),
+      smoothing (0.0f), maskFloor (0.0f),
+      recallMiddle (1), recallWriteIndex (0), recallReadIndex (2)
 {
+    // This is cheap enough to leave on, so that the block timing of every instance can be inspected
+    getTimingStats().setEnabled (true);
 }
 
 AudioPluginAudioProcessor::~AudioPluginAudioProcessor()
@@ -29,46 +40,133 @@ const String AudioPluginAudioProcessor::getName() const
 
 int AudioPluginAudioProcessor::getNumParameters()
 {
-    return 0;
+    return totalNumParams;
 }
 
 float AudioPluginAudioProcessor::getParameter (int index)
 {
-    return 0.0f;
+    // (a recalled state that the audio thread hasn't taken yet is what the host expects back)
+    if (numRecallsTaken.get() != numRecallsPublished.get() && isPositiveAndBelow (index, (int) totalNumParams))
+        return lastRecall.values [index];
+
+    switch (index)
+    {
+        case modeParam:         return mode;
+        case positionParam:     return position;
+        case widthParam:        return width;
+        case latencyParam:      return latency;
+        case smoothingParam:    return smoothing;
+        case floorParam:        return maskFloor;
+        default:                return 0.0f;
+    }
 }
 
 void AudioPluginAudioProcessor::setParameter (int index, float newValue)
 {
+    switch (index)
+    {
+        case modeParam:         mode = newValue; triggerAsyncUpdate(); break;
+        case positionParam:     position = newValue; break;
+        case widthParam:        width = newValue; break;
+        case latencyParam:      latency = newValue; triggerAsyncUpdate(); break;
+        case smoothingParam:    smoothing = newValue; break;
+        case floorParam:        maskFloor = newValue; break;
+        default:                break;
+    }
 }
 
 const String AudioPluginAudioProcessor::getParameterName (int index)
 {
+    switch (index)
+    {
+        case modeParam:         return "mode";
+        case positionParam:     return "position";
+        case widthParam:        return "width";
+        case latencyParam:      return "latency";
+        case smoothingParam:    return "smoothing";
+        case floorParam:        return "floor";
+        default:                break;
+    }
+
     return String::empty;
 }
 
 const String AudioPluginAudioProcessor::getParameterText (int index)
 {
+    switch (index)
+    {
+        case modeParam:
+            switch (getProcessingMode())
+            {
+                case adaptiveMode:      return "Adaptive";
+                case azimuthMode:       return "Azimuth";
+                default:                return "Centre";
+            }
+
+        case positionParam:
+        {
+            const int percent = roundToInt (position * 200.0f) - 100;
+
+            if (percent == 0)
+                return "C";
+
+            return (percent < 0 ? "L " : "R ") + String (std::abs (percent)) + "%";
+        }
+
+        case widthParam:
+            return String (roundToInt (width * 100.0f)) + "%";
+
+        case latencyParam:
+        {
+            const int samples = MultiResolutionSTFT::getLatencyForSetting (getLatencySetting());
+
+            if (getSampleRate() > 0)
+                return String (samples * 1000.0 / getSampleRate(), 1) + " ms";
+
+            return String (samples) + " samples";
+        }
+
+        case smoothingParam:
+            return String (roundToInt (smoothing * 100.0f)) + "%";
+
+        case floorParam:
+            return Decibels::toString (Decibels::gainToDecibels (maskFloor), 1);
+
+        default:
+            break;
+    }
+
     return String::empty;
 }
 
 const String AudioPluginAudioProcessor::getInputChannelName (int channelIndex) const
 {
-    return String (channelIndex + 1);
+    return pairEngine.getChannelName (channelIndex);
 }
 
 const String AudioPluginAudioProcessor::getOutputChannelName (int channelIndex) const
 {
-    return String (channelIndex + 1);
+    const int numInputs = getNumInputChannels();
+
+    if (hasCentreOutput && channelIndex >= numInputs)
+        return pairEngine.getChannelName (channelIndex - numInputs) + " (centre)";
+
+    return pairEngine.getChannelName (channelIndex);
 }
 
 bool AudioPluginAudioProcessor::isInputChannelStereoPair (int index) const
 {
-    return true;
+    return getNumInputChannels() <= 2 || pairEngine.isPairedChannel (index);
 }
 
 bool AudioPluginAudioProcessor::isOutputChannelStereoPair (int index) const
 {
-    return true;
+    const int numInputs = getNumInputChannels();
+
+    if (hasCentreOutput && index >= numInputs)
+        index -= numInputs;
+
+    return numInputs <= 2 || pairEngine.isPairedChannel (index);
 }
 
 bool AudioPluginAudioProcessor::acceptsMidi() const
@@ -123,44 +221,406 @@ void AudioPluginAudioProcessor::changeProgramName (int index, const String& newN
 }
 
 //==============================================================================
+void AudioPluginAudioProcessor::setInternalBlockSize (const int newBlockSize)
+{
+    jassert (isPowerOfTwo (newBlockSize));
+    internalBlockSize = newBlockSize;
+}
+
+void AudioPluginAudioProcessor::setBatchProcessingEnabled (const bool shouldBeEnabled)
+{
+    useBatchEngine = shouldBeEnabled;
+}
+
 void AudioPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    // Use this method as the place to do any pre-playback
-    // initialisation that you need..
+    takeRecalledState();
+
+    const int numInputs = getNumInputChannels();
+
+    blockAdapter.prepare (jmax (numInputs, getNumOutputChannels()),
+                          internalBlockSize, samplesPerBlock);
+    pairEngine.setLayout (numInputs, getInputSpeakerArrangement());
+    hasCentreOutput = numInputs > 0 && getNumOutputChannels() == numInputs * 2;
+
+    // At the longest latency, these are 4096-sample frames with 75% overlap, as in the
+    // original ADRess work
+    for (int i = 0; i < 2; ++i)
+    {
+        AzimuthEngine& engine = azimuthEngines[i];
+        engine.stft.setLatencySetting (getLatencySetting());
+        engine.stft.prepare (numInputs, hasCentreOutput ? numInputs * 2 : numInputs, sampleRate, internalBlockSize);
+        engine.discriminator.prepare (pairEngine, hasCentreOutput, engine.stft.getMaxNumBins(), sampleRate);
+    }
+
+    lastMode = getProcessingMode();
+    lastLatencySetting = getLatencySetting();
+    activeAzimuth = 0;
+    fadeSamplesLeft = 0;
+    fadeLength = jmax (1, roundToInt (sampleRate * 0.02));
+    fadeBuffer.setSize (jmax (numInputs, getNumOutputChannels()), internalBlockSize);
+
+    // (the extractor has to leave the batch engine before it can be changed)
+    batchMember.release();
+    adaptive.prepare (pairEngine, sampleRate);
+
+    if (useBatchEngine)
+        batchMember.prepare (adaptive, numInputs, hasCentreOutput, internalBlockSize);
+
+    classifier.setLayout (pairEngine);
+    fastPathInput.setSize (jmax (1, numInputs), internalBlockSize);
+    numFastPathSamples = numProcessedSamples = 0;
+
+    setLatencySamples (getTotalLatency());
 }
 
 void AudioPluginAudioProcessor::releaseResources()
 {
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
+    blockAdapter.release();
+    batchMember.release();
+
+    for (int i = 0; i < 2; ++i)
+    {
+        azimuthEngines[i].stft.release();
+        azimuthEngines[i].discriminator.release();
+    }
+
+    fastPathInput.setSize (1, 1);
+    fadeBuffer.setSize (1, 1);
+}
+
+void AudioPluginAudioProcessor::reset()
+{
+    blockAdapter.reset();
+
+    for (int i = 0; i < 2; ++i)
+    {
+        azimuthEngines[i].stft.reset();
+        azimuthEngines[i].discriminator.reset();
+    }
+
+    resetAdaptive();
+    fadeSamplesLeft = 0;
+}
+
+void AudioPluginAudioProcessor::resetAdaptive()
+{
+    // (while it's in the batch engine, the extractor can be run by other instances' threads)
+    if (batchMember.isActive())
+        batchMember.reset();
+    else
+        adaptive.reset();
+}
+
+int AudioPluginAudioProcessor::getTotalLatency() const noexcept
+{
+    int totalLatency = blockAdapter.getLatencySamples();
+
+    switch (getProcessingMode())
+    {
+        case azimuthMode:   totalLatency += MultiResolutionSTFT::getLatencyForSetting (getLatencySetting()); break;
+        case adaptiveMode:  totalLatency += batchMember.isActive() ? batchMember.getLatencySamples() : 0; break;
+        default:            break;
+    }
+
+    return totalLatency;
+}
+
+void AudioPluginAudioProcessor::handleAsyncUpdate()
+{
+    // A change of mode or latency can be made on the audio thread, by automation, but the
+    // host mustn't be told about it from there
+    setLatencySamples (getTotalLatency());
 }
 
 void AudioPluginAudioProcessor::processBlock (AudioSampleBuffer& buffer, MidiBuffer& midiMessages)
 {
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
+    blockAdapter.process (buffer, *this);
+}
+
+void AudioPluginAudioProcessor::processFixedBlock (AudioSampleBuffer& buffer)
+{
+    const int numInputs = getNumInputChannels();
+
+    // A recalled state is taken here, with all of its parameters at once, before it's
+    // compared with the current mode and latency
+    takeRecalledState();
 
-	if (getNumInputChannels() == 2) {
-		float* channel0Data = buffer.getSampleData(0);
-		float* channel1Data = buffer.getSampleData(1);
-		float channelSide = 0;
+    const ProcessingMode currentMode = getProcessingMode();
+    const int currentLatencySetting = getLatencySetting();
 
-		for (int i = 0; i < buffer.getNumSamples(); i++) {
-			channelSide = *(channel0Data + i) - *(channel1Data + i);
+    // (a change that arrives during a crossfade waits for it to finish)
+    if (fadeSamplesLeft <= 0
+         && (currentMode != lastMode || (currentMode == azimuthMode && currentLatencySetting != lastLatencySetting)))
+        startCrossfade (currentMode, currentLatencySetting);
+
+    if (fadeSamplesLeft > 0)
+    {
+        processCrossfade (buffer);
+        numProcessedSamples += buffer.getNumSamples();
+    }
+    else if (useFastPaths && processFastPath (buffer))
+    {
+        numFastPathSamples += buffer.getNumSamples();
+    }
+    else
+    {
+        processWithMode (buffer, lastMode, azimuthEngines [activeAzimuth]);
+        numProcessedSamples += buffer.getNumSamples();
+    }
+
+    if (hasCentreOutput)
+        return;
 
-			*(channel0Data + i) = channelSide;
-			*(channel1Data + i) = channelSide;
-		}
-	}
     // In case we have more outputs than inputs, we'll clear any output
     // channels that didn't contain input data, (because these aren't
     // guaranteed to be empty - they may contain garbage).
-    for (int i = getNumInputChannels(); i < getNumOutputChannels(); ++i)
+    for (int i = numInputs; i < getNumOutputChannels(); ++i)
     {
         buffer.clear (i, 0, buffer.getNumSamples());
     }
 }
 
+void AudioPluginAudioProcessor::processWithMode (AudioSampleBuffer& buffer, const ProcessingMode currentMode,
+                                                 AzimuthEngine& engine)
+{
+    const int numInputs = getNumInputChannels();
+    const bool splitCentre = hasCentreOutput && buffer.getNumChannels() >= numInputs * 2;
+
+    if (currentMode == azimuthMode)
+    {
+        engine.discriminator.setTarget (position * 2.0f - 1.0f, width * 2.0f);
+        engine.discriminator.setMaskSmoothing (smoothing * 0.08f, smoothing * 0.5f, maskFloor);
+        engine.discriminator.setHopSize (engine.stft.getHopSize());
+        engine.stft.process (buffer, engine.discriminator);
+    }
+    else if (currentMode == adaptiveMode && batchMember.isActive())
+    {
+        batchMember.process (buffer);
+    }
+    else if (splitCentre)
+    {
+        // The residual stays in the first half of the channels, and the centre that was
+        // taken out of it goes into the second half
+        AudioSampleBuffer residual (buffer.getArrayOfChannels(), numInputs, buffer.getNumSamples());
+        AudioSampleBuffer centre (buffer.getArrayOfChannels() + numInputs, numInputs, buffer.getNumSamples());
+
+        if (currentMode == adaptiveMode)
+            adaptive.process (residual, centre);
+        else
+            pairEngine.process (residual, centre);
+    }
+    else if (currentMode == adaptiveMode)
+    {
+        adaptive.process (buffer);
+    }
+    else
+    {
+        // Cancels the phantom centre of every left/right pair, and drops any discrete centre channel
+        pairEngine.process (buffer);
+    }
+}
+
+//==============================================================================
+void AudioPluginAudioProcessor::startCrossfade (const ProcessingMode newMode, const int newLatencySetting)
+{
+    fadingMode = lastMode;
+    fadingAzimuth = activeAzimuth;
+
+    // The engine that's starting is cleared, so that nothing left over from the last time
+    // it was used gets played. The old one keeps running until it's been faded out, and
+    // is held at full level until the new one has got through its latency.
+    int newLatency = 0;
+
+    if (newMode == azimuthMode)
+    {
+        if (lastMode == azimuthMode)
+            activeAzimuth = 1 - activeAzimuth;
+
+        AzimuthEngine& engine = azimuthEngines [activeAzimuth];
+        engine.stft.setLatencySetting (newLatencySetting);
+        engine.stft.reset();
+        engine.discriminator.reset();
+        newLatency = engine.stft.getLatencySamples();
+    }
+    else if (newMode == adaptiveMode)
+    {
+        resetAdaptive();
+        newLatency = batchMember.isActive() ? batchMember.getLatencySamples() : 0;
+    }
+
+    lastMode = newMode;
+    lastLatencySetting = newLatencySetting;
+    fadeSamplesLeft = newLatency + fadeLength;
+}
+
+void AudioPluginAudioProcessor::processCrossfade (AudioSampleBuffer& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = jmin (buffer.getNumChannels(), fadeBuffer.getNumChannels());
+
+    jassert (numSamples <= fadeBuffer.getNumSamples());
+
+    AudioSampleBuffer fadingOut (fadeBuffer.getArrayOfChannels(), numChannels,
+                                 jmin (numSamples, fadeBuffer.getNumSamples()));
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        fadingOut.copyFrom (ch, 0, buffer, ch, 0, fadingOut.getNumSamples());
+
+    processWithMode (fadingOut, fadingMode, azimuthEngines [fadingAzimuth]);
+    processWithMode (buffer, lastMode, azimuthEngines [activeAzimuth]);
+
+    const int num = jmin (fadingOut.getNumSamples(), fadeSamplesLeft);
+    const float startGain = jmin (1.0f, fadeSamplesLeft / (float) fadeLength);
+    const float endGain = jmin (1.0f, (fadeSamplesLeft - num) / (float) fadeLength);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        buffer.applyGainRamp (ch, 0, num, 1.0f - startGain, 1.0f - endGain);
+        buffer.addFromWithRamp (ch, 0, fadingOut.getSampleData (ch), num, startGain, endGain);
+    }
+
+    fadeSamplesLeft -= num;
+}
+
+//==============================================================================
+bool AudioPluginAudioProcessor::processFastPath (AudioSampleBuffer& buffer)
+{
+    const int numInputs = pairEngine.getNumChannels();
+    const int numSamples = buffer.getNumSamples();
+
+    if (numInputs <= 0 || numSamples > fastPathInput.getNumSamples()
+         || buffer.getNumChannels() < (hasCentreOutput ? numInputs * 2 : numInputs))
+        return false;
+
+    classifier.reset();
+
+    if (! classifier.addBlock (buffer.getArrayOfChannels(), buffer.getNumChannels(), numSamples))
+        return false;
+
+    InputClassifier::FastPath path;
+
+    if (! getFastPath (classifier, path, false))
+        return false;
+
+    for (int ch = 0; ch < numInputs; ++ch)
+        fastPathInput.copyFrom (ch, 0, buffer, ch, 0, numSamples);
+
+    path.apply (fastPathInput.getArrayOfChannels(), buffer.getArrayOfChannels(), numSamples);
+
+    if (lastMode == azimuthMode)
+        azimuthEngines [activeAzimuth].stft.skipSilence (numSamples);
+
+    return true;
+}
+
+const ChannelPairEngine& AudioPluginAudioProcessor::getClassifierLayout() const
+{
+    return pairEngine;
+}
+
+bool AudioPluginAudioProcessor::getFastPath (const InputClassifier& input, InputClassifier::FastPath& result,
+                                             const bool isWholeStream)
+{
+    const int numInputs = pairEngine.getNumChannels();
+    const ProcessingMode currentMode = getProcessingMode();
+
+    result.setNumOutputs (hasCentreOutput ? numInputs * 2 : numInputs);
+
+    if (input.isSilent())
+    {
+        // Silence in gives silence out, as long as nothing is still ringing
+        switch (currentMode)
+        {
+            case azimuthMode:   return isWholeStream || (azimuthEngines [activeAzimuth].stft.isQuiescent()
+                                                      && azimuthEngines [activeAzimuth].discriminator.isQuiescent());
+            case adaptiveMode:  return isWholeStream || (adaptive.isQuiescent() && ! batchMember.isActive());
+            default:            return true;
+        }
+    }
+
+    // The adaptive estimates of a dual-mono or inverted pair only converge on the exact
+    // answer, and a one-sided pair still moves the filters on that side, so this only
+    // works for a whole stream, from a freshly prepared state
+    if (currentMode == azimuthMode || (currentMode == adaptiveMode && ! isWholeStream))
+        return false;
+
+    // (an output that doesn't exist, because there's no centre output, is just ignored)
+    const int centre = numInputs;
+
+    for (int ch = 0; ch < numInputs; ++ch)
+    {
+        if (pairEngine.isPairedChannel (ch))
+            continue;
+
+        if (ch == pairEngine.getCentreChannel())
+            result.setOutput (centre + ch, ch, 1.0f);
+        else
+            result.setOutput (ch, ch, 1.0f);
+    }
+
+    for (int p = 0; p < pairEngine.getNumPairs(); ++p)
+    {
+        const int l = pairEngine.getLeftChannel (p);
+        const int r = pairEngine.getRightChannel (p);
+
+        // These are exactly what the processing gives: in the centre mode, the residual
+        // is L - R on both sides and the centre is L - (L - R) / 2, and in the adaptive
+        // mode, a pair with one silent side never has any correlation to remove.
+        switch (input.getPairType (p))
+        {
+            case InputClassifier::silent:
+                break;
+
+            case InputClassifier::dualMono:
+                if (currentMode == adaptiveMode)
+                    return false;
+
+                result.setOutput (centre + l, l, 1.0f);
+                result.setOutput (centre + r, l, 1.0f);
+                break;
+
+            case InputClassifier::polarityInverted:
+                if (currentMode == adaptiveMode)
+                    return false;
+
+                result.setOutput (l, l, 2.0f);
+                result.setOutput (r, l, 2.0f);
+                break;
+
+            case InputClassifier::leftOnly:
+                result.setOutput (l, l, 1.0f);
+
+                if (currentMode == centreCancelMode)
+                {
+                    result.setOutput (r, l, 1.0f);
+                    result.setOutput (centre + l, l, 0.5f);
+                    result.setOutput (centre + r, l, 0.5f);
+                }
+                break;
+
+            case InputClassifier::rightOnly:
+                if (currentMode == centreCancelMode)
+                {
+                    result.setOutput (l, r, -1.0f);
+                    result.setOutput (r, r, -1.0f);
+                    result.setOutput (centre + l, r, 0.5f);
+                    result.setOutput (centre + r, r, 0.5f);
+                }
+                else
+                {
+                    result.setOutput (r, r, 1.0f);
+                }
+                break;
+
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
 //==============================================================================
 bool AudioPluginAudioProcessor::hasEditor() const
 {
@@ -175,15 +635,56 @@ AudioProcessorEditor* AudioPluginAudioProcessor::createEditor()
 //==============================================================================
 void AudioPluginAudioProcessor::getStateInformation (MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    XmlElement xml ("CENTREREMOVERSETTINGS");
+    xml.setAttribute ("mode", getParameter (modeParam));
+    xml.setAttribute ("position", getParameter (positionParam));
+    xml.setAttribute ("width", getParameter (widthParam));
+    xml.setAttribute ("latency", getParameter (latencyParam));
+    xml.setAttribute ("smoothing", getParameter (smoothingParam));
+    xml.setAttribute ("floor", getParameter (floorParam));
+
+    copyXmlToBinary (xml, destData);
 }
 
 void AudioPluginAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    ScopedPointer<XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
+
+    if (xmlState != nullptr && xmlState->hasTagName ("CENTREREMOVERSETTINGS"))
+    {
+        const ScopedLock sl (recallWriteLock);
+
+        float* const values = recallSets [recallWriteIndex].values;
+        values [modeParam]      = (float) xmlState->getDoubleAttribute ("mode", getParameter (modeParam));
+        values [positionParam]  = (float) xmlState->getDoubleAttribute ("position", getParameter (positionParam));
+        values [widthParam]     = (float) xmlState->getDoubleAttribute ("width", getParameter (widthParam));
+        values [latencyParam]   = (float) xmlState->getDoubleAttribute ("latency", getParameter (latencyParam));
+        values [smoothingParam] = (float) xmlState->getDoubleAttribute ("smoothing", getParameter (smoothingParam));
+        values [floorParam]     = (float) xmlState->getDoubleAttribute ("floor", getParameter (floorParam));
+
+        lastRecall = recallSets [recallWriteIndex];
+        recallWriteIndex = recallMiddle.exchange (recallWriteIndex | recallIsFresh) & 3;
+        ++numRecallsPublished;
+    }
+}
+
+void AudioPluginAudioProcessor::takeRecalledState()
+{
+    // (this is read first, so that every recall it counts has been published by the time
+    // the shared set is checked)
+    const int numPublished = numRecallsPublished.get();
+
+    if ((recallMiddle.get() & recallIsFresh) != 0)
+    {
+        recallReadIndex = recallMiddle.exchange (recallReadIndex) & 3;
+
+        const ParameterSet& state = recallSets [recallReadIndex];
+
+        for (int i = 0; i < totalNumParams; ++i)
+            setParameter (i, state.values[i]);
+    }
+
+    numRecallsTaken.set (numPublished);
 }
 
 //==============================================================================
@@ -12,14 +12,44 @@
 #define __PLUGINPROCESSOR_H_80F2E4E9__
 
 #include "../JuceLibraryCode/JuceHeader.h"
+#include "FixedBlockAdapter.h"
+#include "ChannelPairEngine.h"
+#include "AzimuthDiscriminator.h"
+#include "MultiResolutionSTFT.h"
+#include "AdaptiveBatchEngine.h"
+#include "InputClassifier.h"
 
 
 //==============================================================================
 /**
 */
-class AudioPluginAudioProcessor  : public AudioProcessor
+class AudioPluginAudioProcessor  : public AudioProcessor,
+                                   public InputClassifier::Client,
+                                   private FixedBlockAdapter::Client,
+                                   private AsyncUpdater
 {
 public:
+    //==============================================================================
+    enum Parameters
+    {
+        modeParam = 0,          /**< selects a ProcessingMode: 0 for centreCancelMode, 0.5 for adaptiveMode, 1 for azimuthMode */
+        positionParam,          /**< in the azimuth mode, the pan position to remove, from hard left (0) to hard right (1) */
+        widthParam,             /**< in the azimuth mode, the width of the region to remove, as a fraction of the whole field */
+        latencyParam,           /**< in the azimuth mode, chooses a latency from 256 samples (0) up to 4096 samples (1) */
+        smoothingParam,         /**< in the azimuth mode, smooths the mask over time and frequency, from none (0) to 80ms and half an ERB (1) */
+        floorParam,             /**< in the azimuth mode, the least gain that a removed bin is left with, from silence (0) to unchanged (1) */
+
+        totalNumParams
+    };
+
+    /** The ways that the centre can be removed. */
+    enum ProcessingMode
+    {
+        centreCancelMode = 0,   /**< subtracts the mid from each side, with no latency */
+        adaptiveMode,           /**< keeps the stereo image by estimating the centre per band, with no latency */
+        azimuthMode             /**< removes sources at any pan position using a multi-resolution STFT, with a selectable latency */
+    };
+
     //==============================================================================
     AudioPluginAudioProcessor();
     ~AudioPluginAudioProcessor();
@@ -29,6 +59,65 @@ public:
     void releaseResources();
 
     void processBlock (AudioSampleBuffer& buffer, MidiBuffer& midiMessages);
+    void reset();
+
+    //==============================================================================
+    /** Sets the size of the frames that the audio is processed in, whatever block size
+        the host uses. This must be a power of two, and takes effect at the next call to
+        prepareToPlay(). If the host's block size is a multiple of it, the audio is
+        processed in place; otherwise it's re-blocked through a FIFO, which adds one
+        frame of latency.
+    */
+    void setInternalBlockSize (int newBlockSize);
+
+    /** Returns the size of the frames that the audio is processed in. */
+    int getInternalBlockSize() const noexcept           { return internalBlockSize; }
+
+    /** Chooses whether the adaptive mode is run by the process-wide AdaptiveBatchEngine,
+        together with every other instance that has opted in, which adds one frame of
+        latency. This takes effect at the next call to prepareToPlay(). It's off by
+        default, unless the environment variable CENTREREMOVER_BATCH is set to 1, which
+        lets it be turned on for every instance that a host loads.
+    */
+    void setBatchProcessingEnabled (bool shouldBeEnabled);
+
+    /** Returns true if batch processing has been chosen. */
+    bool isBatchProcessingEnabled() const noexcept      { return useBatchEngine; }
+
+    /** Chooses whether each frame is first scanned by an InputClassifier, so that frames
+        of silence, dual-mono, polarity-inverted or one-sided audio can skip the
+        processing when its result is known. The output is the same either way. This is
+        off by default, because for most material the scan is wasted.
+    */
+    void setFastPathsEnabled (bool shouldBeEnabled) noexcept   { useFastPaths = shouldBeEnabled; }
+
+    /** Returns true if frames are being classified before they're processed. */
+    bool areFastPathsEnabled() const noexcept           { return useFastPaths; }
+
+    /** Returns the number of samples, since prepareToPlay(), that took a fast path. */
+    int64 getNumFastPathSamples() const noexcept        { return numFastPathSamples; }
+
+    /** Returns the number of samples, since prepareToPlay(), that were processed. */
+    int64 getNumProcessedSamples() const noexcept       { return numProcessedSamples; }
+
+    //==============================================================================
+    const ChannelPairEngine& getClassifierLayout() const;
+    bool getFastPath (const InputClassifier& input, InputClassifier::FastPath& result, bool isWholeStream);
+
+    /** Returns true if the plugin has twice as many outputs as inputs, in which case the
+        second half of the outputs carries the centre that was removed from the first half.
+    */
+    bool isCentreOutputEnabled() const noexcept         { return hasCentreOutput; }
+
+    /** Returns the mode that the mode parameter currently selects. */
+    ProcessingMode getProcessingMode() const noexcept   { return (ProcessingMode) jlimit (0, 2, roundToInt (mode * 2.0f)); }
+
+    /** Returns the MultiResolutionSTFT latency setting that the latency parameter selects. */
+    int getLatencySetting() const noexcept
+    {
+        const int maxSetting = MultiResolutionSTFT::numLatencySettings - 1;
+        return jlimit (0, maxSetting, roundToInt (latency * maxSetting));
+    }
 
     //==============================================================================
     AudioProcessorEditor* createEditor();
@@ -64,10 +153,66 @@ public:
 
     //==============================================================================
     void getStateInformation (MemoryBlock& destData);
+
+    /** Recalls a saved state without glitching, even while playing. The whole set of
+        parameters is built on the calling thread and handed to the audio thread in one
+        go, which takes it at the start of its next block, and crossfades any change of
+        mode or latency as it would when those parameters are automated. Until then,
+        getParameter() returns the recalled values. The new latency is reported to the
+        host asynchronously.
+    */
     void setStateInformation (const void* data, int sizeInBytes);
 
 private:
     //==============================================================================
+    /** The azimuth mode's STFT and discriminator. There are two of these, so that when
+        the latency changes, the old one can be faded out while the new one starts.
+    */
+    struct AzimuthEngine
+    {
+        MultiResolutionSTFT stft;
+        AzimuthDiscriminator discriminator;
+    };
+
+    FixedBlockAdapter blockAdapter;
+    ChannelPairEngine pairEngine;
+    AzimuthEngine azimuthEngines [2];
+    AdaptiveCentreExtractor adaptive;
+    AdaptiveBatchEngine::Member batchMember;
+    InputClassifier classifier;
+    AudioSampleBuffer fastPathInput, fadeBuffer;
+    ProcessingMode lastMode, fadingMode;
+    int lastLatencySetting, activeAzimuth, fadingAzimuth, fadeLength, fadeSamplesLeft;
+    int internalBlockSize;
+    int64 numFastPathSamples, numProcessedSamples;
+    bool hasCentreOutput, useBatchEngine, useFastPaths;
+    float mode, position, width, latency, smoothing, maskFloor;
+
+    // A recalled state is passed to the audio thread through a triple buffer, so that it
+    // never sees one half-applied, and neither side ever waits for the other
+    struct ParameterSet
+    {
+        float values [totalNumParams];
+    };
+
+    enum { recallIsFresh = 4 };
+
+    ParameterSet recallSets [3], lastRecall;
+    Atomic<int> recallMiddle;               // the index of the shared set, plus recallIsFresh
+    Atomic<int> numRecallsPublished, numRecallsTaken;
+    int recallWriteIndex, recallReadIndex;
+    CriticalSection recallWriteLock;        // (only taken by callers of setStateInformation)
+
+    void processFixedBlock (AudioSampleBuffer& frame);
+    void processWithMode (AudioSampleBuffer& frame, ProcessingMode currentMode, AzimuthEngine& engine);
+    void processCrossfade (AudioSampleBuffer& frame);
+    void startCrossfade (ProcessingMode newMode, int newLatencySetting);
+    int getTotalLatency() const noexcept;
+    void handleAsyncUpdate();
+    void resetAdaptive();
+    bool processFastPath (AudioSampleBuffer& frame);
+    void takeRecalledState();
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioPluginAudioProcessor)
 };
 
@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    RealFFT.cpp
+
+    A radix-2 FFT for real signals.
+
+  ==============================================================================
+*/
+
+#include "RealFFT.h"
+
+
+//==============================================================================
+namespace RealFFTHelpers
+{
+    static SharedTableCache<RealFFT::Tables> sharedTables;
+}
+
+RealFFT::Tables::Tables (const int size_)
+    : size (size_), halfSize (size_ / 2)
+{
+    bitReversed.malloc ((size_t) halfSize);
+    twiddleReal.malloc ((size_t) halfSize / 2);
+    twiddleImag.malloc ((size_t) halfSize / 2);
+    unpackReal.malloc ((size_t) halfSize + 1);
+    unpackImag.malloc ((size_t) halfSize + 1);
+
+    int numBits = 0;
+    while ((1 << numBits) < halfSize)
+        ++numBits;
+
+    for (int i = 0; i < halfSize; ++i)
+    {
+        int reversed = 0;
+
+        for (int bit = 0; bit < numBits; ++bit)
+            if ((i & (1 << bit)) != 0)
+                reversed |= 1 << (numBits - 1 - bit);
+
+        bitReversed[i] = reversed;
+    }
+
+    for (int i = 0; i < halfSize / 2; ++i)
+    {
+        const double angle = -2.0 * double_Pi * i / halfSize;
+        twiddleReal[i] = (float) std::cos (angle);
+        twiddleImag[i] = (float) std::sin (angle);
+    }
+
+    for (int i = 0; i <= halfSize; ++i)
+    {
+        const double angle = -2.0 * double_Pi * i / size;
+        unpackReal[i] = (float) std::cos (angle);
+        unpackImag[i] = (float) std::sin (angle);
+    }
+}
+
+//==============================================================================
+RealFFT::RealFFT (const int order)
+    : size (1 << jmax (2, order)), halfSize (size / 2),
+      tables (RealFFTHelpers::sharedTables.getFor (size)),
+      bitReversed (tables->bitReversed), twiddleReal (tables->twiddleReal), twiddleImag (tables->twiddleImag),
+      unpackReal (tables->unpackReal), unpackImag (tables->unpackImag)
+{
+    scratch.malloc ((size_t) size);
+}
+
+RealFFT::~RealFFT()
+{
+}
+
+//==============================================================================
+void RealFFT::performComplex (const bool inverse) noexcept
+{
+    float* const data = scratch;
+
+    for (int i = 0; i < halfSize; ++i)
+    {
+        const int j = bitReversed[i];
+
+        if (j > i)
+        {
+            std::swap (data [i * 2],     data [j * 2]);
+            std::swap (data [i * 2 + 1], data [j * 2 + 1]);
+        }
+    }
+
+    const float sign = inverse ? -1.0f : 1.0f;
+
+    for (int span = 1; span < halfSize; span *= 2)
+    {
+        const int step = halfSize / (span * 2);
+
+        for (int start = 0; start < halfSize; start += span * 2)
+        {
+            for (int k = 0; k < span; ++k)
+            {
+                const float wr = twiddleReal [k * step];
+                const float wi = twiddleImag [k * step] * sign;
+
+                float* const a = data + (start + k) * 2;
+                float* const b = a + span * 2;
+
+                const float br = b[0] * wr - b[1] * wi;
+                const float bi = b[0] * wi + b[1] * wr;
+
+                b[0] = a[0] - br;
+                b[1] = a[1] - bi;
+                a[0] += br;
+                a[1] += bi;
+            }
+        }
+    }
+}
+
+void RealFFT::performForward (const float* const input, float* const real, float* const imag) noexcept
+{
+    // The even samples go in the real parts and the odd ones in the imaginary parts
+    memcpy (scratch, input, sizeof (float) * (size_t) size);
+    performComplex (false);
+
+    const float* const z = scratch;
+
+    for (int k = 0; k <= halfSize; ++k)
+    {
+        const int k1 = k < halfSize ? k : 0;
+        const int k2 = k > 0 ? halfSize - k : 0;
+
+        // the spectra of the even and odd samples
+        const float evenReal = 0.5f * (z [k1 * 2] + z [k2 * 2]);
+        const float evenImag = 0.5f * (z [k1 * 2 + 1] - z [k2 * 2 + 1]);
+        const float oddReal  = 0.5f * (z [k1 * 2 + 1] + z [k2 * 2 + 1]);
+        const float oddImag  = 0.5f * (z [k2 * 2] - z [k1 * 2]);
+
+        real[k] = evenReal + oddReal * unpackReal[k] - oddImag * unpackImag[k];
+        imag[k] = evenImag + oddReal * unpackImag[k] + oddImag * unpackReal[k];
+    }
+}
+
+void RealFFT::performInverse (const float* const real, const float* const imag, float* const output) noexcept
+{
+    float* const z = scratch;
+
+    for (int k = 0; k < halfSize; ++k)
+    {
+        const int k2 = halfSize - k;
+        const float xr = real[k], xi = (k > 0 ? imag[k] : 0.0f);
+        const float yr = real[k2], yi = (k2 < halfSize ? -imag[k2] : 0.0f);     // conj (X [N/2 - k])
+
+        const float evenReal = xr + yr;
+        const float evenImag = xi + yi;
+        const float diffReal = xr - yr;
+        const float diffImag = xi - yi;
+
+        // odd = diff * exp (2 pi i k / N)
+        const float oddReal = diffReal * unpackReal[k] + diffImag * unpackImag[k];
+        const float oddImag = diffImag * unpackReal[k] - diffReal * unpackImag[k];
+
+        z [k * 2]     = evenReal - oddImag;
+        z [k * 2 + 1] = evenImag + oddReal;
+    }
+
+    performComplex (true);
+    memcpy (output, z, sizeof (float) * (size_t) size);
+}
@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    RealFFT.h
+
+    A radix-2 FFT for real signals.
+
+  ==============================================================================
+*/
+
+#ifndef __REALFFT_H_41C7A2E9__
+#define __REALFFT_H_41C7A2E9__
+
+#include "SharedTableCache.h"
+
+
+//==============================================================================
+/**
+    Transforms blocks of real samples to and from their spectra.
+
+    A real block of N samples is packed into a complex FFT of size N / 2, and its
+    result unpacked into the N / 2 + 1 non-negative frequency bins, so it costs about
+    half of a complex transform. The spectra are in split form: separate arrays of
+    real and imaginary parts, which are easier to vectorise over bins than
+    interleaved pairs.
+
+    The twiddle factors and bit-reversal table are shared by every transform of the
+    same size in the process, so only the first one to be created has to build them.
+    The transforms themselves don't allocate anything. Each instance has its own
+    scratch space, so one instance mustn't be used by two threads at once.
+*/
+class RealFFT
+{
+public:
+    //==============================================================================
+    /** Creates a transform for blocks of 2 ^ order samples. The order must be at least 2. */
+    explicit RealFFT (int order);
+
+    /** Destructor. */
+    ~RealFFT();
+
+    //==============================================================================
+    /** Returns the number of samples in a block. */
+    int getSize() const noexcept                        { return size; }
+
+    /** Returns the number of bins in a spectrum, which is getSize() / 2 + 1. */
+    int getNumBins() const noexcept                     { return size / 2 + 1; }
+
+    //==============================================================================
+    /** Transforms getSize() samples into getNumBins() bins. */
+    void performForward (const float* input, float* real, float* imag) noexcept;
+
+    /** Transforms getNumBins() bins back into getSize() samples.
+
+        As with most FFTs, the result isn't normalised: a forward and inverse transform
+        leave the samples multiplied by getSize(). The imaginary parts of the first and
+        last bins are ignored.
+    */
+    void performInverse (const float* real, const float* imag, float* output) noexcept;
+
+    //==============================================================================
+    /** The read-only tables for one size of transform, which are shared between instances. */
+    class Tables  : public ReferenceCountedObject
+    {
+    public:
+        explicit Tables (int size);
+        bool matches (int otherSize) const noexcept     { return size == otherSize; }
+
+        const int size, halfSize;
+        HeapBlock<int> bitReversed;
+        HeapBlock<float> twiddleReal, twiddleImag;      // the complex FFT's factors, for halfSize / 2 steps
+        HeapBlock<float> unpackReal, unpackImag;        // the factors for splitting the packed result, for halfSize + 1 bins
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE (Tables)
+    };
+
+private:
+    //==============================================================================
+    const int size, halfSize;
+    const ReferenceCountedObjectPtr<Tables> tables;
+    const int* const bitReversed;
+    const float* const twiddleReal;
+    const float* const twiddleImag;
+    const float* const unpackReal;
+    const float* const unpackImag;
+    HeapBlock<float> scratch;                       // halfSize interleaved complex values
+
+    void performComplex (bool inverse) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE (RealFFT)
+};
+
+
+#endif  // __REALFFT_H_41C7A2E9__
@@ -0,0 +1,322 @@
+/*
+  ==============================================================================
+
+    RenderCache.cpp
+
+    A local cache of rendered files, keyed on everything that affects the render.
+
+  ==============================================================================
+*/
+
+#include "RenderCache.h"
+
+#if JUCE_WINDOWS
+ #include <windows.h>
+#else
+ #include <unistd.h>
+#endif
+
+
+//==============================================================================
+namespace RenderCacheHelpers
+{
+    // A plain SHA-256 implementation, since the tree has no cryptography module.
+    class SHA256
+    {
+    public:
+        SHA256() noexcept
+            : numBytesInBuffer (0), totalBytes (0)
+        {
+            static const uint32 initialState[] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                                   0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+            memcpy (state, initialState, sizeof (state));
+        }
+
+        void process (const void* data, size_t numBytes) noexcept
+        {
+            const uint8* source = static_cast <const uint8*> (data);
+            totalBytes += numBytes;
+
+            while (numBytes > 0)
+            {
+                const size_t num = jmin (numBytes, (size_t) 64 - numBytesInBuffer);
+                memcpy (buffer + numBytesInBuffer, source, num);
+                numBytesInBuffer += num;
+                source += num;
+                numBytes -= num;
+
+                if (numBytesInBuffer == 64)
+                {
+                    processBlock (buffer);
+                    numBytesInBuffer = 0;
+                }
+            }
+        }
+
+        void processInt (const int64 value) noexcept
+        {
+            uint8 bytes[8];
+
+            for (int i = 0; i < 8; ++i)
+                bytes[i] = (uint8) (value >> (i * 8));
+
+            process (bytes, sizeof (bytes));
+        }
+
+        String finishAsHexString()
+        {
+            const uint64 totalBits = totalBytes * 8;
+            const uint8 padStart = 0x80, zero = 0;
+
+            process (&padStart, 1);
+
+            while (numBytesInBuffer != 56)
+                process (&zero, 1);
+
+            uint8 length[8];
+
+            for (int i = 0; i < 8; ++i)
+                length[i] = (uint8) (totalBits >> ((7 - i) * 8));
+
+            process (length, sizeof (length));
+
+            String result;
+
+            for (int i = 0; i < 8; ++i)
+                result << String::toHexString ((int) state[i]).paddedLeft ('0', 8);
+
+            return result;
+        }
+
+    private:
+        uint32 state[8];
+        uint8 buffer[64];
+        size_t numBytesInBuffer;
+        uint64 totalBytes;
+
+        static inline uint32 rotate (const uint32 x, const int n) noexcept   { return (x >> n) | (x << (32 - n)); }
+
+        void processBlock (const uint8* const block) noexcept
+        {
+            static const uint32 k[] =
+            {
+                0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+                0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+                0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+                0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+                0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+                0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+                0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+                0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+            };
+
+            uint32 w[64];
+
+            for (int i = 0; i < 16; ++i)
+                w[i] = (((uint32) block [i * 4]) << 24) | (((uint32) block [i * 4 + 1]) << 16)
+                        | (((uint32) block [i * 4 + 2]) << 8) | ((uint32) block [i * 4 + 3]);
+
+            for (int i = 16; i < 64; ++i)
+            {
+                const uint32 s0 = rotate (w[i - 15], 7) ^ rotate (w[i - 15], 18) ^ (w[i - 15] >> 3);
+                const uint32 s1 = rotate (w[i - 2], 17) ^ rotate (w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+
+            uint32 a = state[0], b = state[1], c = state[2], d = state[3],
+                   e = state[4], f = state[5], g = state[6], h = state[7];
+
+            for (int i = 0; i < 64; ++i)
+            {
+                const uint32 t1 = h + (rotate (e, 6) ^ rotate (e, 11) ^ rotate (e, 25))
+                                    + ((e & f) ^ (~e & g)) + k[i] + w[i];
+                const uint32 t2 = (rotate (a, 2) ^ rotate (a, 13) ^ rotate (a, 22))
+                                    + ((a & b) ^ (a & c) ^ (b & c));
+
+                h = g;  g = f;  f = e;  e = d + t1;
+                d = c;  c = b;  b = a;  a = t1 + t2;
+            }
+
+            state[0] += a;  state[1] += b;  state[2] += c;  state[3] += d;
+            state[4] += e;  state[5] += f;  state[6] += g;  state[7] += h;
+        }
+
+        JUCE_DECLARE_NON_COPYABLE (SHA256)
+    };
+
+    static bool linkOrCopy (const File& source, const File& target)
+    {
+       #if JUCE_WINDOWS
+        if (CreateHardLinkW (target.getFullPathName().toWideCharPointer(),
+                             source.getFullPathName().toWideCharPointer(), nullptr))
+            return true;
+       #else
+        if (link (source.getFullPathName().toUTF8(), target.getFullPathName().toUTF8()) == 0)
+            return true;
+       #endif
+
+        return source.copyFileTo (target);
+    }
+
+    static bool isEntryFile (const File& file)
+    {
+        const String name (file.getFileNameWithoutExtension());
+        return name.length() == 64 && name.containsOnly ("0123456789abcdef");
+    }
+
+    struct LeastRecentlyUsedFirst
+    {
+        static int compareElements (const File& first, const File& second)
+        {
+            const int64 t1 = first.getLastModificationTime().toMilliseconds();
+            const int64 t2 = second.getLastModificationTime().toMilliseconds();
+
+            return t1 < t2 ? -1 : (t1 > t2 ? 1 : 0);
+        }
+    };
+}
+
+//==============================================================================
+RenderCache::RenderCache (const File& directory_, const int64 maxSizeInBytes)
+    : directory (directory_), maxSize (maxSizeInBytes), numHits (0)
+{
+    directory.createDirectory();
+}
+
+RenderCache::~RenderCache()
+{
+}
+
+//==============================================================================
+String RenderCache::createKey (const File& inputFile, const MemoryBlock& processorState, const String& settings)
+{
+    FileInputStream in (inputFile);
+
+    if (in.failedToOpen())
+        return String::empty;
+
+    RenderCacheHelpers::SHA256 hash;
+
+    // (each part is preceded by its length, so that no two sets of parts can run together the same way)
+    const String::CharPointerType settingsText (settings.toUTF8());
+    const size_t settingsSize = settingsText.sizeInBytes();
+    hash.processInt ((int64) settingsSize);
+    hash.process (settingsText.getAddress(), settingsSize);
+
+    hash.processInt ((int64) processorState.getSize());
+    hash.process (processorState.getData(), processorState.getSize());
+
+    hash.processInt (in.getTotalLength());
+
+    HeapBlock<char> buffer (65536);
+
+    for (;;)
+    {
+        const int numRead = in.read (buffer, 65536);
+
+        if (numRead <= 0)
+            break;
+
+        hash.process (buffer, (size_t) numRead);
+    }
+
+    return hash.finishAsHexString();
+}
+
+File RenderCache::getEntryFile (const String& key, const String& extension) const
+{
+    return directory.getChildFile (key + extension.toLowerCase());
+}
+
+bool RenderCache::fetch (const String& key, const File& outputFile)
+{
+    if (key.isEmpty())
+        return false;
+
+    const File entry (getEntryFile (key, outputFile.getFileExtension()));
+
+    if (! entry.existsAsFile())
+        return false;
+
+    outputFile.deleteFile();
+
+    if (! RenderCacheHelpers::linkOrCopy (entry, outputFile))
+        return false;
+
+    // this marks the entry as recently used, and makes the output look freshly written
+    // to any build tools that are checking its date
+    const Time now (Time::getCurrentTime());
+    entry.setLastModificationTime (now);
+    outputFile.setLastModificationTime (now);
+
+    ++numHits;
+    return true;
+}
+
+bool RenderCache::store (const String& key, const File& renderedFile)
+{
+    if (key.isEmpty() || ! renderedFile.existsAsFile())
+        return false;
+
+    const File entry (getEntryFile (key, renderedFile.getFileExtension()));
+
+    // the entry is assembled under a temporary name and then moved into place, so that
+    // another renderer sharing the cache can never see a partly-written one
+    TemporaryFile temp (entry, TemporaryFile::useHiddenFile);
+
+    if (! (RenderCacheHelpers::linkOrCopy (renderedFile, temp.getFile())
+             && temp.overwriteTargetFileWithTemporary()))
+        return false;
+
+    entry.setLastModificationTime (Time::getCurrentTime());
+    trimToSizeLimit();
+    return true;
+}
+
+//==============================================================================
+void RenderCache::findEntries (Array<File>& results) const
+{
+    Array<File> files;
+    directory.findChildFiles (files, File::findFiles, false);
+
+    for (int i = 0; i < files.size(); ++i)
+        if (RenderCacheHelpers::isEntryFile (files.getReference (i)))
+            results.add (files.getReference (i));
+}
+
+int64 RenderCache::getTotalSize() const
+{
+    Array<File> entries;
+    findEntries (entries);
+
+    int64 total = 0;
+
+    for (int i = 0; i < entries.size(); ++i)
+        total += entries.getReference (i).getSize();
+
+    return total;
+}
+
+void RenderCache::trimToSizeLimit()
+{
+    Array<File> entries;
+    findEntries (entries);
+
+    RenderCacheHelpers::LeastRecentlyUsedFirst comparator;
+    entries.sort (comparator);
+
+    int64 total = 0;
+
+    for (int i = 0; i < entries.size(); ++i)
+        total += entries.getReference (i).getSize();
+
+    for (int i = 0; i < entries.size() && total > maxSize; ++i)
+    {
+        const File& entry = entries.getReference (i);
+        const int64 size = entry.getSize();
+
+        if (entry.deleteFile())
+            total -= size;
+    }
+}
@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    RenderCache.h
+
+    A local cache of rendered files, keyed on everything that affects the render.
+
+  ==============================================================================
+*/
+
+#ifndef __RENDERCACHE_H_9C27E5B0__
+#define __RENDERCACHE_H_9C27E5B0__
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+
+//==============================================================================
+/**
+    Keeps copies of rendered output files in a directory, so that rendering the same
+    input again with the same settings can reuse the earlier result.
+
+    Each entry is named after a SHA-256 key, made from the bytes of the input file,
+    the processor's state and a string describing everything else that affects the
+    output (the plugin version, block size, sample rate, output format...). So a
+    changed input or setting just produces a different key, and entries never need
+    to be invalidated.
+
+    Entries are hard-linked to the output files where the file system allows it, and
+    copied otherwise. Because of the hard links, an output file should be replaced
+    rather than modified in place (which is what the renderer does anyway), or the
+    cached copy would change with it.
+
+    Every time an entry is stored or reused, its modification time is set to the
+    current time, and when the directory grows past its size limit, the entries that
+    were least recently used are deleted.
+*/
+class RenderCache
+{
+public:
+    //==============================================================================
+    /** Creates a cache that uses the given directory, which is created if necessary. */
+    RenderCache (const File& directory, int64 maxSizeInBytes);
+
+    /** Destructor. */
+    ~RenderCache();
+
+    //==============================================================================
+    /** Creates the key for rendering an input file. Returns an empty string if the
+        file can't be read.
+
+        @param inputFile        the file being rendered; its whole contents are hashed
+        @param processorState   the data from the processor's getStateInformation()
+        @param settings         a description of any other settings that affect the output
+    */
+    static String createKey (const File& inputFile, const MemoryBlock& processorState, const String& settings);
+
+    /** If there's an entry for this key, this links or copies it to the output file and
+        returns true. The key's entry must have the same file extension as the output.
+    */
+    bool fetch (const String& key, const File& outputFile);
+
+    /** Adds a freshly rendered file to the cache, and then trims the cache to its size limit. */
+    bool store (const String& key, const File& renderedFile);
+
+    /** Deletes the least recently used entries until the cache fits in its size limit. */
+    void trimToSizeLimit();
+
+    //==============================================================================
+    /** Returns the total size of the entries in the cache. */
+    int64 getTotalSize() const;
+
+    /** Returns the number of times fetch() has found an entry. */
+    int getNumHits() const noexcept                 { return numHits; }
+
+private:
+    //==============================================================================
+    const File directory;
+    const int64 maxSize;
+    int numHits;
+
+    File getEntryFile (const String& key, const String& extension) const;
+    void findEntries (Array<File>& results) const;
+
+    JUCE_DECLARE_NON_COPYABLE (RenderCache)
+};
+
+
+#endif  // __RENDERCACHE_H_9C27E5B0__
@@ -0,0 +1,363 @@
+/*
+  ==============================================================================
+
+    RendererMain.cpp
+
+    Entry point for the command-line renderer, which runs the plugin over audio
+    files, or over a stream of audio arriving on stdin.
+
+    Usage:
+        renderer [options] <input file> <output file>
+        renderer --pipe [options] < input > output
+        renderer --benchmark-masks
+        renderer --self-check
+
+    Options:
+        --block <n>         the processing block size (default 1024)
+        --resample <hz>     convert the input to this rate before processing it
+        --quality <q>       resampling quality: fast, standard, high or mastering (default high)
+        --param <name> <v>  set one of the plugin's parameters (0 to 1) before rendering; this
+                            can be given more than once
+        --timing            print the processor's per-block timing statistics when finished
+        --detect-denormals  process with denormals enabled, and report where they occur
+        --trace <file>      write a Chrome trace of the render (needs JUCE_ENABLE_TRACING)
+        --check-realtime    report any allocations or locks made while processing, and fail if
+                            there were any (needs JUCE_ENABLE_REALTIME_SAFETY_CHECKS)
+        --strict-realtime   like --check-realtime, but abort at the first one
+
+    --benchmark-masks times the azimuth mode's mask smoothing against the FFTs that
+    it runs alongside, for each frame size, and prints the results.
+
+    --self-check runs the processing code's consistency checks, prints what they found,
+    and fails if any of them did.
+
+    File options:
+        --extract <file>    also write the centre that was removed to this file, from the
+                            same processing pass
+        --cache <dir>       reuse earlier renders of the same input and settings from this
+                            directory, and add new renders to it
+        --cache-size <mb>   the size limit for the cache directory (default 10240)
+        --no-fast-paths     always run the processor, even for silent, dual-mono,
+                            polarity-inverted or one-sided input
+
+    Pipe options:
+        --wav-in            the input starts with a WAV header
+        --wav-out           write a WAV header before the output data
+        --format <f>        raw input sample format: f32, s16, s24 or s32 (default f32)
+        --out-format <f>    output sample format (default: same as the input)
+        --channels <n>      raw input channel count (default 2)
+        --rate <hz>         raw input sample rate (default 44100)
+
+  ==============================================================================
+*/
+
+#include "CommandLineRenderer.h"
+#include "SpectralMaskProcessor.h"
+#include "AdaptiveBatchEngine.h"
+
+AudioProcessor* JUCE_CALLTYPE createPluginFilter();
+
+
+//==============================================================================
+static void printUsage()
+{
+    std::cerr << "Usage: renderer [--block n] [--resample hz] [--quality q] [--param name value]..." << std::endl
+              << "                [--timing] [--trace file]" << std::endl
+              << "                [--detect-denormals] [--check-realtime] [--strict-realtime]" << std::endl
+              << "                [--cache dir] [--cache-size mb] [--extract file] [--no-fast-paths]" << std::endl
+              << "                <input file> <output file>" << std::endl
+              << "       renderer --pipe [--wav-in] [--wav-out] [--format f32|s16|s24|s32]" << std::endl
+              << "                [--out-format f32|s16|s24|s32] [--channels n] [--rate hz]" << std::endl
+              << "                [--block n] [--resample hz] [--quality fast|standard|high|mastering]" << std::endl
+              << "                [--param name value]..." << std::endl
+              << "                [--timing] [--trace file] [--detect-denormals]" << std::endl
+              << "                [--check-realtime] [--strict-realtime]" << std::endl
+              << "       renderer --benchmark-masks" << std::endl
+              << "       renderer --self-check" << std::endl;
+}
+
+static bool parseQuality (const String& name, PolyphaseResampler::Quality& result)
+{
+    if (name == "fast")         { result = PolyphaseResampler::fastQuality;      return true; }
+    if (name == "standard")     { result = PolyphaseResampler::standardQuality;  return true; }
+    if (name == "high")         { result = PolyphaseResampler::highQuality;      return true; }
+    if (name == "mastering")    { result = PolyphaseResampler::masteringQuality; return true; }
+
+    return false;
+}
+
+static void printTimingStats (AudioProcessor& processor)
+{
+    const AudioProcessorTimingStats::Snapshot s (processor.getTimingStats().getSnapshot());
+
+    std::cerr << "Blocks processed: " << s.numBlocks << std::endl
+              << "Time per sample: median " << String (s.getMedianNanosPerSample(), 1)
+              << "ns, 99th percentile " << String (s.get99thPercentileNanosPerSample(), 1)
+              << "ns, max " << String (s.maxNanosPerSample, 1) << "ns" << std::endl;
+
+    if (processor.getTimingStats().isDenormalDetectionEnabled())
+        std::cerr << "Blocks using denormals: " << s.numBlocksWithDenormals
+                  << ", denormal output samples: " << s.numDenormalSamples << std::endl;
+}
+
+static int fail (const String& message)
+{
+    std::cerr << message << std::endl;
+    return 1;
+}
+
+static int finishRender (AudioProcessor& processor, const bool printStats, const bool checkRealtime)
+{
+    TraceRecorder::stop();
+
+    if (printStats)
+        printTimingStats (processor);
+
+    if (checkRealtime)
+    {
+        std::cerr << RealtimeSafetyChecker::getReport();
+
+        if (RealtimeSafetyChecker::getNumViolations() > 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+static bool setParameters (AudioProcessor& processor, const StringPairArray& values, String& error)
+{
+    const StringArray& names = values.getAllKeys();
+
+    for (int i = 0; i < names.size(); ++i)
+    {
+        int index = 0;
+
+        while (index < processor.getNumParameters() && processor.getParameterName (index) != names[i])
+            ++index;
+
+        if (index >= processor.getNumParameters())
+        {
+            error = "Unknown parameter: " + names[i];
+            return false;
+        }
+
+        processor.setParameter (index, jlimit (0.0f, 1.0f, values[names[i]].getFloatValue()));
+    }
+
+    return true;
+}
+
+int main (int argc, char* argv[])
+{
+    StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add (CharPointer_UTF8 (argv[i]));
+
+    if (args.contains ("--benchmark-masks"))
+    {
+        std::cout << SpectralMaskProcessor::runBenchmark();
+        return 0;
+    }
+
+    if (args.contains ("--self-check"))
+    {
+        String report;
+        const bool batchOk = AdaptiveBatchEngine::runBlockSizeCheck (report);
+        const bool masksOk = SpectralMaskProcessor::runPrecisionCheck (report);
+        const bool ok = batchOk && masksOk;
+
+        std::cout << report;
+        return ok ? 0 : 1;
+    }
+
+    int blockSize = 1024;
+    const int blockArg = args.indexOf ("--block");
+
+    if (blockArg >= 0)
+    {
+        blockSize = args[blockArg + 1].getIntValue();
+        args.removeRange (blockArg, 2);
+
+        if (blockSize <= 0)
+            return fail ("Invalid block size");
+    }
+
+    double resampleRate = 0;
+    const int resampleArg = args.indexOf ("--resample");
+
+    if (resampleArg >= 0)
+    {
+        resampleRate = args[resampleArg + 1].getDoubleValue();
+        args.removeRange (resampleArg, 2);
+
+        if (resampleRate <= 0)
+            return fail ("Invalid resampling rate");
+    }
+
+    PolyphaseResampler::Quality quality = PolyphaseResampler::highQuality;
+    const int qualityArg = args.indexOf ("--quality");
+
+    if (qualityArg >= 0)
+    {
+        if (! parseQuality (args[qualityArg + 1], quality))
+            return fail ("Unknown resampling quality: " + args[qualityArg + 1]);
+
+        args.removeRange (qualityArg, 2);
+    }
+
+    StringPairArray parameterValues;
+
+    for (int paramArg; (paramArg = args.indexOf ("--param")) >= 0;)
+    {
+        if (paramArg + 2 >= args.size())
+            return fail ("--param needs a name and a value");
+
+        parameterValues.set (args[paramArg + 1], args[paramArg + 2]);
+        args.removeRange (paramArg, 3);
+    }
+
+    const int timingArg = args.indexOf ("--timing");
+
+    if (timingArg >= 0)
+        args.remove (timingArg);
+
+    const bool detectDenormals = args.contains ("--detect-denormals");
+    args.removeString ("--detect-denormals");
+
+    const bool strictRealtime = args.contains ("--strict-realtime");
+    const bool checkRealtime = strictRealtime || args.contains ("--check-realtime");
+    args.removeString ("--strict-realtime");
+    args.removeString ("--check-realtime");
+
+    File centreOutputFile;
+    const int extractArg = args.indexOf ("--extract");
+
+    if (extractArg >= 0)
+    {
+        centreOutputFile = File::getCurrentWorkingDirectory().getChildFile (args[extractArg + 1]);
+        args.removeRange (extractArg, 2);
+    }
+
+    File cacheDirectory;
+    const int cacheArg = args.indexOf ("--cache");
+
+    if (cacheArg >= 0)
+    {
+        cacheDirectory = File::getCurrentWorkingDirectory().getChildFile (args[cacheArg + 1]);
+        args.removeRange (cacheArg, 2);
+    }
+
+    const bool useFastPaths = ! args.contains ("--no-fast-paths");
+    args.removeString ("--no-fast-paths");
+
+    int64 cacheSizeMB = 10240;
+    const int cacheSizeArg = args.indexOf ("--cache-size");
+
+    if (cacheSizeArg >= 0)
+    {
+        cacheSizeMB = args[cacheSizeArg + 1].getLargeIntValue();
+        args.removeRange (cacheSizeArg, 2);
+
+        if (cacheSizeMB <= 0)
+            return fail ("Invalid cache size");
+    }
+
+    const int traceArg = args.indexOf ("--trace");
+
+    if (traceArg >= 0)
+    {
+        const File traceFile (File::getCurrentWorkingDirectory().getChildFile (args[traceArg + 1]));
+        args.removeRange (traceArg, 2);
+
+        if (! TraceRecorder::start (traceFile))
+            return fail ("Couldn't write to the trace file: " + traceFile.getFullPathName());
+    }
+
+    ScopedPointer<AudioProcessor> processor (createPluginFilter());
+    String error;
+
+    if (! setParameters (*processor, parameterValues, error))
+        return fail (error);
+
+    processor->getTimingStats().setEnabled (timingArg >= 0);
+    processor->getTimingStats().setDenormalDetectionEnabled (detectDenormals);
+    RealtimeSafetyChecker::setStrictMode (strictRealtime);
+    RealtimeSafetyChecker::setEnabled (checkRealtime);
+    CommandLineRenderer renderer (*processor, blockSize);
+    renderer.setProcessingSampleRate (resampleRate, quality);
+    renderer.setFastPathsEnabled (useFastPaths);
+
+    if (args.contains ("--pipe"))
+    {
+        CommandLineRenderer::StreamFormat inputFormat, outputFormat;
+        bool outputFormatGiven = false;
+
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const String& arg = args[i];
+
+            if (arg == "--pipe")            continue;
+            else if (arg == "--wav-in")     inputFormat.isWav = true;
+            else if (arg == "--wav-out")    outputFormat.isWav = true;
+            else if (arg == "--channels")   inputFormat.numChannels = args[++i].getIntValue();
+            else if (arg == "--rate")       inputFormat.sampleRate = args[++i].getDoubleValue();
+            else if (arg == "--format")
+            {
+                if (! CommandLineRenderer::parseSampleFormat (args[++i], inputFormat.sampleFormat))
+                    return fail ("Unknown sample format: " + args[i]);
+            }
+            else if (arg == "--out-format")
+            {
+                if (! CommandLineRenderer::parseSampleFormat (args[++i], outputFormat.sampleFormat))
+                    return fail ("Unknown sample format: " + args[i]);
+
+                outputFormatGiven = true;
+            }
+            else
+            {
+                printUsage();
+                return 1;
+            }
+        }
+
+        if (! outputFormatGiven)
+            outputFormat.sampleFormat = inputFormat.sampleFormat;
+
+        ScopedPointer<InputStream> in (CommandLineRenderer::createStandardInputStream());
+        ScopedPointer<OutputStream> out (CommandLineRenderer::createStandardOutputStream());
+
+        if (! renderer.renderPipe (*in, *out, inputFormat, outputFormat, error))
+            return fail (error);
+
+        return finishRender (*processor, timingArg >= 0 || detectDenormals, checkRealtime);
+    }
+
+    if (args.size() != 2)
+    {
+        printUsage();
+        return 1;
+    }
+
+    const File inputFile (File::getCurrentWorkingDirectory().getChildFile (args[0]));
+    const File outputFile (File::getCurrentWorkingDirectory().getChildFile (args[1]));
+
+    ScopedPointer<RenderCache> cache;
+
+    if (cacheDirectory != File::nonexistent)
+    {
+        cache = new RenderCache (cacheDirectory, cacheSizeMB * 1024 * 1024);
+        renderer.setRenderCache (cache);
+    }
+
+    if (! renderer.renderFile (inputFile, outputFile, centreOutputFile, error))
+        return fail (error);
+
+    if (cache != nullptr && cache->getNumHits() > 0)
+        std::cerr << "Used the cached render of " << inputFile.getFileName() << std::endl;
+    else if (renderer.getNumSamplesSkipped() > 0)
+        std::cerr << "Skipped processing " << inputFile.getFileName() << ", which is "
+                  << renderer.getLastInputDescription() << " (" << renderer.getNumSamplesSkipped()
+                  << " samples)" << std::endl;
+
+    return finishRender (*processor, timingArg >= 0 || detectDenormals, checkRealtime);
+}
@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    SharedTableCache.h
+
+    Shares read-only lookup tables between all the instances in a process.
+
+  ==============================================================================
+*/
+
+#ifndef __SHAREDTABLECACHE_H_6B1E94C7__
+#define __SHAREDTABLECACHE_H_6B1E94C7__
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+
+//==============================================================================
+/**
+    A thread-safe, reference-counted registry of tables that never change once
+    they've been built, such as FFT twiddle factors and windows.
+
+    TableType must be a ReferenceCountedObject with a constructor that takes a
+    KeyType, and a method "bool matches (const KeyType&) const". The first call to
+    getFor() with a given key builds the table, and later calls return the same
+    one, so however many plugin instances are loaded, each table exists only once.
+
+    Tables are kept for as long as anything refers to them. When nothing but the
+    cache does, they're deleted the next time getFor() is called, which avoids
+    having to lock anything when a reference is released.
+
+    Declare one of these as a static object for each kind of table.
+*/
+template <class TableType>
+class SharedTableCache
+{
+public:
+    //==============================================================================
+    typedef ReferenceCountedObjectPtr<TableType> TablePtr;
+
+    SharedTableCache() {}
+
+    /** Returns the table for a key, building it if necessary. This locks, and may
+        allocate, so it mustn't be called on the audio thread.
+    */
+    template <typename KeyType>
+    TablePtr getFor (const KeyType& key)
+    {
+        const ScopedLock sl (lock);
+        TablePtr result;
+
+        for (int i = tables.size(); --i >= 0;)
+        {
+            TableType* const table = tables.getUnchecked (i);
+
+            if (table->matches (key))
+                result = table;
+            else if (table->getReferenceCount() == 1)
+                tables.remove (i);      // (nothing else is using it any more)
+        }
+
+        if (result == nullptr)
+        {
+            result = new TableType (key);
+            tables.add (result);
+        }
+
+        return result;
+    }
+
+    /** Returns the number of tables currently held, including unused ones that
+        haven't been deleted yet.
+    */
+    int getNumTables() const
+    {
+        const ScopedLock sl (lock);
+        return tables.size();
+    }
+
+private:
+    //==============================================================================
+    CriticalSection lock;
+    ReferenceCountedArray<TableType> tables;
+
+    JUCE_DECLARE_NON_COPYABLE (SharedTableCache)
+};
+
+
+#endif  // __SHAREDTABLECACHE_H_6B1E94C7__
@@ -0,0 +1,314 @@
+/*
+  ==============================================================================
+
+    ShortTimeFourierTransform.cpp
+
+    Streams audio through overlapping windowed FFT frames.
+
+  ==============================================================================
+*/
+
+#include "ShortTimeFourierTransform.h"
+
+
+//==============================================================================
+namespace STFTHelpers
+{
+    static SharedTableCache<ShortTimeFourierTransform::Windows> sharedWindows;
+
+    static double hann (const int index, const int length) noexcept
+    {
+        return 0.5 - 0.5 * std::cos (2.0 * double_Pi * index / length);
+    }
+}
+
+ShortTimeFourierTransform::Windows::Windows (const Shape& shape)
+    : frameSize (shape.frameSize), hopSize (shape.hopSize), latency (shape.latency)
+{
+    analysis.malloc ((size_t) frameSize);
+    synthesis.malloc ((size_t) frameSize);
+
+    // Only the last `latency` samples of the frame are resynthesised, and over those the
+    // two windows multiply to a squared Hann window, as a pair of Hann windows of that
+    // length would. Before that, the analysis window rises slowly over the rest of the
+    // frame, and it then falls like the second half of the short Hann window, so that
+    // the synthesis window is just a scaled copy of it there. When the latency is the
+    // whole frame, both are ordinary Hann windows.
+    const int start = frameSize - latency;
+    const int riseLength = frameSize - latency / 2;
+    double sumOfSquares = 0;
+
+    for (int i = 0; i < frameSize; ++i)
+    {
+        const int k = i - start;
+        const bool isShortWindow = start == 0 || k >= latency / 2;
+        const double w = isShortWindow ? STFTHelpers::hann (k, latency)
+                                       : 0.5 - 0.5 * std::cos (double_Pi * i / riseLength);
+        analysis[i] = (float) w;
+
+        if (k >= 0)
+        {
+            const double h = isShortWindow ? w : STFTHelpers::hann (k, latency);
+            sumOfSquares += h * h;
+        }
+    }
+
+    // This makes the overlapping windows sum to one, and also undoes the FFT's scaling
+    const double synthesisScale = hopSize / (sumOfSquares * frameSize);
+
+    for (int i = 0; i < frameSize; ++i)
+    {
+        const int k = i - start;
+
+        if (k < 0)
+        {
+            synthesis[i] = 0;
+        }
+        else if (start == 0 || k >= latency / 2)
+        {
+            synthesis[i] = (float) (analysis[i] * synthesisScale);
+        }
+        else
+        {
+            const double h = STFTHelpers::hann (k, latency);
+            synthesis[i] = (float) (h * h * synthesisScale / (0.5 - 0.5 * std::cos (double_Pi * i / riseLength)));
+        }
+    }
+}
+
+//==============================================================================
+ShortTimeFourierTransform::ShortTimeFourierTransform()
+    : fft (nullptr), windows (nullptr),
+      numInputs (0), numOutputs (0), maxFrameSize (0), frameSize (0), hopSize (0), latency (0),
+      hopPosition (0), inputPosition (0),
+      inputHistory (1, 1), outputAccumulator (1, 1), spectra (1, 1)
+{
+}
+
+ShortTimeFourierTransform::~ShortTimeFourierTransform()
+{
+}
+
+//==============================================================================
+void ShortTimeFourierTransform::prepare (const int numInputs_, const int numOutputs_,
+                                         const int fftOrder, const int hopSize_)
+{
+    Windows::Shape shape;
+    shape.frameSize = 1 << fftOrder;
+    shape.hopSize = hopSize_;
+    shape.latency = shape.frameSize;
+
+    prepare (numInputs_, numOutputs_, &shape, 1);
+}
+
+void ShortTimeFourierTransform::prepare (const int numInputs_, const int numOutputs_,
+                                         const Windows::Shape* const newShapes, const int numShapes)
+{
+    jassert (numShapes > 0);
+
+    numInputs = jmax (1, numInputs_);
+    numOutputs = jmax (1, numOutputs_);
+    maxFrameSize = 0;
+    int maxLatency = 0;
+
+    ReferenceCountedArray<Windows> preparedShapes;
+    OwnedArray<RealFFT> preparedFFTs;
+
+    for (int i = 0; i < numShapes; ++i)
+    {
+        const Windows::Shape& shape = newShapes[i];
+
+        jassert (isPowerOfTwo (shape.frameSize) && shape.latency > 0 && shape.latency <= shape.frameSize);
+
+        // The squared Hann windows only overlap-add to a constant with at least four frames overlapping
+        jassert (shape.hopSize > 0 && (shape.latency % shape.hopSize) == 0 && shape.hopSize * 4 <= shape.latency);
+
+        preparedShapes.add (STFTHelpers::sharedWindows.getFor (shape));
+        maxFrameSize = jmax (maxFrameSize, shape.frameSize);
+        maxLatency = jmax (maxLatency, shape.latency);
+
+        bool hasFFT = false;
+
+        for (int j = 0; j < preparedFFTs.size(); ++j)
+            hasFFT = hasFFT || preparedFFTs.getUnchecked (j)->getSize() == shape.frameSize;
+
+        if (! hasFFT)
+        {
+            int order = 2;
+
+            while ((1 << order) < shape.frameSize)
+                ++order;
+
+            preparedFFTs.add (new RealFFT (order));
+        }
+    }
+
+    shapes.swapWithArray (preparedShapes);
+    ffts.swapWithArray (preparedFFTs);
+
+    const int maxNumBins = getMaxNumBins();
+
+    inputHistory.setSize (numInputs, maxFrameSize);
+    outputAccumulator.setSize (numOutputs, maxLatency);
+    spectra.setSize (2 * (numInputs + numOutputs), maxNumBins);
+
+    spectrumPointers.malloc ((size_t) (2 * (numInputs + numOutputs)));
+
+    for (int i = 0; i < 2 * (numInputs + numOutputs); ++i)
+        spectrumPointers[i] = spectra.getSampleData (i);
+
+    frame.malloc ((size_t) maxFrameSize);
+
+    setShape (0);
+}
+
+void ShortTimeFourierTransform::release()
+{
+    ffts.clear();
+    shapes.clear();
+    fft = nullptr;
+    windows = nullptr;
+    inputHistory.setSize (1, 1);
+    outputAccumulator.setSize (1, 1);
+    spectra.setSize (1, 1);
+    spectrumPointers.free();
+    frame.free();
+    maxFrameSize = frameSize = latency = 0;
+}
+
+void ShortTimeFourierTransform::reset() noexcept
+{
+    inputHistory.clear();
+    outputAccumulator.clear();
+    hopPosition = 0;
+    inputPosition = 0;
+}
+
+void ShortTimeFourierTransform::setShape (const int shapeIndex) noexcept
+{
+    // must call prepare() first, with at least this many shapes
+    jassert (isPositiveAndBelow (shapeIndex, shapes.size()));
+
+    windows = shapes.getUnchecked (shapeIndex);
+    frameSize = windows->frameSize;
+    hopSize = windows->hopSize;
+    latency = windows->latency;
+
+    for (int i = 0; i < ffts.size(); ++i)
+        if (ffts.getUnchecked (i)->getSize() == frameSize)
+            fft = ffts.getUnchecked (i);
+
+    reset();
+}
+
+//==============================================================================
+void ShortTimeFourierTransform::process (AudioSampleBuffer& buffer, Client& client)
+{
+    // must call prepare() first!
+    jassert (fft != nullptr);
+
+    const int numSamples = buffer.getNumSamples();
+    const int numIns = jmin (numInputs, buffer.getNumChannels());
+    const int numOuts = jmin (numOutputs, buffer.getNumChannels());
+
+    for (int pos = 0; pos < numSamples;)
+    {
+        const int num = jmin (numSamples - pos, hopSize - hopPosition);
+        const int numBeforeWrap = jmin (num, frameSize - inputPosition);
+
+        for (int ch = 0; ch < numIns; ++ch)
+        {
+            const float* const src = buffer.getSampleData (ch, pos);
+            float* const history = inputHistory.getSampleData (ch);
+
+            FloatVectorOperations::copy (history + inputPosition, src, numBeforeWrap);
+            FloatVectorOperations::copy (history, src + numBeforeWrap, num - numBeforeWrap);
+        }
+
+        for (int ch = 0; ch < numOuts; ++ch)
+            FloatVectorOperations::copy (buffer.getSampleData (ch, pos),
+                                         outputAccumulator.getSampleData (ch, hopPosition), num);
+
+        inputPosition = (inputPosition + num) % frameSize;
+        hopPosition += num;
+        pos += num;
+
+        if (hopPosition == hopSize)
+        {
+            processFrame (client);
+            hopPosition = 0;
+        }
+    }
+}
+
+bool ShortTimeFourierTransform::isQuiescent() const noexcept
+{
+    for (int ch = 0; ch < numInputs; ++ch)
+    {
+        float low, high;
+        FloatVectorOperations::findMinAndMax (inputHistory.getSampleData (ch), frameSize, low, high);
+
+        if (low != 0 || high != 0)
+            return false;
+    }
+
+    for (int ch = 0; ch < numOutputs; ++ch)
+    {
+        float low, high;
+        FloatVectorOperations::findMinAndMax (outputAccumulator.getSampleData (ch), latency, low, high);
+
+        if (low != 0 || high != 0)
+            return false;
+    }
+
+    return true;
+}
+
+void ShortTimeFourierTransform::skipSilence (const int numSamples) noexcept
+{
+    jassert (isQuiescent());
+
+    // Any frames that would have been processed here are all zeros, so only the
+    // positions need to move on
+    inputPosition = (int) ((inputPosition + (int64) numSamples) % frameSize);
+    hopPosition = (int) ((hopPosition + (int64) numSamples) % hopSize);
+}
+
+void ShortTimeFourierTransform::processFrame (Client& client)
+{
+    float** const inputReal  = spectrumPointers;
+    float** const inputImag  = inputReal + numInputs;
+    float** const outputReal = inputImag + numInputs;
+    float** const outputImag = outputReal + numOutputs;
+
+    // (inputPosition is where the next sample will go, so it's the oldest one in the frame)
+    const int numBeforeWrap = frameSize - inputPosition;
+
+    for (int ch = 0; ch < numInputs; ++ch)
+    {
+        const float* const history = inputHistory.getSampleData (ch);
+
+        FloatVectorOperations::copy (frame, history + inputPosition, numBeforeWrap);
+        FloatVectorOperations::copy (frame + numBeforeWrap, history, inputPosition);
+        FloatVectorOperations::multiply (frame, windows->analysis, frameSize);
+
+        fft->performForward (frame, inputReal[ch], inputImag[ch]);
+    }
+
+    client.processSpectra (inputReal, inputImag, outputReal, outputImag, getNumBins());
+
+    // (the synthesis window is zero before this, so only the end of the frame is used)
+    const int start = frameSize - latency;
+
+    for (int ch = 0; ch < numOutputs; ++ch)
+    {
+        float* const accumulator = outputAccumulator.getSampleData (ch);
+
+        memmove (accumulator, accumulator + hopSize, sizeof (float) * (size_t) (latency - hopSize));
+        FloatVectorOperations::clear (accumulator + latency - hopSize, hopSize);
+
+        fft->performInverse (outputReal[ch], outputImag[ch], frame);
+        FloatVectorOperations::multiply (frame + start, windows->synthesis + start, latency);
+        FloatVectorOperations::add (accumulator, frame + start, latency);
+    }
+}
@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+    ShortTimeFourierTransform.h
+
+    Streams audio through overlapping windowed FFT frames.
+
+  ==============================================================================
+*/
+
+#ifndef __SHORTTIMEFOURIERTRANSFORM_H_8F52D0C3__
+#define __SHORTTIMEFOURIERTRANSFORM_H_8F52D0C3__
+
+#include "RealFFT.h"
+
+
+//==============================================================================
+/**
+    Runs a stream of audio through a spectral process, frame by frame.
+
+    Every hop, the most recent frame of input is Hann-windowed and transformed, the
+    client turns the input spectra into output spectra, and these are transformed
+    back, windowed again and overlap-added into the output. With a hop of a quarter
+    of the frame or less, a client that passes its spectra straight through gets back
+    exactly its input, delayed by one frame.
+
+    The latency can also be made shorter than the frame, in which case only the end
+    of each frame is resynthesised, and the analysis window is stretched so that it
+    rises slowly over the rest of the frame. The frequency resolution is still that of
+    the whole frame, and a pass-through client still gets back exactly its input, now
+    delayed by just the latency. The hop then has to be a quarter of the latency or less.
+
+    A transform can be prepared with several shapes, which it can switch between
+    without allocating anything, so that the latency can be changed while playing.
+
+    The number of output channels can differ from the number of inputs, so that a
+    client can produce more than one result from the same analysis.
+
+    The windows, like the FFT's tables, are shared by every instance using the same
+    frame and hop size, so each instance only holds its own streaming buffers.
+
+    Nothing is allocated after prepare(), so process() is real-time safe.
+*/
+class ShortTimeFourierTransform
+{
+public:
+    //==============================================================================
+    /** The processing that gets done on each frame's spectra. */
+    class Client
+    {
+    public:
+        virtual ~Client() {}
+
+        /** Called once per hop with the spectra of the latest frame.
+
+            Each spectrum is numBins bins in split form: inputReal[ch][bin] and
+            inputImag[ch][bin] for the inputs, and the same for the outputs, which must
+            all be filled in. The input spectra may be used as scratch space.
+        */
+        virtual void processSpectra (float* const* inputReal, float* const* inputImag,
+                                     float* const* outputReal, float* const* outputImag,
+                                     int numBins) = 0;
+    };
+
+    //==============================================================================
+    /** The analysis and synthesis windows for one frame size, hop size and latency,
+        which are shared between instances.
+    */
+    class Windows  : public ReferenceCountedObject
+    {
+    public:
+        struct Shape
+        {
+            int frameSize;      /**< a power of two */
+            int hopSize;        /**< which must divide the latency, and be no more than a quarter of it */
+            int latency;        /**< up to the frame size */
+        };
+
+        explicit Windows (const Shape& shape);
+
+        bool matches (const Shape& other) const noexcept
+        {
+            return frameSize == other.frameSize && hopSize == other.hopSize && latency == other.latency;
+        }
+
+        const int frameSize, hopSize, latency;
+        HeapBlock<float> analysis, synthesis;
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE (Windows)
+    };
+
+    //==============================================================================
+    ShortTimeFourierTransform();
+    ~ShortTimeFourierTransform();
+
+    //==============================================================================
+    /** Allocates the buffers.
+
+        @param numInputs    the number of channels that are analysed
+        @param numOutputs   the number of channels that are resynthesised
+        @param fftOrder     the frame size, as a power of two
+        @param hopSize      the number of samples between frames. This must divide the
+                            frame size, and be no more than a quarter of it.
+    */
+    void prepare (int numInputs, int numOutputs, int fftOrder, int hopSize);
+
+    /** Allocates the buffers for the largest of a set of shapes, and gets their windows
+        and transforms ready, so that setShape() can switch between them. The first one
+        is selected.
+    */
+    void prepare (int numInputs, int numOutputs, const Windows::Shape* shapes, int numShapes);
+
+    /** Frees the buffers. */
+    void release();
+
+    /** Clears the frames that are in progress. */
+    void reset() noexcept;
+
+    /** Switches to one of the shapes that were given to prepare(), and clears the frames
+        that are in progress. This doesn't allocate anything.
+    */
+    void setShape (int shapeIndex) noexcept;
+
+    /** Returns the number of samples in a frame. */
+    int getFrameSize() const noexcept                   { return frameSize; }
+
+    /** Returns the number of bins in each spectrum. */
+    int getNumBins() const noexcept                     { return frameSize / 2 + 1; }
+
+    /** Returns the largest number of bins that any of the shapes will produce. */
+    int getMaxNumBins() const noexcept                  { return maxFrameSize / 2 + 1; }
+
+    /** Returns the delay between the input and output, which is one frame unless a
+        shorter latency was asked for.
+    */
+    int getLatencySamples() const noexcept              { return latency; }
+
+    //==============================================================================
+    /** Processes a block. The inputs are read from the buffer's first numInputs
+        channels, and the outputs replace its first numOutputs channels.
+    */
+    void process (AudioSampleBuffer& buffer, Client& client);
+
+    /** Returns true if there's nothing left in the frames that are in progress, so that
+        silent input would produce silent output, as long as the client turns silent
+        spectra into silent spectra.
+    */
+    bool isQuiescent() const noexcept;
+
+    /** Does the equivalent of processing a silent block while isQuiescent() is true,
+        without doing any of the transforms. The output is silence.
+    */
+    void skipSilence (int numSamples) noexcept;
+
+private:
+    //==============================================================================
+    OwnedArray<RealFFT> ffts;                   // one for each frame size used by the shapes
+    ReferenceCountedArray<Windows> shapes;
+    RealFFT* fft;
+    Windows* windows;
+    int numInputs, numOutputs, maxFrameSize, frameSize, hopSize, latency, hopPosition, inputPosition;
+
+    AudioSampleBuffer inputHistory;         // a circular buffer of the last frame of input
+    AudioSampleBuffer outputAccumulator;    // the overlap-added output, of which the first hop is complete
+    AudioSampleBuffer spectra;              // the real and imaginary parts of each input, then each output
+    HeapBlock<float> frame;
+    HeapBlock<float*> spectrumPointers;
+
+    void processFrame (Client& client);
+
+    JUCE_DECLARE_NON_COPYABLE (ShortTimeFourierTransform)
+};
+
+
+#endif  // __SHORTTIMEFOURIERTRANSFORM_H_8F52D0C3__
@@ -0,0 +1,483 @@
+/*
+  ==============================================================================
+
+    SpectralMaskProcessor.cpp
+
+    Smooths spectral masks over time and frequency, to avoid musical noise.
+
+  ==============================================================================
+*/
+
+#include "SpectralMaskProcessor.h"
+#include "RealFFT.h"
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+
+//==============================================================================
+namespace SpectralMaskHelpers
+{
+    static int getRowSize (const int numBins) noexcept
+    {
+        return (numBins + 3) & ~3;
+    }
+
+    /** The equivalent rectangular bandwidth of the ear's filter at a frequency. */
+    static double getERB (const double frequency) noexcept
+    {
+        return 24.7 * (4.37e-3 * frequency + 1.0);
+    }
+
+    /*  Moves each value towards the raw mask by a fraction of the distance, and passes
+        the results on. The state rows are aligned, but the mask needn't be.
+    */
+    static void smoothOverTime (float* const state, float* const mask, const float coefficient, const int numBins) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_INTEL
+        const __m128 a = _mm_set1_ps (coefficient);
+
+        for (; i + 4 <= numBins; i += 4)
+        {
+            __m128 s = _mm_load_ps (state + i);
+            s = _mm_add_ps (s, _mm_mul_ps (a, _mm_sub_ps (_mm_loadu_ps (mask + i), s)));
+            _mm_store_ps (state + i, s);
+            _mm_storeu_ps (mask + i, s);
+        }
+       #endif
+
+        for (; i < numBins; ++i)
+        {
+            state[i] += coefficient * (mask[i] - state[i]);
+            mask[i] = state[i];
+        }
+    }
+
+    /*  Fills in sums[i] with the sum of the first i values, for i from 0 to numValues.
+        With SSE, each group of four is scanned in-register with two shifted adds.
+    */
+    static void findPrefixSums (const float* const values, float* const sums, const int numValues) noexcept
+    {
+        sums[0] = 0;
+        int i = 0;
+
+       #if JUCE_INTEL
+        __m128 carry = _mm_setzero_ps();
+
+        for (; i + 4 <= numValues; i += 4)
+        {
+            __m128 x = _mm_loadu_ps (values + i);
+            x = _mm_add_ps (x, _mm_castsi128_ps (_mm_slli_si128 (_mm_castps_si128 (x), 4)));
+            x = _mm_add_ps (x, _mm_castsi128_ps (_mm_slli_si128 (_mm_castps_si128 (x), 8)));
+            x = _mm_add_ps (x, carry);
+            _mm_storeu_ps (sums + i + 1, x);
+            carry = _mm_shuffle_ps (x, x, _MM_SHUFFLE (3, 3, 3, 3));
+        }
+       #endif
+
+        for (; i < numValues; ++i)
+            sums[i + 1] = sums[i] + values[i];
+    }
+
+    /*  Like findPrefixSums(), but for the products of the values and weights, and for the
+        weights themselves. These are kept in double precision: the weights are powers, so a
+        window of quiet bins is the small difference of two large sums, and in floats it
+        would lose most of its precision on a steeply tilted spectrum.
+        With SSE2, each pair is scanned in-register with one shifted add.
+    */
+    static void findWeightedPrefixSums (const float* const values, const float* const weights,
+                                        double* const sums, double* const weightSums, const int numValues) noexcept
+    {
+        sums[0] = weightSums[0] = 0;
+        int i = 0;
+
+       #if JUCE_INTEL
+        __m128d carry = _mm_setzero_pd(), weightCarry = _mm_setzero_pd();
+
+        for (; i + 2 <= numValues; i += 2)
+        {
+            __m128d w = _mm_cvtps_pd (_mm_castsi128_ps (_mm_loadl_epi64 ((const __m128i*) (weights + i))));
+            __m128d x = _mm_mul_pd (_mm_cvtps_pd (_mm_castsi128_ps (_mm_loadl_epi64 ((const __m128i*) (values + i)))), w);
+
+            x = _mm_add_pd (x, _mm_castsi128_pd (_mm_slli_si128 (_mm_castpd_si128 (x), 8)));
+            w = _mm_add_pd (w, _mm_castsi128_pd (_mm_slli_si128 (_mm_castpd_si128 (w), 8)));
+            x = _mm_add_pd (x, carry);
+            w = _mm_add_pd (w, weightCarry);
+
+            _mm_storeu_pd (sums + i + 1, x);
+            _mm_storeu_pd (weightSums + i + 1, w);
+            carry = _mm_unpackhi_pd (x, x);
+            weightCarry = _mm_unpackhi_pd (w, w);
+        }
+       #endif
+
+        for (; i < numValues; ++i)
+        {
+            sums[i + 1] = sums[i] + (double) values[i] * weights[i];
+            weightSums[i + 1] = weightSums[i] + weights[i];
+        }
+    }
+
+    /*  Pulls each value towards 0 or 1 with a smoothstep curve, which leaves 0, 0.5 and 1
+        where they are, and then scales it so that no more than (1 - floor) is removed.
+    */
+    static void applyThreshold (float* const mask, const float floor, const int numBins) noexcept
+    {
+        const float depth = 1.0f - floor;
+        int i = 0;
+
+       #if JUCE_INTEL
+        const __m128 three = _mm_set1_ps (3.0f);
+        const __m128 two = _mm_set1_ps (2.0f);
+        const __m128 d = _mm_set1_ps (depth);
+
+        for (; i + 4 <= numBins; i += 4)
+        {
+            const __m128 x = _mm_loadu_ps (mask + i);
+            const __m128 curve = _mm_mul_ps (_mm_mul_ps (x, x), _mm_sub_ps (three, _mm_mul_ps (two, x)));
+            _mm_storeu_ps (mask + i, _mm_mul_ps (curve, d));
+        }
+       #endif
+
+        for (; i < numBins; ++i)
+        {
+            const float x = mask[i];
+            mask[i] = x * x * (3.0f - 2.0f * x) * depth;
+        }
+    }
+}
+
+//==============================================================================
+SpectralMaskProcessor::SpectralMaskProcessor()
+    : prefixSums (nullptr), weightedPrefixSums (nullptr), weightPrefixSums (nullptr), numMasks (0), numSlots (0), hopSize (1024), sampleRate (44100.0),
+      timeConstant (0), bandwidth (0), floorGain (0),
+      tableBandwidth (-1.0f), tableTimeConstant (-1.0f), tableHopSize (0), timeCoefficient (1.0f)
+{
+    zeromem (slots, sizeof (slots));
+}
+
+SpectralMaskProcessor::~SpectralMaskProcessor()
+{
+}
+
+//==============================================================================
+void SpectralMaskProcessor::prepare (const int numMasks_, const int maxNumBins, const double sampleRate_)
+{
+    using namespace SpectralMaskHelpers;
+
+    numMasks = jmax (1, numMasks_);
+    sampleRate = sampleRate_;
+    zeromem (slots, sizeof (slots));
+
+    // One slot for each frame size, indexed by its order, starting with the smallest
+    // that a RealFFT can do
+    numSlots = 0;
+
+    while (numSlots < maxSlots && (1 << numSlots) / 2 + 1 <= maxNumBins)
+        ++numSlots;
+
+    jassert (numSlots < maxSlots || (1 << (maxSlots - 1)) / 2 + 1 >= maxNumBins);
+
+    const int sumsRowSize = getRowSize (maxNumBins + 1);
+    size_t numFloats = (size_t) sumsRowSize * 5;    // (one row of floats, and two of doubles)
+
+    for (int i = 2; i < numSlots; ++i)
+        numFloats += (size_t) (getRowSize ((1 << i) / 2 + 1) * (numMasks + 3));
+
+    // (the extra space is so that everything can start on a 16-byte boundary)
+    storage.calloc (numFloats * sizeof (float) + 16);
+    float* next = reinterpret_cast<float*> ((reinterpret_cast<pointer_sized_int> (storage.getData()) + 15) & ~(pointer_sized_int) 15);
+
+    weightedPrefixSums = reinterpret_cast<double*> (next);
+    weightPrefixSums = weightedPrefixSums + sumsRowSize;
+    next += sumsRowSize * 4;
+    prefixSums = next;
+    next += sumsRowSize;
+
+    for (int i = 2; i < numSlots; ++i)
+    {
+        Slot& slot = slots[i];
+        slot.numBins = (1 << i) / 2 + 1;
+        slot.rowSize = getRowSize (slot.numBins);
+
+        slot.states = next;             next += slot.rowSize * numMasks;
+        slot.rangeStarts = (int*) next; next += slot.rowSize;
+        slot.rangeEnds = (int*) next;   next += slot.rowSize;
+        slot.rangeScales = next;        next += slot.rowSize;
+    }
+
+    tableBandwidth = tableTimeConstant = -1.0f;
+    updateTables();
+}
+
+void SpectralMaskProcessor::release()
+{
+    storage.free();
+    zeromem (slots, sizeof (slots));
+    prefixSums = nullptr;
+    weightedPrefixSums = weightPrefixSums = nullptr;
+    numSlots = 0;
+}
+
+void SpectralMaskProcessor::reset() noexcept
+{
+    for (int i = 2; i < numSlots; ++i)
+        zeromem (slots[i].states, sizeof (float) * (size_t) (slots[i].rowSize * numMasks));
+}
+
+//==============================================================================
+void SpectralMaskProcessor::setSmoothing (const float timeConstantSeconds, const float bandwidthInERBs,
+                                          const float floor) noexcept
+{
+    timeConstant = jmax (0.0f, timeConstantSeconds);
+    bandwidth = jmax (0.0f, bandwidthInERBs);
+    floorGain = jlimit (0.0f, 1.0f, floor);
+}
+
+void SpectralMaskProcessor::setHopSize (const int newHopSize) noexcept
+{
+    hopSize = jmax (1, newHopSize);
+}
+
+bool SpectralMaskProcessor::isActive() const noexcept
+{
+    return timeConstant > 0 || bandwidth > 0 || floorGain > 0;
+}
+
+bool SpectralMaskProcessor::isQuiescent() const noexcept
+{
+    for (int i = 2; i < numSlots; ++i)
+    {
+        float low, high;
+        FloatVectorOperations::findMinAndMax (slots[i].states, slots[i].rowSize * numMasks, low, high);
+
+        if (low != 0 || high != 0)
+            return false;
+    }
+
+    return true;
+}
+
+int SpectralMaskProcessor::getSlotIndex (const int numBins) const noexcept
+{
+    for (int i = 2; i < numSlots; ++i)
+        if (slots[i].numBins == numBins)
+            return i;
+
+    return -1;
+}
+
+void SpectralMaskProcessor::updateTables() noexcept
+{
+    const float newTimeConstant = timeConstant;
+    const float newBandwidth = bandwidth;
+
+    if (newTimeConstant != tableTimeConstant || hopSize != tableHopSize)
+    {
+        tableTimeConstant = newTimeConstant;
+        tableHopSize = hopSize;
+
+        timeCoefficient = newTimeConstant > 0 ? (float) (1.0 - std::exp (-hopSize / (newTimeConstant * sampleRate)))
+                                              : 1.0f;
+    }
+
+    if (newBandwidth == tableBandwidth)
+        return;
+
+    tableBandwidth = newBandwidth;
+
+    for (int i = 2; i < numSlots; ++i)
+    {
+        const Slot& slot = slots[i];
+        const double binWidth = sampleRate / (2 * (slot.numBins - 1));
+
+        for (int bin = 0; bin < slot.numBins; ++bin)
+        {
+            const double halfWidth = 0.5 * newBandwidth * SpectralMaskHelpers::getERB (bin * binWidth) / binWidth;
+            const int start = jmax (0, roundToInt (bin - halfWidth));
+            const int end = jmin (slot.numBins, roundToInt (bin + halfWidth) + 1);
+
+            slot.rangeStarts[bin] = start;
+            slot.rangeEnds[bin] = end;
+            slot.rangeScales[bin] = 1.0f / (end - start);
+        }
+    }
+}
+
+//==============================================================================
+void SpectralMaskProcessor::process (const int maskIndex, float* const mask, const float* const weights,
+                                     const int numBins) noexcept
+{
+    using namespace SpectralMaskHelpers;
+
+    updateTables();
+
+    const int slotIndex = getSlotIndex (numBins);
+
+    // must call prepare() with enough masks and bins first!
+    jassert (slotIndex >= 0 && isPositiveAndBelow (maskIndex, numMasks));
+
+    if (slotIndex < 0 || ! isPositiveAndBelow (maskIndex, numMasks))
+        return;
+
+    const Slot& slot = slots [slotIndex];
+
+    if (timeCoefficient < 1.0f)
+        smoothOverTime (slot.states + maskIndex * slot.rowSize, mask, timeCoefficient, numBins);
+
+    if (tableBandwidth > 0)
+    {
+        if (weights != nullptr)
+        {
+            findWeightedPrefixSums (mask, weights, weightedPrefixSums, weightPrefixSums, numBins);
+
+            for (int i = 0; i < numBins; ++i)
+            {
+                const int start = slot.rangeStarts[i], end = slot.rangeEnds[i];
+                const double total = weightPrefixSums[end] - weightPrefixSums[start];
+
+                if (total > 0)
+                    mask[i] = (float) jlimit (0.0, 1.0, (weightedPrefixSums[end] - weightedPrefixSums[start]) / total);
+            }
+        }
+        else
+        {
+            findPrefixSums (mask, prefixSums, numBins);
+
+            for (int i = 0; i < numBins; ++i)
+                mask[i] = (prefixSums [slot.rangeEnds[i]] - prefixSums [slot.rangeStarts[i]]) * slot.rangeScales[i];
+        }
+    }
+
+    applyThreshold (mask, floorGain, numBins);
+}
+
+//==============================================================================
+String SpectralMaskProcessor::runBenchmark()
+{
+    const double sampleRate = 44100.0;
+    const double secondsPerTick = 1.0 / (double) Time::getHighResolutionTicksPerSecond();
+
+    String report ("Frame size   FFT pair (us/frame)   Mask stage (us/frame)   Mask/FFT\n");
+    Random random (1);
+
+    for (int order = 8; order <= 12; ++order)
+    {
+        RealFFT fft (order);
+        const int frameSize = fft.getSize();
+        const int numBins = fft.getNumBins();
+        const int numFrames = (1 << 24) / frameSize;
+
+        HeapBlock<float> input ((size_t) frameSize), output ((size_t) frameSize);
+        HeapBlock<float> real ((size_t) numBins), imag ((size_t) numBins);
+        HeapBlock<float> rawMask ((size_t) numBins), mask ((size_t) numBins), powers ((size_t) numBins);
+
+        for (int i = 0; i < frameSize; ++i)
+            input[i] = random.nextFloat() - 0.5f;
+
+        for (int i = 0; i < numBins; ++i)
+            rawMask[i] = random.nextBool() ? 1.0f : 0.0f;
+
+        fft.performForward (input, real, imag);
+
+        for (int i = 0; i < numBins; ++i)
+            powers[i] = real[i] * real[i] + imag[i] * imag[i];
+
+        SpectralMaskProcessor processor;
+        processor.prepare (1, numBins, sampleRate);
+        processor.setSmoothing (0.08f, 0.5f, 0.1f);
+        processor.setHopSize (frameSize / 4);
+
+        const int64 fftStart = Time::getHighResolutionTicks();
+
+        for (int i = 0; i < numFrames; ++i)
+        {
+            fft.performForward (input, real, imag);
+            fft.performInverse (real, imag, output);
+        }
+
+        const int64 maskStart = Time::getHighResolutionTicks();
+
+        // (each frame starts from the raw mask, as it would from the client's table, because
+        // running the output back in would decay into denormals)
+        for (int i = 0; i < numFrames; ++i)
+        {
+            FloatVectorOperations::copy (mask, rawMask, numBins);
+            processor.process (0, mask, powers, numBins);
+        }
+
+        const int64 end = Time::getHighResolutionTicks();
+
+        const double fftMicros = (maskStart - fftStart) * secondsPerTick * 1.0e6 / numFrames;
+        const double maskMicros = (end - maskStart) * secondsPerTick * 1.0e6 / numFrames;
+
+        report << String (frameSize).paddedLeft (' ', 10)
+               << String (fftMicros, 2).paddedLeft (' ', 22)
+               << String (maskMicros, 2).paddedLeft (' ', 24)
+               << String (maskMicros / fftMicros, 2).paddedLeft (' ', 11) << "\n";
+    }
+
+    return report;
+}
+
+bool SpectralMaskProcessor::runPrecisionCheck (String& report)
+{
+    const double sampleRate = 44100.0;
+    const float bandwidthInERBs = 0.5f, tolerance = 0.001f;
+    const int numBins = 2049;
+    bool ok = true;
+
+    HeapBlock<float> rawMask ((size_t) numBins), mask ((size_t) numBins), powers ((size_t) numBins);
+
+    SpectralMaskProcessor processor;
+    processor.prepare (1, numBins, sampleRate);
+    processor.setSmoothing (0, bandwidthInERBs, 0);
+
+    for (int tilt = 40; tilt <= 80; tilt += 20)
+    {
+        Random random (tilt);
+
+        for (int i = 0; i < numBins; ++i)
+        {
+            rawMask[i] = random.nextFloat();
+            powers[i] = (float) (std::pow (10.0, -0.1 * tilt * i / (numBins - 1)) * (0.5 + random.nextDouble()));
+        }
+
+        FloatVectorOperations::copy (mask, rawMask, numBins);
+        processor.process (0, mask, powers, numBins);
+
+        // The reference sums each bin's range directly, in double precision
+        const Slot& slot = processor.slots [processor.getSlotIndex (numBins)];
+        double maxError = 0;
+        int numBad = 0;
+
+        for (int i = 0; i < numBins; ++i)
+        {
+            double sum = 0, total = 0;
+
+            for (int j = slot.rangeStarts[i]; j < slot.rangeEnds[i]; ++j)
+            {
+                sum += (double) rawMask[j] * powers[j];
+                total += powers[j];
+            }
+
+            const double x = total > 0 ? jlimit (0.0, 1.0, sum / total) : rawMask[i];
+            const double error = std::abs (mask[i] - x * x * (3.0 - 2.0 * x));
+
+            maxError = jmax (maxError, error);
+
+            if (error > tolerance)
+                ++numBad;
+        }
+
+        report << "Mask smoothing with a " << tilt << "dB tilt: largest error " << String (maxError, 6)
+               << ", " << numBad << " of " << numBins << " bins off by more than " << String (tolerance, 3) << newLine;
+
+        ok = ok && numBad == 0;
+    }
+
+    return ok;
+}
@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    SpectralMaskProcessor.h
+
+    Smooths spectral masks over time and frequency, to avoid musical noise.
+
+  ==============================================================================
+*/
+
+#ifndef __SPECTRALMASKPROCESSOR_H_E83B5D17__
+#define __SPECTRALMASKPROCESSOR_H_E83B5D17__
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+
+//==============================================================================
+/**
+    A post-filter for the masks that a spectral process applies to each frame.
+
+    A mask that jumps between 0 and 1 from bin to bin and frame to frame leaves
+    isolated bins blinking on and off, which is heard as musical noise. This takes
+    each frame's raw mask, with 0 meaning "keep the bin" and 1 meaning "remove it",
+    and runs it through three stages:
+
+    - a one-pole lowpass over time, separately for every bin
+    - a moving average over frequency, whose width is a fixed number of ERBs, so
+      that it's a few bins wide in the bass and hundreds of bins wide at the top.
+      This can be weighted by the power in each bin, which makes it the fraction of
+      the power nearby that the mask would remove, so a strong harmonic keeps its own
+      value instead of being averaged away by the quiet bins around it.
+    - a soft threshold, which pulls the smoothed values back towards 0 or 1, and
+      a floor, which limits how much of anything can be removed
+
+    The state for each mask is kept for every power-of-two frame size up to the
+    largest, so one processor can serve all the bands of a MultiResolutionSTFT.
+    Everything is held as structure-of-arrays blocks with 16-byte aligned rows,
+    and the time smoothing, the prefix sums behind the moving average, and the
+    threshold all work on four bins at a time with SSE on Intel.
+
+    With no smoothing and no floor, isActive() returns false, and a client can skip
+    the stage altogether.
+*/
+class SpectralMaskProcessor
+{
+public:
+    //==============================================================================
+    SpectralMaskProcessor();
+    ~SpectralMaskProcessor();
+
+    //==============================================================================
+    /** Allocates the state.
+
+        @param numMasks         the number of independent masks, e.g. one per channel pair
+        @param maxNumBins       the most bins that a mask will have, which must be one more
+                                than a power of two
+        @param sampleRate       the sample rate, which sets the frequencies of the bins
+    */
+    void prepare (int numMasks, int maxNumBins, double sampleRate);
+
+    /** Frees the state. */
+    void release();
+
+    /** Clears the time smoothing. */
+    void reset() noexcept;
+
+    //==============================================================================
+    /** Sets how much smoothing is done. This can be called while processing.
+
+        @param timeConstantSeconds  the time constant of the smoothing over time, or 0 for none
+        @param bandwidthInERBs      the width of the smoothing over frequency, or 0 for none
+        @param floor                the smallest gain that's left after removing a bin, from 0 to 1
+    */
+    void setSmoothing (float timeConstantSeconds, float bandwidthInERBs, float floor) noexcept;
+
+    /** Sets the number of samples between frames, which the time constant depends on. */
+    void setHopSize (int hopSize) noexcept;
+
+    /** Returns the floor that was last set. */
+    float getFloor() const noexcept                         { return floorGain; }
+
+    /** Returns true if any of the stages does anything. */
+    bool isActive() const noexcept;
+
+    /** Returns true if the time smoothing has nothing left in it, so that frames with an
+        all-zero mask wouldn't change anything.
+    */
+    bool isQuiescent() const noexcept;
+
+    //==============================================================================
+    /** Processes one frame of one of the masks, in place. The values must be between
+        0 and 1, and numBins must be one more than a power of two. The weights are
+        usually the power in each bin, and can be null for an unweighted average.
+    */
+    void process (int maskIndex, float* mask, const float* weights, int numBins) noexcept;
+
+    //==============================================================================
+    /** Times the processing of a mask against a forward and inverse FFT, for each frame
+        size from 256 to 4096, and returns a table of the results.
+    */
+    static String runBenchmark();
+
+    /** Compares the power-weighted smoothing of a 4096-point frame against a double-precision
+        reference, for spectra that fall away by 40, 60 and 80dB from the lowest bin to the
+        highest. Returns true if every value is within 0.001 of the reference, and appends a
+        line for each spectrum to the report.
+    */
+    static bool runPrecisionCheck (String& report);
+
+private:
+    //==============================================================================
+    /** Everything that belongs to one frame size. */
+    struct Slot
+    {
+        int numBins, rowSize;       // (rowSize is numBins rounded up to a multiple of four)
+        float* states;              // a row of smoothed values for each mask
+        int* rangeStarts;           // the first bin that each bin's moving average covers
+        int* rangeEnds;             // one past the last bin that it covers
+        float* rangeScales;         // one over the number of bins that it covers
+    };
+
+    enum { maxSlots = 16 };
+
+    HeapBlock<char> storage;
+    Slot slots [maxSlots];
+    float* prefixSums;
+    double* weightedPrefixSums;
+    double* weightPrefixSums;
+    int numMasks, numSlots, hopSize;
+    double sampleRate;
+
+    float timeConstant, bandwidth, floorGain, tableBandwidth, tableTimeConstant;
+    int tableHopSize;
+    float timeCoefficient;
+
+    void updateTables() noexcept;
+    int getSlotIndex (int numBins) const noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE (SpectralMaskProcessor)
+};
+
+
+#endif  // __SPECTRALMASKPROCESSOR_H_E83B5D17__